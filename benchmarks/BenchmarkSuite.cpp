@@ -0,0 +1,110 @@
+#include "BenchmarkSuite.hpp"
+
+#include <QJsonArray>
+#include <QMap>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+void BenchmarkSuite::add(QString name, uint64_t itemsPerIteration, Body body) {
+    benchmarks.append(Benchmark{std::move(name), std::max<uint64_t>(1, itemsPerIteration), std::move(body)});
+}
+
+QStringList BenchmarkSuite::names() const {
+    QStringList result;
+    for (const auto& benchmark : benchmarks)
+        result.append(benchmark.name);
+    return result;
+}
+
+qint64 BenchmarkSuite::sample(const Body& body, uint64_t iterations) {
+    Stopwatch watch;
+    watch.resume();
+    for (uint64_t i = 0; i < iterations; ++i)
+        body(watch);
+    watch.pause();
+    return watch.elapsedNsecs();
+}
+
+QJsonObject BenchmarkSuite::run(const Options& options) {
+    constexpr uint64_t MAX_ITERATIONS = 1 << 24;
+    QJsonArray results;
+
+    for (const auto& benchmark : benchmarks) {
+        if (!options.filter.match(benchmark.name).hasMatch())
+            continue;
+        std::fprintf(stderr, "%s ... ", qPrintable(benchmark.name));
+        std::fflush(stderr);
+
+        // Warm up, then find an iteration count which makes a sample last long enough to measure reliably
+        sample(benchmark.body, 1);
+        uint64_t iterations = 1;
+        for (auto elapsed = sample(benchmark.body, iterations);
+             elapsed < options.minSampleNsecs && iterations < MAX_ITERATIONS;
+             elapsed = sample(benchmark.body, iterations)) {
+            auto scale = elapsed <= 0? 10.0 : std::min(10.0, 1.2 * options.minSampleNsecs / elapsed);
+            iterations = std::min(MAX_ITERATIONS, std::max(iterations + 1, uint64_t(iterations * scale)));
+        }
+
+        std::vector<double> perIteration;
+        for (int i = 0; i < options.samples; ++i)
+            perIteration.push_back(double(sample(benchmark.body, iterations)) / iterations);
+        std::sort(perIteration.begin(), perIteration.end());
+
+        auto count = perIteration.size();
+        auto median = count % 2? perIteration[count / 2]
+                               : (perIteration[count / 2 - 1] + perIteration[count / 2]) / 2;
+        double mean = 0;
+        for (auto value : perIteration)
+            mean += value / count;
+        double variance = 0;
+        for (auto value : perIteration)
+            variance += (value - mean) * (value - mean) / count;
+
+        results.append(QJsonObject{
+            {QStringLiteral("name"), benchmark.name},
+            {QStringLiteral("iterations"), qint64(iterations)},
+            {QStringLiteral("samples"), options.samples},
+            {QStringLiteral("itemsPerIteration"), qint64(benchmark.itemsPerIteration)},
+            {QStringLiteral("nsPerIteration"), QJsonObject{
+                 {QStringLiteral("min"), perIteration.front()},
+                 {QStringLiteral("median"), median},
+                 {QStringLiteral("mean"), mean},
+                 {QStringLiteral("stddev"), std::sqrt(variance)}
+             }},
+            {QStringLiteral("itemsPerSecond"), median > 0? benchmark.itemsPerIteration * 1e9 / median : 0}
+        });
+        std::fprintf(stderr, "%.0f ns/iteration\n", median);
+    }
+
+    return QJsonObject{{QStringLiteral("benchmarks"), results}};
+}
+
+int BenchmarkSuite::compare(const QJsonObject& baseline, const QJsonObject& current, double threshold) {
+    QMap<QString, double> baselineMedians;
+    for (const auto& result : baseline[QStringLiteral("benchmarks")].toArray()) {
+        auto object = result.toObject();
+        baselineMedians[object[QStringLiteral("name")].toString()] =
+                object[QStringLiteral("nsPerIteration")].toObject()[QStringLiteral("median")].toDouble();
+    }
+
+    int regressions = 0;
+    for (const auto& result : current[QStringLiteral("benchmarks")].toArray()) {
+        auto object = result.toObject();
+        auto name = object[QStringLiteral("name")].toString();
+        auto median = object[QStringLiteral("nsPerIteration")].toObject()[QStringLiteral("median")].toDouble();
+        auto itr = baselineMedians.find(name);
+        if (itr == baselineMedians.end() || *itr <= 0)
+            continue;
+
+        auto ratio = median / *itr;
+        if (ratio > threshold) {
+            std::fprintf(stderr, "REGRESSION %s: %.0f ns -> %.0f ns (%.2fx)\n", qPrintable(name), *itr, median, ratio);
+            ++regressions;
+        }
+    }
+    return regressions;
+}
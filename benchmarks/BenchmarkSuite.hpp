@@ -0,0 +1,94 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+class BlockchainInterface;
+class MockChain;
+
+/*!
+ * \brief Measures the time spent in a benchmark iteration, excluding any time the iteration spends paused
+ *
+ * Iterations pause the stopwatch around setup and teardown which should not count toward the measurement.
+ */
+class Stopwatch {
+    QElapsedTimer timer;
+    qint64 accumulated = 0;
+    bool running = false;
+
+public:
+    void resume() {
+        if (!running) {
+            running = true;
+            timer.start();
+        }
+    }
+    void pause() {
+        if (running) {
+            accumulated += timer.nsecsElapsed();
+            running = false;
+        }
+    }
+    qint64 elapsedNsecs() const { return accumulated + (running? timer.nsecsElapsed() : 0); }
+};
+
+/*!
+ * \brief A minimal microbenchmark runner producing machine-readable results
+ *
+ * Each benchmark is a callable running one iteration. The runner repeats the iteration until a sample takes at least
+ * the minimum sample time, then takes several samples and reports the minimum, median, mean and standard deviation
+ * of the time per iteration. Results are produced as JSON, and can be compared against a previous run's results to
+ * flag regressions.
+ */
+class BenchmarkSuite {
+public:
+    using Body = std::function<void(Stopwatch&)>;
+
+    struct Options {
+        //! Only benchmarks whose names match are run
+        QRegularExpression filter;
+        qint64 minSampleNsecs = 20'000'000;
+        int samples = 10;
+    };
+
+    /*!
+     * \brief Add a benchmark to the suite
+     * \param name Name of the benchmark, as category/operation/detail
+     * \param itemsPerIteration Number of items (rows, entries, calls) processed in one iteration, for throughput
+     * \param body Callable running one iteration
+     */
+    void add(QString name, uint64_t itemsPerIteration, Body body);
+
+    //! Get the names of all benchmarks in the suite
+    QStringList names() const;
+    //! Run the benchmarks matching the filter and return the results
+    QJsonObject run(const Options& options);
+
+    /*!
+     * \brief Compare results against a baseline, printing any benchmark whose median time got worse
+     * \param threshold Ratio of current to baseline median time above which a benchmark counts as regressed
+     * \return The number of regressed benchmarks
+     */
+    static int compare(const QJsonObject& baseline, const QJsonObject& current, double threshold);
+
+private:
+    struct Benchmark {
+        QString name;
+        uint64_t itemsPerIteration;
+        Body body;
+    };
+    QList<Benchmark> benchmarks;
+
+    static qint64 sample(const Body& body, uint64_t iterations);
+};
+
+// Registration functions for the benchmark groups, one per source file
+void registerTableBenchmarks(BenchmarkSuite& suite, MockChain& chain, BlockchainInterface* blockchain);
+void registerSerializationBenchmarks(BenchmarkSuite& suite, MockChain& chain, BlockchainInterface* blockchain);
+void registerRowBenchmarks(BenchmarkSuite& suite);
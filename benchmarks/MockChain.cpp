@@ -0,0 +1,163 @@
+#include "MockChain.hpp"
+
+#include <CannedReply.hpp>
+#include <EosioName.hpp>
+#include <Strings.hpp>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <optional>
+
+MockChain::MockChain(QObject* parent) : QObject(parent) {}
+
+void MockChain::setRows(QString table, QString scope, Rows rows) {
+    tables[qMakePair(table, scope)] = std::move(rows);
+}
+
+ApiCallback MockChain::caller() {
+    return [this](QString apiPath, QByteArray json) -> QNetworkReply* {
+        auto* reply = new CannedReply(handle(apiPath, json), 200, this);
+        ++pendingReplies;
+        connect(reply, &QNetworkReply::finished, this, [this] { --pendingReplies; });
+        connect(reply, &QNetworkReply::finished, reply, &QObject::deleteLater, Qt::QueuedConnection);
+        return reply;
+    };
+}
+
+void MockChain::waitIdle() {
+    while (pendingReplies > 0)
+        QCoreApplication::processEvents();
+    // Flush the deferred deletion of the finished replies
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+namespace {
+void packVarUint32(QByteArray& out, uint32_t value) {
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        out += char(byte | (value > 0? 0x80 : 0));
+    } while (value > 0);
+}
+template<typename T>
+void packInteger(QByteArray& out, T value) {
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        out += char((value >> (8 * i)) & 0xff);
+}
+void packString(QByteArray& out, const QString& string) {
+    auto utf8 = string.toUtf8();
+    packVarUint32(out, uint32_t(utf8.size()));
+    out += utf8;
+}
+void packStrings(QByteArray& out, const QStringList& strings) {
+    packVarUint32(out, uint32_t(strings.size()));
+    for (const auto& string : strings)
+        packString(out, string);
+}
+}
+
+MockChain::Row MockChain::memberRow(QString account, uint32_t weight, QStringList tags) {
+    QByteArray packed;
+    packInteger(packed, eosio::string_to_uint64_t(account));
+    packInteger(packed, weight);
+    packStrings(packed, tags);
+    return {QJsonDocument(QJsonObject{{Strings::Account, account}, {Strings::Weight, qint64(weight)},
+                                      {Strings::Tags, QJsonArray::fromStringList(tags)}})
+                    .toJson(QJsonDocument::Compact),
+            '"' + packed.toHex() + '"'};
+}
+
+MockChain::Row MockChain::groupRow(uint64_t id, QString name, QStringList tags) {
+    QByteArray packed;
+    packInteger(packed, id);
+    packString(packed, name);
+    packStrings(packed, tags);
+    return {QJsonDocument(QJsonObject{{Strings::Id, qint64(id)}, {Strings::Name, name},
+                                      {Strings::Tags, QJsonArray::fromStringList(tags)}})
+                    .toJson(QJsonDocument::Compact),
+            '"' + packed.toHex() + '"'};
+}
+
+QString MockChain::accountName(uint64_t index) {
+    // "b" followed by the index in base 31, using only characters valid in account names
+    static const char* alphabet = "12345abcdefghijklmnopqrstuvwxyz";
+    QString name(11, QLatin1Char(alphabet[0]));
+    name[0] = 'b';
+    for (int i = 10; i > 0 && index > 0; --i, index /= 31)
+        name[i] = alphabet[index % 31];
+    return name;
+}
+
+MockChain::Rows MockChain::generateMembers(uint32_t count, uint64_t firstIndex) {
+    static const QStringList tagSets[] = {{}, {"staff"}, {"board", "east"}, {"member", "west", "proxy"}};
+    Rows rows;
+    for (uint64_t i = firstIndex; i < firstIndex + count; ++i) {
+        auto name = accountName(i);
+        rows.emplace_hint(rows.end(), eosio::string_to_uint64_t(name),
+                          memberRow(name, 1 + i % 10, tagSets[i % std::size(tagSets)]));
+    }
+    return rows;
+}
+
+QByteArray MockChain::handle(const QString& apiPath, const QByteArray& json) {
+    if (apiPath == Strings::GetTableRows)
+        return getTableRows(json);
+    if (apiPath == Strings::GetInfo)
+        return QByteArrayLiteral(R"({"chain_id": ")") + QByteArray(64, 'c') +
+               R"(", "head_block_num": 1000, "last_irreversible_block_num": 997, "head_block_id": "000003e8)" +
+               QByteArray(56, 'a') + R"(", "head_block_time": ")" +
+               QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs).chopped(1).toLatin1() + "\"}";
+    return R"({"code": 404, "message": "Not Found"})";
+}
+
+QByteArray MockChain::getTableRows(const QByteArray& json) {
+    auto request = QJsonDocument::fromJson(json).object();
+    auto key = qMakePair(request[Strings::Table].toString(), request[Strings::Scope].toString());
+    const auto& rows = tables[key];
+    auto limit = request.contains(QStringLiteral("limit"))? request[QStringLiteral("limit")].toInt() : 10;
+    bool reverse = request[QStringLiteral("reverse")].toBool();
+    bool json = request[QStringLiteral("json")].toBool();
+
+    // Bounds are numbers, numeric strings, or account names
+    auto lowerBound = request[QStringLiteral("lower_bound")];
+    auto begin = rows.begin();
+    if (lowerBound.isDouble()) {
+        begin = rows.lower_bound(uint64_t(lowerBound.toDouble()));
+    } else if (lowerBound.isString()) {
+        bool numeric = false;
+        auto value = lowerBound.toString().toULongLong(&numeric);
+        begin = rows.lower_bound(numeric? value : eosio::string_to_uint64_t(lowerBound.toString()));
+    }
+
+    QByteArray result = "{\"rows\": [";
+    int count = 0;
+    auto append = [&result, &count, json](const Row& row) {
+        if (count++ > 0)
+            result += ',';
+        result += json? row.json : row.hex;
+    };
+    std::optional<uint64_t> nextKey;
+    if (!reverse) {
+        auto itr = begin;
+        for (; itr != rows.end() && count < limit; ++itr)
+            append(itr->second);
+        if (itr != rows.end())
+            nextKey = itr->first;
+    } else {
+        auto itr = rows.rbegin();
+        auto rend = std::make_reverse_iterator(begin);
+        for (; itr != rend && count < limit; ++itr)
+            append(itr->second);
+        if (itr != rend)
+            nextKey = itr->first;
+    }
+
+    result += "], \"more\": ";
+    result += nextKey? "true" : "false";
+    result += ", \"next_key\": \"" + (nextKey? QByteArray::number(qulonglong(*nextKey)) : QByteArray()) + "\"}";
+    return result;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <AbstractTableInterface.hpp>
+
+#include <QByteArray>
+#include <QMap>
+#include <QObject>
+#include <QPair>
+
+#include <map>
+
+/*!
+ * \brief An in-process stand-in for the node API, serving canned table data through an ApiCallback
+ *
+ * Replies are \ref CannedReply objects, so they finish on the next pass of the event loop, as network replies would,
+ * but without any network or HTTP overhead. This isolates the client's own processing for measurement.
+ */
+class MockChain : public QObject {
+    Q_OBJECT
+
+public:
+    //! A row in both of the forms the node serves: JSON, and packed binary as hex
+    struct Row {
+        QByteArray json;
+        QByteArray hex;
+    };
+    using Rows = std::map<uint64_t, Row>;
+
+    explicit MockChain(QObject* parent = nullptr);
+
+    //! Replace the rows of a table scope; rows are keyed by their primary key
+    void setRows(QString table, QString scope, Rows rows);
+    const Rows& rows(QString table, QString scope) { return tables[qMakePair(table, scope)]; }
+
+    //! Get a callback serving API calls from this chain
+    ApiCallback caller();
+    //! Process events until every reply handed out has finished, including any requests the replies triggered
+    void waitIdle();
+    int pending() const { return pendingReplies; }
+
+    //! Serialize a group.accts row
+    static Row memberRow(QString account, uint32_t weight, QStringList tags);
+    //! Serialize a poll.groups row
+    static Row groupRow(uint64_t id, QString name, QStringList tags);
+    //! Get a valid, unique account name for the given index
+    static QString accountName(uint64_t index);
+    //! Generate the rows for a group.accts table with the given number of members
+    static Rows generateMembers(uint32_t count, uint64_t firstIndex = 0);
+
+private:
+    QMap<QPair<QString, QString>, Rows> tables;
+    int pendingReplies = 0;
+
+    QByteArray handle(const QString& apiPath, const QByteArray& json);
+    QByteArray getTableRows(const QByteArray& json);
+};
@@ -0,0 +1,166 @@
+#include "BenchmarkSuite.hpp"
+#include "MockChain.hpp"
+
+#include <TableSupport.hpp>
+#include <TagIndex.hpp>
+#include <Tables.hpp>
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+
+// A group member as rows held them before accounts and tags were compacted, for comparison
+struct StringGroupMember {
+    QString account;
+    uint32_t weight;
+    QStringList tags;
+};
+REFLECT_STRUCT(StringGroupMember, (account)(weight)(tags))
+
+namespace {
+constexpr int ROWS = 100'000;
+constexpr int LOOKUPS = 1000;
+
+struct RowSets {
+    // Both sets hold the same members, in the same shuffled order
+    QList<GroupMember> compact;
+    QList<StringGroupMember> strings;
+    QList<EosioName> compactLookups;
+    QList<QString> stringLookups;
+};
+
+std::shared_ptr<const RowSets> makeRows() {
+    const QStringList vocabulary = {QStringLiteral("board"), QStringLiteral("staff"), QStringLiteral("member"),
+                                    QStringLiteral("founder"), QStringLiteral("observer")};
+    QList<int> order(ROWS);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), QRandomGenerator(1));
+
+    auto rows = std::make_shared<RowSets>();
+    rows->compact.reserve(ROWS);
+    rows->strings.reserve(ROWS);
+    for (int i : order) {
+        auto account = MockChain::accountName(i);
+        // Decoded rows each have their own copies of their strings, so don't let them share the vocabulary's
+        QStringList tags = {QString::fromUtf8(vocabulary[i % 5].toUtf8()),
+                            QString::fromUtf8(vocabulary[(i / 5) % 5].toUtf8())};
+        rows->compact.append(GroupMember{EosioName(account), uint32_t(1 + i % 10), InternedStringList(tags)});
+        rows->strings.append(StringGroupMember{account, uint32_t(1 + i % 10), tags});
+    }
+    for (int i = 0; i < LOOKUPS; ++i) {
+        auto account = MockChain::accountName(i * (ROWS / LOOKUPS));
+        rows->compactLookups.append(EosioName(account));
+        rows->stringLookups.append(account);
+    }
+    return rows;
+}
+
+template<typename List, typename Less>
+List sorted(List rows, Less less) {
+    std::sort(rows.begin(), rows.end(), less);
+    return rows;
+}
+}
+
+void registerRowBenchmarks(BenchmarkSuite& suite) {
+    auto rows = std::make_shared<std::shared_ptr<const RowSets>>();
+    auto loaded = [rows](Stopwatch& watch) -> const RowSets& {
+        if (!*rows) {
+            watch.pause();
+            *rows = makeRows();
+            qInfo() << "Approximate bytes per group.accts row:" << approximateRowListBytes((*rows)->compact) / ROWS
+                    << "compact," << approximateRowListBytes((*rows)->strings) / ROWS << "with string fields";
+            watch.resume();
+        }
+        return **rows;
+    };
+
+    auto byAccount = [](const StringGroupMember& a, const StringGroupMember& b) { return a.account < b.account; };
+    suite.add(QStringLiteral("rows/sort/group.accts/100k"), ROWS, [loaded](Stopwatch& watch) {
+        const auto& sets = loaded(watch);
+        watch.pause();
+        auto copy = sets.compact;
+        copy.detach();
+        watch.resume();
+        std::sort(copy.begin(), copy.end(), CompareId<GroupMember>());
+    });
+    suite.add(QStringLiteral("rows/sort/strings/group.accts/100k"), ROWS, [loaded, byAccount](Stopwatch& watch) {
+        const auto& sets = loaded(watch);
+        watch.pause();
+        auto copy = sets.strings;
+        copy.detach();
+        watch.resume();
+        std::sort(copy.begin(), copy.end(), byAccount);
+    });
+
+    // Lookups by account in sorted rows, as the tables make them
+    auto sortedCompact = std::make_shared<QList<GroupMember>>();
+    suite.add(QStringLiteral("rows/find/group.accts/100k"), LOOKUPS, [loaded, sortedCompact](Stopwatch& watch) {
+        const auto& sets = loaded(watch);
+        if (sortedCompact->isEmpty()) {
+            watch.pause();
+            *sortedCompact = sorted(sets.compact, CompareId<GroupMember>());
+            watch.resume();
+        }
+        for (auto id : sets.compactLookups)
+            std::lower_bound(sortedCompact->cbegin(), sortedCompact->cend(), id, CompareId<GroupMember>());
+    });
+    auto sortedStrings = std::make_shared<QList<StringGroupMember>>();
+    suite.add(QStringLiteral("rows/find/strings/group.accts/100k"), LOOKUPS,
+              [loaded, sortedStrings, byAccount](Stopwatch& watch) {
+        const auto& sets = loaded(watch);
+        if (sortedStrings->isEmpty()) {
+            watch.pause();
+            *sortedStrings = sorted(sets.strings, byAccount);
+            watch.resume();
+        }
+        for (const auto& id : sets.stringLookups)
+            std::lower_bound(sortedStrings->cbegin(), sortedStrings->cend(), id,
+                             [](const StringGroupMember& row, const QString& id) { return row.account < id; });
+    });
+
+    // Handing rows to QML, which converts the compact fields back to strings
+    suite.add(QStringLiteral("rows/toVariantMap/group.accts/1000"), 1000, [loaded](Stopwatch& watch) {
+        const auto& compact = loaded(watch).compact;
+        for (int i = 0; i < 1000; ++i)
+            Convert<GroupMember>::toVariantMap(compact[i]);
+    });
+
+    // Tag queries, answered from the tag index and by checking every row
+    const auto expression = TagExpression::parse(QStringLiteral("(board | staff) & !observer"));
+    auto index = std::make_shared<std::unique_ptr<TagIndex<EosioName>>>();
+    auto indexed = [loaded, index](Stopwatch& watch) -> TagIndex<EosioName>& {
+        const auto& compact = loaded(watch).compact;
+        if (!*index) {
+            watch.pause();
+            *index = std::make_unique<TagIndex<EosioName>>();
+            for (const auto& row : compact)
+                (*index)->setRow(row.getId(), row.tags);
+            watch.resume();
+        }
+        return **index;
+    };
+    suite.add(QStringLiteral("rows/tags/count/index/100k"), ROWS, [indexed, expression](Stopwatch& watch) {
+        indexed(watch).count(expression);
+    });
+    suite.add(QStringLiteral("rows/tags/count/scan/100k"), ROWS, [loaded, expression](Stopwatch& watch) {
+        const auto& compact = loaded(watch).compact;
+        std::count_if(compact.begin(), compact.end(),
+                      [&expression](const GroupMember& row) { return expression.matches(row.tags); });
+    });
+    suite.add(QStringLiteral("rows/tags/find/index/100k"), ROWS, [indexed, expression](Stopwatch& watch) {
+        indexed(watch).find(expression);
+    });
+    suite.add(QStringLiteral("rows/tags/update/index/100k"), ROWS, [loaded, indexed](Stopwatch& watch) {
+        auto& index = indexed(watch);
+        const auto& compact = loaded(watch).compact;
+        // Each row's tags go through the index twice, changing and then changing back
+        const InternedStringList changed(QStringList{QStringLiteral("staff")});
+        for (const auto& row : compact)
+            index.setRow(row.getId(), changed);
+        for (const auto& row : compact)
+            index.setRow(row.getId(), row.tags);
+    });
+}
@@ -0,0 +1,187 @@
+#include "BenchmarkSuite.hpp"
+#include "MockChain.hpp"
+
+#include <BlockchainInterface.hpp>
+#include <BroadcastableTransaction.hpp>
+#include <EosioName.hpp>
+#include <KeyManager.hpp>
+#include <MutableTransaction.hpp>
+#include <RowDecoder.hpp>
+#include <SignableTransaction.hpp>
+#include <Strings.hpp>
+#include <TableSupport.hpp>
+#include <Tables.hpp>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace {
+QJsonArray memberArray(uint32_t count) {
+    QByteArray json = "[";
+    for (const auto& row : MockChain::generateMembers(count)) {
+        if (json.size() > 1)
+            json += ',';
+        json += row.second.json;
+    }
+    return QJsonDocument::fromJson(json + ']').array();
+}
+
+QJsonArray groupArray(uint32_t count) {
+    QJsonArray array;
+    for (uint64_t id = 0; id < count; ++id)
+        array.append(QJsonDocument::fromJson(MockChain::groupRow(id, QStringLiteral("Group %1").arg(id),
+                                                                 {QStringLiteral("bench")}).json).object());
+    return array;
+}
+
+MutableTransaction* voterAddTransaction(BlockchainInterface* blockchain, int voters) {
+    auto* transaction = blockchain->createTransaction();
+    for (int i = 0; i < voters; ++i)
+        transaction->addAction(Strings::VoterAdd, QJsonObject{
+            {Strings::GroupName, QStringLiteral("Group 1")},
+            {Strings::Voter, MockChain::accountName(i)},
+            {Strings::Weight, 1},
+            {Strings::Tags, QJsonArray{QStringLiteral("bench")}}
+        });
+    return transaction;
+}
+}
+
+void registerSerializationBenchmarks(BenchmarkSuite& suite, MockChain& chain, BlockchainInterface* blockchain) {
+    Q_UNUSED(chain)
+
+    // Row conversions between JSON, structs and variant maps
+    auto members = memberArray(1000);
+    auto groups = groupArray(1000);
+    suite.add(QStringLiteral("convert/fromJsonArray/group.accts/1000"), 1000, [members](Stopwatch&) {
+        Convert<GroupMember>::fromJsonArray(members);
+    });
+    suite.add(QStringLiteral("convert/fromJsonArray/poll.groups/1000"), 1000, [groups](Stopwatch&) {
+        Convert<PollingGroup>::fromJsonArray(groups);
+    });
+
+    // A get_table_rows response page as it comes off the wire, through to rows
+    auto page = QByteArray("{\"rows\": ") + QJsonDocument(memberArray(100)).toJson(QJsonDocument::Compact) +
+                ", \"more\": true, \"next_key\": \"12345\"}";
+    suite.add(QStringLiteral("convert/parseAndConvert/group.accts/100"), 100, [page](Stopwatch&) {
+        QJsonValue nextKey;
+        auto rows = parseRows(QJsonDocument::fromJson(page), &nextKey);
+        if (rows)
+            Convert<GroupMember>::fromJsonArray(*rows);
+    });
+    suite.add(QStringLiteral("convert/decodeResponse/group.accts/100"), 100, [page](Stopwatch&) {
+        QList<GroupMember> rows;
+        std::optional<QString> nextKey;
+        RowDecoder<GroupMember>::decodeResponse(page, rows, &nextKey);
+    });
+    auto bigPage = QByteArray("{\"rows\": ") + QJsonDocument(members).toJson(QJsonDocument::Compact) +
+                   ", \"more\": false, \"next_key\": \"\"}";
+    suite.add(QStringLiteral("convert/parseAndConvert/group.accts/1000"), 1000, [bigPage](Stopwatch&) {
+        QJsonValue nextKey;
+        auto rows = parseRows(QJsonDocument::fromJson(bigPage), &nextKey);
+        if (rows)
+            Convert<GroupMember>::fromJsonArray(*rows);
+    });
+    suite.add(QStringLiteral("convert/decodeResponse/group.accts/1000"), 1000, [bigPage](Stopwatch&) {
+        QList<GroupMember> rows;
+        RowDecoder<GroupMember>::decodeResponse(bigPage, rows);
+    });
+    QByteArray binaryPage = "{\"rows\": [";
+    for (const auto& row : MockChain::generateMembers(1000))
+        binaryPage += row.second.hex + ',';
+    binaryPage.chop(1);
+    binaryPage += "], \"more\": false, \"next_key\": \"\"}";
+    suite.add(QStringLiteral("convert/decodeResponse/binary/group.accts/1000"), 1000, [binaryPage](Stopwatch&) {
+        QList<GroupMember> rows;
+        RowDecoder<GroupMember>::decodeResponse(binaryPage, rows);
+    });
+
+    auto memberRows = Convert<GroupMember>::fromJsonArray(members);
+    suite.add(QStringLiteral("convert/toVariantMap/group.accts/1000"), 1000, [memberRows](Stopwatch&) {
+        for (const auto& row : memberRows)
+            Convert<GroupMember>::toVariantMap(row);
+    });
+    suite.add(QStringLiteral("convert/toJsonObject/group.accts/1000"), 1000, [memberRows](Stopwatch&) {
+        for (const auto& row : memberRows)
+            Convert<GroupMember>::toJsonObject(row);
+    });
+    QList<QVariantMap> memberMaps;
+    for (const auto& row : memberRows)
+        memberMaps.append(Convert<GroupMember>::toVariantMap(row));
+    suite.add(QStringLiteral("convert/fromVariantMap/group.accts/1000"), 1000, [memberMaps](Stopwatch&) {
+        for (const auto& map : memberMaps)
+            Convert<GroupMember>::fromVariantMap(map);
+    });
+
+    // Account name encoding
+    QStringList names;
+    QList<uint64_t> values;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        names.append(MockChain::accountName(i));
+        values.append(eosio::string_to_uint64_t(names.last()));
+    }
+    suite.add(QStringLiteral("eosio/string_to_uint64_t"), 1000, [names](Stopwatch&) {
+        for (const auto& name : names)
+            eosio::string_to_uint64_t(name);
+    });
+    suite.add(QStringLiteral("eosio/name_to_string"), 1000, [values](Stopwatch&) {
+        for (auto value : values)
+            eosio::name_to_string(value);
+    });
+
+    // Transaction preparation, signing and packing, with a ten-action transaction
+    auto* keyManager = new KeyManager(blockchain);
+    keyManager->setBlockchain(blockchain);
+    suite.add(QStringLiteral("keymanager/prepareForSigning"), 1, [blockchain, keyManager](Stopwatch& watch) {
+        watch.pause();
+        auto* transaction = voterAddTransaction(blockchain, 10);
+        watch.resume();
+
+        auto* signable = keyManager->prepareForSigning(transaction);
+
+        watch.pause();
+        delete signable;
+        delete transaction;
+        watch.resume();
+    });
+    suite.add(QStringLiteral("keymanager/signTransaction"), 1, [blockchain, keyManager](Stopwatch& watch) {
+        watch.pause();
+        auto* transaction = voterAddTransaction(blockchain, 10);
+        auto* signable = keyManager->prepareForSigning(transaction);
+        watch.resume();
+
+        keyManager->signTransaction(signable);
+
+        watch.pause();
+        delete signable;
+        delete transaction;
+        watch.resume();
+    });
+    suite.add(QStringLiteral("keymanager/prepareForBroadcast"), 1, [blockchain, keyManager](Stopwatch& watch) {
+        watch.pause();
+        auto* transaction = voterAddTransaction(blockchain, 10);
+        auto* signable = keyManager->prepareForSigning(transaction);
+        keyManager->signTransaction(signable);
+        watch.resume();
+
+        auto* broadcastable = keyManager->prepareForBroadcast(signable);
+
+        watch.pause();
+        delete broadcastable;
+        delete signable;
+        delete transaction;
+        watch.resume();
+    });
+    suite.add(QStringLiteral("keymanager/fullPath"), 1, [blockchain, keyManager](Stopwatch& watch) {
+        auto* transaction = voterAddTransaction(blockchain, 10);
+        auto* signable = keyManager->prepareForSigning(transaction);
+        keyManager->signTransaction(signable);
+        auto* broadcastable = keyManager->prepareForBroadcast(signable);
+
+        watch.pause();
+        delete broadcastable;
+        delete signable;
+        delete transaction;
+        watch.resume();
+    });
+}
@@ -0,0 +1,274 @@
+#include "BenchmarkSuite.hpp"
+#include "MockChain.hpp"
+
+#include <BlockchainInterface.hpp>
+#include <EosioName.hpp>
+#include <JournalRouter.hpp>
+#include <Strings.hpp>
+#include <Tables.hpp>
+
+#include <QDebug>
+#include <QRandomGenerator>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+
+namespace {
+// Scopes used for the benchmark tables; kept clear of the scopes used by the virtual field fixture
+constexpr uint64_t MEMBERS_SCOPE_BASE = 1'000'000;
+constexpr uint64_t UNRELATED_SCOPE = 999'999;
+
+struct LoadedMembers {
+    GroupMembersTable* table;
+    QAbstractListModel* model;
+};
+
+// Create a group.accts table with the given number of members, fully loaded and with a model attached
+LoadedMembers loadMembers(MockChain& chain, BlockchainInterface* blockchain, uint64_t scope, uint32_t count) {
+    chain.setRows(Strings::GroupAccts, QString::number(scope), MockChain::generateMembers(count));
+    auto* table = new GroupMembersTable(blockchain, chain.caller(), scope);
+    auto* model = table->allRows();
+    model->setParent(table);
+    chain.waitIdle();
+    return {table, model};
+}
+
+// Make a fixture which is created the first time a benchmark runs, so filtered out benchmarks cost nothing
+template<typename Fixture, typename Setup>
+auto lazyFixture(Setup setup) {
+    return [setup, fixture = std::make_shared<std::optional<Fixture>>()](Stopwatch& watch) -> Fixture& {
+        if (!fixture->has_value()) {
+            watch.pause();
+            *fixture = setup();
+            watch.resume();
+        }
+        return **fixture;
+    };
+}
+
+QList<JournalEntry> journalEntries(uint64_t scope, const MockChain::Rows& rows, int count,
+                                   JournalEntry::EntryType type) {
+    QList<JournalEntry> entries;
+    auto timestamp = QDateTime::currentDateTimeUtc();
+    for (auto itr = rows.begin(); itr != rows.end() && entries.size() < count; ++itr) {
+        JournalEntry entry;
+        entry.id = entries.size();
+        entry.timestamp = timestamp;
+        entry.table = Strings::GroupAccts;
+        entry.scope = scope;
+        entry.key = itr->first;
+        entry.type = type;
+        entries.append(entry);
+    }
+    return entries;
+}
+}
+
+void registerTableBenchmarks(BenchmarkSuite& suite, MockChain& chain, BlockchainInterface* blockchain) {
+    // Initial load of a table: every row is new
+    for (uint32_t size : {100, 1000, 10000}) {
+        auto scope = MEMBERS_SCOPE_BASE + size;
+        suite.add(QStringLiteral("table/fullRefresh/group.accts/%1").arg(size), size,
+                  [&chain, blockchain, scope, size, rowsSet = false](Stopwatch& watch) mutable {
+            watch.pause();
+            if (!rowsSet) {
+                chain.setRows(Strings::GroupAccts, QString::number(scope), MockChain::generateMembers(size));
+                rowsSet = true;
+            }
+            auto* table = new GroupMembersTable(blockchain, chain.caller(), scope);
+            watch.resume();
+
+            table->fullRefresh();
+            chain.waitIdle();
+
+            watch.pause();
+            delete table;
+            watch.resume();
+        });
+    }
+
+    // Refresh of a loaded table with a model attached: every row is merged over an identical existing row
+    auto merged = lazyFixture<LoadedMembers>([&chain, blockchain] {
+        return loadMembers(chain, blockchain, MEMBERS_SCOPE_BASE + 1, 1000);
+    });
+    suite.add(QStringLiteral("table/fullRefresh/merge/group.accts/1000"), 1000, [&chain, merged](Stopwatch& watch) {
+        merged(watch).table->fullRefresh();
+        chain.waitIdle();
+    });
+
+    // A burst of modifications to rows in the table, each of which is reloaded
+    auto journaled = lazyFixture<LoadedMembers>([&chain, blockchain] {
+        return loadMembers(chain, blockchain, MEMBERS_SCOPE_BASE + 2, 1000);
+    });
+    suite.add(QStringLiteral("table/processJournal/group.accts/1000"), 100,
+              [&chain, journaled, entries = QList<JournalEntry>()](Stopwatch& watch) mutable {
+        auto& fixture = journaled(watch);
+        if (entries.isEmpty())
+            entries = journalEntries(MEMBERS_SCOPE_BASE + 2,
+                                     chain.rows(Strings::GroupAccts, QString::number(MEMBERS_SCOPE_BASE + 2)),
+                                     100, JournalEntry::ModifyRow);
+        fixture.table->processJournal(entries);
+        chain.waitIdle();
+    });
+
+    // The same burst, while another thread keeps reading the table's snapshots. Each snapshot read is checked for
+    // consistency, so a snapshot changing under its reader shows up as a warning rather than only as a timing
+    auto snapshotted = lazyFixture<LoadedMembers>([&chain, blockchain] {
+        return loadMembers(chain, blockchain, MEMBERS_SCOPE_BASE + 5, 1000);
+    });
+    suite.add(QStringLiteral("table/processJournal/concurrentSnapshots/group.accts/1000"), 100,
+              [&chain, snapshotted, entries = QList<JournalEntry>()](Stopwatch& watch) mutable {
+        auto& fixture = snapshotted(watch);
+        if (entries.isEmpty())
+            entries = journalEntries(MEMBERS_SCOPE_BASE + 5,
+                                     chain.rows(Strings::GroupAccts, QString::number(MEMBERS_SCOPE_BASE + 5)),
+                                     100, JournalEntry::ModifyRow);
+
+        watch.pause();
+        std::atomic<bool> stop = false;
+        uint64_t reads = 0, inconsistent = 0;
+        std::thread reader([table = fixture.table, &stop, &reads, &inconsistent] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto snapshot = table->snapshot();
+                bool consistent = snapshot->rows.size() == snapshot->states.size();
+                for (qsizetype i = 1; consistent && i < snapshot->rows.size(); ++i)
+                    consistent = snapshot->rows[i - 1].getId() < snapshot->rows[i].getId();
+                ++reads;
+                if (!consistent)
+                    ++inconsistent;
+            }
+        });
+        watch.resume();
+
+        fixture.table->processJournal(entries);
+        chain.waitIdle();
+
+        watch.pause();
+        stop = true;
+        reader.join();
+        if (inconsistent > 0)
+            qWarning() << "Snapshot benchmark:" << inconsistent << "of" << reads << "snapshots read were inconsistent";
+        watch.resume();
+    });
+
+    // Journal entries for other tables, which every table sees and must skip
+    suite.add(QStringLiteral("table/processJournal/unrelated"), 1000,
+              [journaled, entries = QList<JournalEntry>()](Stopwatch& watch) mutable {
+        auto& fixture = journaled(watch);
+        if (entries.isEmpty())
+            entries = journalEntries(UNRELATED_SCOPE, MockChain::generateMembers(1000), 1000, JournalEntry::ModifyRow);
+        fixture.table->processJournal(entries);
+    });
+
+    // A journal batch routed across many open tables, only a few of which it concerns
+    struct RoutedTables {
+        JournalRouter* router;
+        QList<JournalEntry> entries;
+    };
+    auto routed = lazyFixture<RoutedTables>([&chain, blockchain] {
+        auto* router = new JournalRouter(&chain);
+        for (uint64_t scope = 0; scope < 1000; ++scope)
+            router->addTable(new GroupMembersTable(blockchain, chain.caller(), MEMBERS_SCOPE_BASE + 100'000 + scope));
+        QList<JournalEntry> entries;
+        auto members = MockChain::generateMembers(100);
+        for (uint64_t scope = 0; scope < 1000; scope += 100)
+            entries.append(journalEntries(MEMBERS_SCOPE_BASE + 100'000 + scope, members, 100, JournalEntry::ModifyRow));
+        return RoutedTables{router, entries};
+    });
+    suite.add(QStringLiteral("journal/route/1000tables"), 1000, [routed](Stopwatch& watch) {
+        auto& fixture = routed(watch);
+        fixture.router->route(fixture.entries);
+    });
+
+    // Draft edit cycles, as the edit UI makes them
+    auto drafted = lazyFixture<LoadedMembers>([&chain, blockchain] {
+        return loadMembers(chain, blockchain, MEMBERS_SCOPE_BASE + 3, 1000);
+    });
+    suite.add(QStringLiteral("table/draft/editReset"), 100,
+              [&chain, drafted, ids = QVariantList()](Stopwatch& watch) mutable {
+        auto& fixture = drafted(watch);
+        if (ids.isEmpty())
+            for (const auto& row : chain.rows(Strings::GroupAccts, QString::number(MEMBERS_SCOPE_BASE + 3)))
+                if (ids.size() < 100)
+                    ids.append(eosio::name_to_string(row.first));
+        for (int i = 0; i < ids.size(); ++i)
+            fixture.table->draftEditRow(ids[i], {{Strings::Weight, 100 + i}});
+        fixture.table->resetEdits();
+    });
+    suite.add(QStringLiteral("table/draft/addReset"), 100, [drafted](Stopwatch& watch) {
+        auto& fixture = drafted(watch);
+        for (uint64_t i = 0; i < 100; ++i)
+            fixture.table->draftAddRow({{Strings::Account, MockChain::accountName(1'000'000 + i)},
+                                        {Strings::Weight, 1},
+                                        {Strings::Tags, QStringList{QStringLiteral("new")}}});
+        fixture.table->resetEdits();
+    });
+    suite.add(QStringLiteral("table/draft/pendingCycle"), 100, [drafted](Stopwatch& watch) {
+        auto& fixture = drafted(watch);
+        for (uint64_t i = 0; i < 100; ++i)
+            fixture.table->draftAddRow({{Strings::Account, MockChain::accountName(2'000'000 + i)},
+                                        {Strings::Weight, 1},
+                                        {Strings::Tags, QStringList{QStringLiteral("new")}}});
+        fixture.table->markEditsPending();
+        fixture.table->resetEdits();
+    });
+
+    // Model reads, as views make them
+    auto modeled = lazyFixture<LoadedMembers>([&chain, blockchain] {
+        return loadMembers(chain, blockchain, MEMBERS_SCOPE_BASE + 4, 1000);
+    });
+    suite.add(QStringLiteral("model/data/sequential/group.accts/1000"), 1000, [modeled](Stopwatch& watch) {
+        auto* model = modeled(watch).model;
+        auto roles = model->roleNames().keys();
+        for (int i = 0; i < model->rowCount(); ++i) {
+            auto index = model->index(i);
+            for (int role : roles)
+                model->data(index, role);
+        }
+    });
+    suite.add(QStringLiteral("model/data/random/group.accts/1000"), 1000,
+              [modeled, rows = QList<int>()](Stopwatch& watch) mutable {
+        auto* model = modeled(watch).model;
+        if (rows.isEmpty()) {
+            QRandomGenerator random(1);
+            for (int i = 0; i < 1000; ++i)
+                rows.append(random.bounded(model->rowCount()));
+        }
+        auto roles = model->roleNames().keys();
+        for (int row : rows)
+            model->data(model->index(row), roles[row % roles.size()]);
+    });
+
+    // Virtual fields: each poll group's size is computed from its member table
+    struct LoadedGroups {
+        QAbstractListModel* model;
+    };
+    auto groups = lazyFixture<LoadedGroups>([&chain, blockchain] {
+        MockChain::Rows groupRows;
+        for (uint64_t id = 0; id < 100; ++id) {
+            groupRows[id] = MockChain::groupRow(id, QStringLiteral("Group %1").arg(id), {QStringLiteral("bench")});
+            chain.setRows(Strings::GroupAccts, QString::number(id), MockChain::generateMembers(10, id * 10));
+        }
+        chain.setRows(Strings::PollGroups, QString::number(eosio::string_to_uint64_t(Strings::Global)), groupRows);
+
+        auto* model = blockchain->getPollingGroupTable()->allRows();
+        chain.waitIdle();
+        // Touch every virtual field once so the member tables get loaded before measuring
+        for (int i = 0; i < model->rowCount(); ++i)
+            for (int role : model->roleNames().keys())
+                model->data(model->index(i), role);
+        chain.waitIdle();
+        return LoadedGroups{model};
+    });
+    suite.add(QStringLiteral("model/data/virtual/poll.groups/100"), 100, [groups](Stopwatch& watch) {
+        auto* model = groups(watch).model;
+        auto roles = model->roleNames().keys();
+        for (int i = 0; i < model->rowCount(); ++i) {
+            auto index = model->index(i);
+            for (int role : roles)
+                model->data(index, role);
+        }
+    });
+}
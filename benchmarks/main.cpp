@@ -0,0 +1,105 @@
+#include "BenchmarkSuite.hpp"
+#include "MockChain.hpp"
+
+#include <BlockchainInterface.hpp>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QDebug>
+
+#include <cstdio>
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("pollaris-bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Pollaris table and serialization microbenchmarks");
+    parser.addHelpOption();
+    QCommandLineOption filterOption({"f", "filter"}, "Only run benchmarks whose names match this regex", "regex");
+    QCommandLineOption minSampleOption("min-sample-ms", "Minimum duration of a sample (default 20)", "ms", "20");
+    QCommandLineOption samplesOption("samples", "Number of samples to take of each benchmark (default 10)", "count",
+                                     "10");
+    QCommandLineOption outputOption({"o", "output"}, "Write the JSON results to this file rather than stdout", "file");
+    QCommandLineOption baselineOption("baseline", "Compare the results against this previous results file, and exit "
+                                                  "with failure if any benchmark regressed", "file");
+    QCommandLineOption thresholdOption("threshold", "Ratio of current to baseline median time counted as a "
+                                                    "regression (default 1.10)", "ratio", "1.10");
+    QCommandLineOption listOption("list", "List the benchmarks' names and exit");
+    parser.addOptions({filterOption, minSampleOption, samplesOption, outputOption, baselineOption, thresholdOption,
+                       listOption});
+    parser.process(app);
+
+    // The tables log every row they touch, which would swamp both the output and the measurements
+    QLoggingCategory::setFilterRules(QStringLiteral("default.info=false\ndefault.debug=false"));
+
+    // Connect the blockchain to the mock chain, and let it sync once so it has a chain ID and head block
+    MockChain chain;
+    BlockchainInterface blockchain;
+    blockchain.setTransport(chain.caller());
+    blockchain.setNodeUrl(QStringLiteral("http://mock.invalid"));
+    chain.waitIdle();
+    blockchain.disconnect();
+    chain.waitIdle();
+    if (blockchain.chainId().isEmpty()) {
+        qCritical() << "Benchmark chain failed to sync";
+        return 1;
+    }
+
+    BenchmarkSuite suite;
+    registerTableBenchmarks(suite, chain, &blockchain);
+    registerSerializationBenchmarks(suite, chain, &blockchain);
+    registerRowBenchmarks(suite);
+
+    BenchmarkSuite::Options options;
+    options.filter = QRegularExpression(parser.value(filterOption));
+    if (!options.filter.isValid()) {
+        qCritical() << "Invalid filter:" << options.filter.errorString();
+        return 1;
+    }
+    options.minSampleNsecs = parser.value(minSampleOption).toLongLong() * 1'000'000;
+    options.samples = std::max(1, parser.value(samplesOption).toInt());
+
+    if (parser.isSet(listOption)) {
+        for (const auto& name : suite.names())
+            if (options.filter.match(name).hasMatch())
+                std::printf("%s\n", qPrintable(name));
+        return 0;
+    }
+
+    auto results = suite.run(options);
+    results[QStringLiteral("qtVersion")] = QString::fromLatin1(qVersion());
+    results[QStringLiteral("timestamp")] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    auto json = QJsonDocument(results).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QSaveFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+            qCritical() << "Failed to write results to" << file.fileName() << file.errorString();
+            return 1;
+        }
+    } else {
+        std::fwrite(json.constData(), 1, json.size(), stdout);
+    }
+
+    if (parser.isSet(baselineOption)) {
+        QFile file(parser.value(baselineOption));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCritical() << "Failed to read baseline" << file.fileName() << file.errorString();
+            return 1;
+        }
+        auto baseline = QJsonDocument::fromJson(file.readAll()).object();
+        auto regressions = BenchmarkSuite::compare(baseline, results, parser.value(thresholdOption).toDouble());
+        if (regressions > 0) {
+            std::fprintf(stderr, "%d benchmark(s) regressed\n", regressions);
+            return 2;
+        }
+    }
+
+    return 0;
+}
@@ -2,11 +2,19 @@
 
 #include <AbstractTableInterface.hpp>
 #include <TableSupport.hpp>
+#include <RowDecoder.hpp>
+#include <TagIndex.hpp>
 #include <EosioName.hpp>
+#include <FpsTimer.hpp>
 
 #include <QDebug>
 #include <QJSEngine>
 
+#include <array>
+#include <memory>
+#include <optional>
+#include <set>
+
 /*!
  * \brief A CRTP-style template defining the interface of a virtual field
  *
@@ -65,6 +73,9 @@ public:
     QPair<Type, LoadState> get(const RowType& row, LoadState rowState) {
         return static_cast<ConcreteField*>(this)->get(row, rowState);
     }
+
+    // The number of child objects the field owns, for memory accounting
+    int childCount() const { return children.size(); }
 };
 
 //! This template defines the virtual fields for a given row type. By default, there are no virtual fields, but they
@@ -83,6 +94,14 @@ struct TableName {
     constexpr static const QString* name = &Strings::UnknownTable;
 };
 
+//! This template may be specialized for a given row type to give access to the row's tags, so that the table can
+//! index its rows by tag and answer tag queries. Specializations must set defined to true and provide
+//! static const InternedStringList& get(const Row&).
+template<class Row>
+struct RowTags {
+    static const bool defined = false;
+};
+
 /*!
  * \brief A template for a table in the database
  *
@@ -113,6 +132,8 @@ class AbstractTable : public AbstractTableInterface {
     using RowOps = TableRowOperations<Row>;
 
     ApiCallback callApi;
+    //! Rows are requested in binary if their layout is known, unless the node's rows turn out not to match it
+    RowFormat rowFormat = BinaryRows<Row>::value? RowFormat::Binary : RowFormat::Json;
 
     using RowFields = typename infra::reflector<Row>::members;
     using RowId = ::RowId<Row>;
@@ -123,8 +144,8 @@ class AbstractTable : public AbstractTableInterface {
     // Parallel array to rowList, the LoadState of the corresponding row
     QVector<LoadState> rowStates;
 
-    // The list of rows in DraftAdd or PendingAdd states, awaiting placement in rowList
-    QList<QVariantMap> locallyAddedRows;
+    // The rows in DraftAdd or PendingAdd states, awaiting placement in rowList
+    PendingInsertions<Row> locallyAddedRows;
 
     // Original copies of rows that have been edited; also serves as a list of edited rows
     BackupManager<Row> backups;
@@ -134,13 +155,58 @@ class AbstractTable : public AbstractTableInterface {
         return r;
     }
 
+    // The latest snapshot of the table published for readers on other threads; only ever accessed atomically
+    std::shared_ptr<const TableSnapshot<Row>> publishedSnapshot = std::make_shared<const TableSnapshot<Row>>();
+    quint64 snapshotVersion = 0;
+    bool snapshotQueued = false;
+    // Called after changing rowList or rowStates; publishes a new snapshot once the current batch of changes is done
+    void tableChanged();
+    void publishSnapshot();
+
     // Map of row IDs being loaded to the time we started loading them; used to avoid duplicating load requests
     std::map<RowId, qint64> loadingRows;
     bool rowIsLoading(RowId id, bool markAsLoading = false);
+    // Number of requests for rows awaiting a response
+    int requestsInFlight = 0;
+    // Request rows from the backend, counting the request in flight until it finishes
+    QNetworkReply* requestRows(QByteArray json);
+
+    // Index of the rows by tag; only maintained if the rows have tags
+    TagIndex<RowId> tagIndex;
+    // Called after a row is added or its content changes, and after a row is deleted, to keep tagIndex current
+    void indexRow(const Row& row) {
+        if constexpr (RowTags<Row>::defined)
+            tagIndex.setRow(row.getId(), RowTags<Row>::get(row));
+    }
+    void unindexRow(RowId id) {
+        if constexpr (RowTags<Row>::defined)
+            tagIndex.removeRow(id);
+    }
+
+    // The changes made since the irreversible block, which the irreversible view undoes
+    ForkDelta<Row> forkDelta;
+    quint64 irreversibleBlock = 0;
+    // The changes the last fork rolled back, kept until they are replayed from the new chain or can no longer be
+    typename ForkDelta<Row>::Changes revertedChanges;
+    // The delta as of the last snapshot, shared with the snapshots until the delta changes
+    std::shared_ptr<const ForkDelta<Row>> publishedDelta;
+    bool deltaChanged = false;
+    // Called before a journal entry from a reversible block changes a row, to save the row as it was
+    void recordSpeculative(RowId id, uint64_t block);
+    // Put a row in the table with the given state, as it was before changes which were reverted
+    void putRow(const Row& row, LoadState state);
 
     class Model : public QAbstractListModel {
+    public:
+        // Selects the rows a model shows; a model with no filter shows all rows
+        using Filter = std::function<bool(const Row&)>;
+
+    private:
         AbstractTable* table = nullptr;
         BlockchainInterface* blockchain = nullptr;
+        Filter filter;
+        // If set, the model shows the rows as of the irreversible block, rather than the head block
+        bool irreversible = false;
 
         // List of the row IDs this model shows
         QList<RowId> modelIds;
@@ -165,10 +231,64 @@ class AbstractTable : public AbstractTableInterface {
         //! The number of virtual roles
         static constexpr int VIRTUAL_ROLE_COUNT = infra::typelist::length<VirtualFields>();
 
-        void updateVirtualRoles(const Row& row, LoadState rowState, VirtualFieldTuple& virtualFields);
+        // Accessors of each physical role's field, and each virtual role's field, indexed from the role's base
+        using FieldAccessor = QVariant (*)(const Row&);
+        using VirtualAccessor = QVariant (*)(VirtualFieldTuple&, const Row&, LoadState);
+        static const std::array<FieldAccessor, PHYSICAL_ROLE_COUNT>& fieldAccessors();
+        static const std::array<VirtualAccessor, VIRTUAL_ROLE_COUNT>& virtualAccessors();
+
+        struct CachedVirtualValue {
+            QVariant value;
+            LoadState state = LoadState::Loading;
+            bool valid = false;
+        };
+        struct RowCache {
+            // Index of the row in the table's rowList when last looked up; checked before use, as it may have moved
+            int tableIndex = -1;
+            // Values of the virtual fields as last returned by data(), kept until the field or row changes
+            std::array<CachedVirtualValue, VIRTUAL_ROLE_COUNT> virtualValues;
+        };
+        // Lookup caches for data(), parallel to modelIds above
+        mutable QList<RowCache> rowCaches;
+
+        //! The fraction of the model which, when changed at once, is announced wholesale rather than row by row
+        static constexpr double BULK_CHANGE_FRACTION = .5;
+        //! The minimum number of rows changed at once to be announced wholesale
+        static constexpr int BULK_CHANGE_MIN_ROWS = 64;
+        static_assert(VIRTUAL_ROLE_BASE + VIRTUAL_ROLE_COUNT <= 64, "Role sets are stored as 64-bit masks");
+        static constexpr uint64_t ALL_ROLES = ~uint64_t(0);
+
+        // Data changes not yet announced to the views, by row ID, with the set of roles changed as a bitmask. These
+        // are announced together, once per frame, to keep views from redrawing for every row of a burst of updates.
+        std::map<RowId, uint64_t> pendingChanges;
+        bool flushScheduled = false;
+
+        void updateVirtualRoles(const Row& row, LoadState rowState, int rowNumber);
+        void queueChange(RowId id, uint64_t roles);
+        void flushChanges();
+        static QList<int> roleList(uint64_t roles) {
+            // An empty list tells the views that all roles changed
+            QList<int> result;
+            for (int role = 0; roles != ALL_ROLES && role < VIRTUAL_ROLE_BASE + VIRTUAL_ROLE_COUNT; ++role)
+                if (roles & (uint64_t(1) << role))
+                    result.append(role);
+            return result;
+        }
+        bool isBulkChange(int rows) const {
+            return rows >= BULK_CHANGE_MIN_ROWS && rows > BULK_CHANGE_FRACTION * modelIds.size();
+        }
+        void removeRows(QList<RowId> ids);
 
     public:
-        Model(AbstractTable* table, BlockchainInterface* blockchain);
+        /*!
+         * \brief Create a model of the table's rows
+         * \param filter If set, the model shows only the rows it accepts, and follows rows in and out of the model as
+         * they change
+         * \param rowIds If set, the rows the filter accepts, in order, as found by a faster means than filtering each
+         * \param irreversible If set, the model shows the rows as of the irreversible block rather than the head block
+         */
+        Model(AbstractTable* table, BlockchainInterface* blockchain, Filter filter = {},
+              const QList<RowId>* rowIds = nullptr, bool irreversible = false);
 
         int rowCount(const QModelIndex&) const override { return modelIds.size(); }
         QVariant data(const QModelIndex& index, int role) const override;
@@ -177,43 +297,87 @@ class AbstractTable : public AbstractTableInterface {
         void updateRows(QList<Row> rows);
         void markRowStale(RowId id);
         void deleteRow(RowId id);
+        //! Show rows whose changes have become irreversible as they now are, if the model shows the irreversible view
+        void settleRows(const QList<RowId>& ids);
+
+        qint64 approximateBytes() const;
     };
 
     QSet<Model*> models;
+    Model* openModel(typename Model::Filter filter = {}, const QList<RowId>* rowIds = nullptr,
+                     bool irreversible = false);
 
-    QString tableAndScope = QLatin1String("%1[%2]").arg(TableName->toLatin1(), scope.toLatin1());
+    QString tableAndScope = QLatin1String("%1[%2]").arg(*TableName, QString::number(scope));
+
+    // Bumped whenever the layout written by spill() changes
+    constexpr static quint32 SPILL_VERSION = 1;
 
 public:
     AbstractTable(BlockchainInterface* blockchain, ApiCallback callApi, uint64_t scope)
-        : AbstractTableInterface(blockchain, QString::number(scope)), callApi(callApi) {}
-    AbstractTable(BlockchainInterface* blockchain, ApiCallback callApi, QString scope)
         : AbstractTableInterface(blockchain, scope), callApi(callApi) {}
 
     QString tableName() const override { return *TableName; }
     bool hasPendingEdits() const override { return pendingEdits; }
 
-    void updateScope(QString newScope);
+    void updateScope(uint64_t newScope);
 
     QAbstractListModel* allRows() override;
+    QAbstractListModel* irreversibleRows() override;
+    QAbstractListModel* rowsWithTags(QString expression) override;
+    int countRows() const override { return rowList.size(); }
+    int countRowsWithTags(QString expression) const override;
     QJSValue findRowIf(QJSValue predicate) const override;
     QVariantMap getRow(QVariant id) const override;
     QVariantList localRows() const override;
 
+    qint64 approximateBytes() const override;
+    int modelCount() const override { return models.size(); }
+    bool hasLocalEdits() const override { return !backups.isEmpty() || !locallyAddedRows.isEmpty(); }
+    bool isLoading() const override { return requestsInFlight > 0; }
+    QByteArray spill() const override;
+    bool restore(const QByteArray& spilled) override;
+    bool replaceRows(const QByteArray& spilled) override;
+
     const Row* getRow(RowId id, LoadState* rowState = nullptr) const;
+    //! \brief Call visit(row, state) for each row in the table, in ID order
+    template<typename Visitor>
+    void forEachRow(Visitor&& visit) const {
+        for (int i = 0; i < rowList.size(); ++i)
+            visit(rowList[i], rowStates[i]);
+    }
+    /*!
+     * \brief Get the latest snapshot of the table's rows
+     *
+     * Unlike the rest of the table, this may be called from any thread. The snapshot is immutable, and remains valid
+     * for as long as the caller holds it, regardless of later changes to the table. A new snapshot is published after
+     * each batch of changes, once control returns to the table's event loop.
+     */
+    std::shared_ptr<const TableSnapshot<Row>> snapshot() const { return std::atomic_load(&publishedSnapshot); }
     template<typename Callback>
     void refreshRow(RowId id, Callback callback);
     void refreshRow(RowId id);
     void fullRefresh() override;
     void processJournal(QList<JournalEntry> entries) override;
+    void settleIrreversible(quint64 irreversibleBlock) override;
+    void rollBackFork(quint64 firstRevertedBlock) override;
 
     void draftEditRow(QVariant rowId, QVariantMap changeMap) override;
     void draftAddRow(QVariantMap fieldMap) override;
     void draftDeleteRow(QVariant rowId) override;
+    void draftEditRows(QVariantList rowIds, QVariantList changeMaps) override;
+    void draftAddRows(QVariantList fieldMaps) override;
+    void draftDeleteRows(QVariantList rowIds) override;
+    //! \brief Make draft edits adding new rows, as \ref draftAddRows does, and return the IDs of the rows added,
+    //! parallel to fieldMaps. Rows which fail validation are skipped, and have a default ID in the result.
+    QList<RowId> addDraftRows(QVariantList fieldMaps);
     void markEditsPending() override;
     void resetEdits() override;
 
 private:
     void processRowsResponse(QNetworkReply* reply, size_t loadCount);
+    // Place rows loaded from the backend, sorted by ID, into the table
+    void mergeRows(const QList<Row>& newRows);
+    std::optional<QList<Row>> unspill(const QByteArray& spilled) const;
 
     void deleteRow(RowId id);
     void markStale(RowId id);
@@ -226,40 +390,116 @@ private:
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////// AbstractTable Implementation ///////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template<class Row> AbstractTable<Row>::Model::Model(AbstractTable* table, BlockchainInterface* blockchain)
-    : QAbstractListModel(table), table(table), blockchain(blockchain) {
+template<class Row> AbstractTable<Row>::Model::Model(AbstractTable* table, BlockchainInterface* blockchain,
+                                                     Filter filter, const QList<RowId>* rowIds, bool irreversible)
+    : QAbstractListModel(table), table(table), blockchain(blockchain), filter(std::move(filter)),
+      irreversible(irreversible) {
     if (table == nullptr)
         qCritical("AbstratTableModel created with nullptr to AbstractTable!");
     if (blockchain == nullptr)
         qCritical("AbstractTableModel created with nullptr to blockchain!");
 
-    // For now, just take all rows as relevant
-    // TODO: Make models do subset ranges, like the docs say they do
-    for (int i = 0; i < table->rowList.length(); ++i) {
-        const Row& r = table->rowList[i];
+    auto addRow = [this, table](const Row& r, LoadState state, int tableIndex) {
         modelIds.append(r.getId());
         modelVirtualFields.push_back(constructVirtualFieldTuple());
-        updateVirtualRoles(r, table->rowStates[i], modelVirtualFields.back());
+        rowCaches.append(RowCache{tableIndex, {}});
+        updateVirtualRoles(r, state, modelIds.size() - 1);
 
         // If the row is stale, refresh it.
-        if (table->rowStates[i] == LoadState::Stale)
+        if (state == LoadState::Stale)
             table->refreshRow(r.getId());
     };
+    auto addTableRow = [table, &addRow](int i) { addRow(table->rowList[i], table->rowStates[i], i); };
+
+    // TODO: Make models do subset ranges, like the docs say they do
+    if (irreversible) {
+        // Walk the table's rows and the changes since the irreversible block together, taking each changed row as it
+        // was before the change, and leaving out rows which didn't exist then
+        const auto& changes = table->forkDelta.getChanges();
+        auto change = changes.begin();
+        auto addBase = [this, &addRow](const typename ForkDelta<Row>::Change& c) {
+            if (c.base.has_value() && (!this->filter || this->filter(*c.base)))
+                addRow(*c.base, c.baseState, -1);
+        };
+        for (int i = 0; i < table->rowList.length(); ++i) {
+            auto id = table->rowList[i].getId();
+            for (; change != changes.end() && change->first < id; ++change)
+                addBase(change->second);
+            if (change != changes.end() && change->first == id)
+                addBase((change++)->second);
+            else if (!this->filter || this->filter(table->rowList[i]))
+                addTableRow(i);
+        }
+        for (; change != changes.end(); ++change)
+            addBase(change->second);
+    } else if (rowIds != nullptr) {
+        // The rows are already known, and sorted like the table, so find each one after the last
+        auto pos = table->rowList.cbegin();
+        for (const RowId& id : *rowIds) {
+            pos = std::lower_bound(pos, table->rowList.cend(), id, CompareId<Row>());
+            if (pos != table->rowList.cend() && pos->getId() == id)
+                addTableRow(pos - table->rowList.cbegin());
+        }
+    } else {
+        for (int i = 0; i < table->rowList.length(); ++i)
+            if (!this->filter || this->filter(table->rowList[i]))
+                addTableRow(i);
+    }
 }
 
 template<class Row> void AbstractTable<Row>::Model::updateVirtualRoles(const Row& row, LoadState rowState,
-                                                                       VirtualFieldTuple& virtualFields) {
+                                                                       int rowNumber) {
+    // The row changed, so the cached values may be stale
+    rowCaches[rowNumber].virtualValues = {};
+
     using FieldNumbers = infra::typelist::make_sequence<infra::typelist::length<VirtualFields>()>;
+    VirtualFieldTuple& virtualFields = modelVirtualFields[rowNumber];
     infra::typelist::runtime::for_each(FieldNumbers(), [this, &row, rowState, &virtualFields] (auto FieldNumber) {
         constexpr auto fieldNumber = decltype(FieldNumber)::type::value;
         constexpr auto role = VIRTUAL_ROLE_BASE + fieldNumber;
-        auto pos = std::lower_bound(modelIds.begin(), modelIds.end(), row.getId(), CompareId<Row>());
-        auto index = createIndex(pos-modelIds.begin(), 0);
-        auto emitDataChanged = [this, index=std::move(index), role] { emit dataChanged(index, index, {role}); };
-        std::get<fieldNumber>(virtualFields).rowChanged(row, rowState, emitDataChanged);
+        // Look the row up by ID when the field changes, as its index may have changed by then
+        auto fieldChanged = [this, id=row.getId()] {
+            auto pos = std::lower_bound(modelIds.begin(), modelIds.end(), id, CompareId<Row>());
+            if (pos != modelIds.end() && *pos == id)
+                rowCaches[pos - modelIds.begin()].virtualValues[fieldNumber].valid = false;
+            queueChange(id, uint64_t(1) << role);
+        };
+        std::get<fieldNumber>(virtualFields).rowChanged(row, rowState, fieldChanged);
     });
 }
 
+template<class Row>
+auto AbstractTable<Row>::Model::fieldAccessors() -> const std::array<FieldAccessor, PHYSICAL_ROLE_COUNT>& {
+    static const auto accessors = [] {
+        std::array<FieldAccessor, PHYSICAL_ROLE_COUNT> result{};
+        std::size_t i = 0;
+        infra::typelist::runtime::for_each(RowFields(), [&result, &i](auto Reflector) {
+            using Field = typename decltype(Reflector)::type;
+            result[i++] = [](const Row& row) { return toQml(Field::get(row)); };
+        });
+        return result;
+    }();
+    return accessors;
+}
+
+template<class Row>
+auto AbstractTable<Row>::Model::virtualAccessors() -> const std::array<VirtualAccessor, VIRTUAL_ROLE_COUNT>& {
+    static const auto accessors = [] {
+        std::array<VirtualAccessor, VIRTUAL_ROLE_COUNT> result{};
+        using Indexes = infra::typelist::make_sequence<infra::typelist::length<VirtualFields>()>;
+        infra::typelist::runtime::for_each(Indexes(), [&result](auto Index) {
+            using Number = typename decltype(Index)::type;
+            result[Number::value] = [](VirtualFieldTuple& virtualFields, const Row& row, LoadState state) {
+                auto r = std::get<Number::value>(virtualFields).get(row, state);
+                return QVariant(QVariantMap{{QLatin1String("value"), QVariant::fromValue(r.first)},
+                                            {QLatin1String("status"), QVariant::fromValue(r.second)}});
+            };
+        });
+        return result;
+    }();
+    return accessors;
+}
+
 template<class Row> QVariant AbstractTable<Row>::Model::data(const QModelIndex& index, int role) const {
     // Check row index
     if (index.row() >= modelIds.length()) {
@@ -268,45 +508,60 @@ template<class Row> QVariant AbstractTable<Row>::Model::data(const QModelIndex&
         return QVariant();
     }
     RowId rowId = modelIds[index.row()];
-
-    // Get row
-    LoadState state;
-    const Row* row = table->getRow(rowId, &state);
-    if (row == nullptr) {
-        // If row is somehow not loaded, schedule it to load, and return null (or loading for loadstate)
-        table->refreshRow(rowId);
-        if (role == LOAD_STATE_ROLE)
-            return QVariant::fromValue(LoadState::Loading);
-        return QVariant();
+    RowCache& cache = rowCaches[index.row()];
+
+    // In the irreversible view, rows changed since the irreversible block show as they were before the change
+    const auto* change = irreversible? table->forkDelta.find(rowId) : nullptr;
+    const Row* rowPointer = nullptr;
+    LoadState state = LoadState::Loading;
+    if (change != nullptr && change->base.has_value()) {
+        rowPointer = &*change->base;
+        state = change->baseState;
+    } else {
+        // Get row, looking where it was last time before searching the table for it
+        const QList<Row>& rowList = table->rowList;
+        if (cache.tableIndex < 0 || cache.tableIndex >= rowList.size() ||
+                rowList[cache.tableIndex].getId() != rowId) {
+            auto pos = std::lower_bound(rowList.begin(), rowList.end(), rowId, CompareId<Row>());
+            cache.tableIndex = (pos != rowList.end() && pos->getId() == rowId)? int(pos - rowList.begin()) : -1;
+        }
+        if (cache.tableIndex < 0) {
+            // If row is somehow not loaded, schedule it to load, and return null (or loading for loadstate)
+            table->refreshRow(rowId);
+            if (role == LOAD_STATE_ROLE)
+                return QVariant::fromValue(LoadState::Loading);
+            return QVariant();
+        }
+        rowPointer = &rowList[cache.tableIndex];
+        state = table->rowStates[cache.tableIndex];
     }
+    const Row& row = *rowPointer;
+
     // Check if role is load state role
     if (role == LOAD_STATE_ROLE)
         return QVariant::fromValue(state);
     // Check role number
-    QVariant result;
-    if (role < (PHYSICAL_ROLE_BASE + PHYSICAL_ROLE_COUNT)) {
+    if (role >= PHYSICAL_ROLE_BASE && role < (PHYSICAL_ROLE_BASE + PHYSICAL_ROLE_COUNT)) {
         // Get field from row
-        infra::typelist::runtime::dispatch(RowFields(), role - PHYSICAL_ROLE_BASE, [row, &result](auto Reflector) {
-            result = QVariant::fromValue(decltype(Reflector)::type::get(*row));
-        });
-    } else if (role < (VIRTUAL_ROLE_BASE + VIRTUAL_ROLE_COUNT)) {
-        // Get virtual field
+        return fieldAccessors()[role - PHYSICAL_ROLE_BASE](row);
+    } else if (role >= VIRTUAL_ROLE_BASE && role < (VIRTUAL_ROLE_BASE + VIRTUAL_ROLE_COUNT)) {
+        // Get virtual field, calculating it only if it changed since last time
         if constexpr (VIRTUAL_ROLE_COUNT > 0) {
-            using Indexes = infra::typelist::make_sequence<infra::typelist::length<VirtualFields>()>;
-            VirtualFieldTuple& virtualFields = modelVirtualFields[index.row()];
-            infra::typelist::runtime::dispatch(Indexes(), role-VIRTUAL_ROLE_BASE,
-                                               [&virtualFields, this, row, state, &result](auto Index) {
-                auto r = std::get<decltype(Index)::type::value>(virtualFields).get(*row, state);
-                result = QVariantMap{{QLatin1String("value"), QVariant::fromValue(r.first)},
-                                     {QLatin1String("status"), QVariant::fromValue(r.second)}};
-            });
+            CachedVirtualValue& cached = cache.virtualValues[role - VIRTUAL_ROLE_BASE];
+            if (!cached.valid || cached.state != state) {
+                cached.value = virtualAccessors()[role - VIRTUAL_ROLE_BASE](modelVirtualFields[index.row()], row,
+                                                                            state);
+                cached.state = state;
+                cached.valid = true;
+            }
+            return cached.value;
         }
     } else {
         qWarning() << "Asked to retrieve role" << role << "from" << table->tableAndScope
                    << "table, but that role is not defined!";
     }
 
-    return result;
+    return QVariant();
 }
 
 template<class Row> QHash<int, QByteArray> AbstractTable<Row>::Model::roleNames() const {
@@ -321,18 +576,120 @@ template<class Row> QHash<int, QByteArray> AbstractTable<Row>::Model::roleNames(
     return result;
 }
 
+template<class Row> void AbstractTable<Row>::Model::queueChange(RowId id, uint64_t roles) {
+    pendingChanges[id] |= roles;
+    if (!flushScheduled) {
+        flushScheduled = true;
+        connect(AbstractTableInterface::frameTimer(), &FpsTimer::triggered, this, [this] { flushChanges(); },
+                Qt::SingleShotConnection);
+    }
+}
+
+template<class Row> void AbstractTable<Row>::Model::flushChanges() {
+    flushScheduled = false;
+    if (pendingChanges.empty())
+        return;
+    auto changes = std::move(pendingChanges);
+    pendingChanges.clear();
+    // The changed rows may all have left the model since
+    if (modelIds.isEmpty())
+        return;
+
+    // Too many changes to bother with the details: announce a change to everything
+    if (isBulkChange(int(changes.size()))) {
+        uint64_t roles = 0;
+        for (const auto& change : changes)
+            roles |= change.second;
+        emit dataChanged(createIndex(0, 0), createIndex(modelIds.size() - 1, 0), roleList(roles));
+        return;
+    }
+
+    // Merge the changed rows into runs of adjacent rows, combining their roles, and announce each run
+    int first = -1, last = -1;
+    uint64_t roles = 0;
+    auto emitRun = [this, &first, &last, &roles] {
+        if (first == -1)
+            return;
+        emit dataChanged(createIndex(first, 0), createIndex(last, 0), roleList(roles));
+    };
+    // Changes are sorted by ID, as modelIds is, so each search can begin where the last left off
+    auto pos = modelIds.begin();
+    for (const auto& change : changes) {
+        pos = std::lower_bound(pos, modelIds.end(), change.first, CompareId<Row>());
+        if (pos == modelIds.end())
+            break;
+        if (*pos != change.first)
+            // Row was removed since the change
+            continue;
+
+        int row = pos - modelIds.begin();
+        if (row == last + 1 && first != -1) {
+            last = row;
+            roles |= change.second;
+        } else {
+            emitRun();
+            first = last = row;
+            roles = change.second;
+        }
+    }
+    emitRun();
+}
+
 template<class Row> void AbstractTable<Row>::Model::updateRows(QList<Row> rows) {
+    if (irreversible && !table->forkDelta.isEmpty()) {
+        // Rows changed since the irreversible block keep showing as they were, and rows added since don't show
+        QList<Row> settled;
+        for (Row& r : rows) {
+            const auto* change = table->forkDelta.find(r.getId());
+            if (change == nullptr)
+                settled.append(std::move(r));
+            else if (change->base.has_value())
+                settled.append(*change->base);
+        }
+        rows = std::move(settled);
+    }
+    if (filter) {
+        // Rows the filter rejects leave the model if they were in it, as their changes may have taken them out
+        QList<Row> accepted;
+        QList<RowId> rejected;
+        for (Row& r : rows) {
+            if (filter(r))
+                accepted.append(std::move(r));
+            else
+                rejected.append(r.getId());
+        }
+        rows = std::move(accepted);
+        if (!rejected.isEmpty())
+            removeRows(std::move(rejected));
+    }
     if (rows.isEmpty())
         return;
 
     auto pos = std::lower_bound(modelIds.begin(), modelIds.end(), rows.first().getId(), CompareId<Row>());
-    if (pos == modelIds.end()) {
+    if (pos != modelIds.end() && isBulkChange(rows.size())) {
+        // Many rows throughout the model: rather than announce each insertion, reset the whole model
+        beginResetModel();
+        for (const Row& r : rows) {
+            pos = std::lower_bound(pos, modelIds.end(), r.getId(), CompareId<Row>());
+            auto rowNumber = pos - modelIds.begin();
+            if (pos == modelIds.end() || *pos != r.getId()) {
+                pos = modelIds.insert(pos, r.getId());
+                modelVirtualFields.insert(rowNumber, constructVirtualFieldTuple());
+                rowCaches.insert(rowNumber, RowCache());
+            }
+            updateVirtualRoles(r, LoadState::Loaded, rowNumber);
+        }
+        // A reset announces all changes
+        pendingChanges.clear();
+        endResetModel();
+    } else if (pos == modelIds.end()) {
         auto firstRowNumber = modelIds.size();
         beginInsertRows(QModelIndex(), firstRowNumber, firstRowNumber + rows.length()-1);
         for (const Row& r : rows) {
             modelIds.append(r.getId());
             modelVirtualFields.append(constructVirtualFieldTuple());
-            updateVirtualRoles(r, LoadState::Loaded, modelVirtualFields.last());
+            rowCaches.append(RowCache());
+            updateVirtualRoles(r, LoadState::Loaded, modelIds.size() - 1);
         }
         endInsertRows();
     } else {
@@ -341,15 +698,22 @@ template<class Row> void AbstractTable<Row>::Model::updateRows(QList<Row> rows)
             // New row or update?
             if (pos != modelIds.end() && *pos == rows.first().getId()) {
                 // Update.
-                updateVirtualRoles(rows.takeFirst(), LoadState::Loaded, modelVirtualFields[rowNumber]);
-                emit dataChanged(createIndex(rowNumber, 0), createIndex(rowNumber, 0));
+                queueChange(rows.first().getId(), ALL_ROLES);
+                updateVirtualRoles(rows.takeFirst(), LoadState::Loaded, rowNumber);
             } else {
-                // New row.
-                beginInsertRows(QModelIndex(), rowNumber, rowNumber);
-                pos = modelIds.insert(pos, rows.first().getId());
-                modelVirtualFields.insert(rowNumber, constructVirtualFieldTuple());
-                updateVirtualRoles(rows.takeFirst(), LoadState::Loaded, modelVirtualFields[rowNumber]);
+                // New rows. All those before the next row already in the model are adjacent, so insert them together
+                int count = 1;
+                while (count < rows.size() && (pos == modelIds.end() || rows[count].getId() < *pos))
+                    ++count;
+                beginInsertRows(QModelIndex(), rowNumber, rowNumber + count - 1);
+                for (int i = 0; i < count; ++i) {
+                    modelIds.insert(rowNumber + i, rows.first().getId());
+                    modelVirtualFields.insert(rowNumber + i, constructVirtualFieldTuple());
+                    rowCaches.insert(rowNumber + i, RowCache());
+                    updateVirtualRoles(rows.takeFirst(), LoadState::Loaded, rowNumber + i);
+                }
                 endInsertRows();
+                pos = modelIds.begin() + rowNumber + count;
             }
             if (!rows.isEmpty())
                 pos = std::lower_bound(pos, modelIds.end(), rows.first().getId(), CompareId<Row>());
@@ -359,26 +723,85 @@ template<class Row> void AbstractTable<Row>::Model::updateRows(QList<Row> rows)
 
 template<class Row> void AbstractTable<Row>::Model::markRowStale(RowId id) {
     auto pos = std::lower_bound(modelIds.begin(), modelIds.end(), id, CompareId<Row>());
-    if (pos != modelIds.end() && *pos == id) {
-        auto row = pos - modelIds.begin();
-        emit dataChanged(createIndex(row, 0), createIndex(row, 0), {LOAD_STATE_ROLE});
-    }
+    if (pos != modelIds.end() && *pos == id)
+        queueChange(id, uint64_t(1) << LOAD_STATE_ROLE);
 
     // For now, models load all rows automatically, so just reload it. In the future, we might not bother all the time
     table->refreshRow(id);
 }
 
 template<class Row> void AbstractTable<Row>::Model::deleteRow(RowId id) {
-    auto pos = std::lower_bound(modelIds.begin(), modelIds.end(), id, CompareId<Row>());
-    if (pos != modelIds.end() && *pos == id) {
-        auto row = pos - modelIds.begin();
-        beginRemoveRows(QModelIndex(), row, row);
-        modelIds.erase(pos);
-        modelVirtualFields.removeAt(row);
+    // A row deleted since the irreversible block still shows in the irreversible view until the deletion settles
+    if (irreversible) {
+        const auto* change = table->forkDelta.find(id);
+        if (change != nullptr && change->base.has_value())
+            return;
+    }
+    removeRows({id});
+}
+
+template<class Row> void AbstractTable<Row>::Model::settleRows(const QList<RowId>& ids) {
+    if (!irreversible)
+        return;
+
+    QList<Row> present;
+    QList<RowId> deleted;
+    for (const auto& id : ids) {
+        if (const Row* row = table->getRow(id))
+            present.append(*row);
+        else
+            deleted.append(id);
+    }
+    if (!deleted.isEmpty())
+        removeRows(std::move(deleted));
+    if (!present.isEmpty())
+        updateRows(std::move(present));
+}
+
+template<class Row> void AbstractTable<Row>::Model::removeRows(QList<RowId> ids) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    QList<int> rowNumbers;
+    auto pos = modelIds.begin();
+    for (const auto& id : ids) {
+        pos = std::lower_bound(pos, modelIds.end(), id, CompareId<Row>());
+        if (pos == modelIds.end())
+            break;
+        if (*pos == id)
+            rowNumbers.append(pos - modelIds.begin());
+    }
+
+    // Remove runs of adjacent rows together, from the last run back so the row numbers of the others hold
+    for (int end = rowNumbers.size(); end > 0;) {
+        int start = end - 1;
+        while (start > 0 && rowNumbers[start - 1] == rowNumbers[start] - 1)
+            --start;
+        int first = rowNumbers[start], count = end - start;
+        beginRemoveRows(QModelIndex(), first, first + count - 1);
+        for (int row = first; row < first + count; ++row)
+            pendingChanges.erase(modelIds[row]);
+        modelIds.remove(first, count);
+        modelVirtualFields.remove(first, count);
+        rowCaches.remove(first, count);
         endRemoveRows();
+        end = start;
     }
 }
 
+template<class Row> qint64 AbstractTable<Row>::Model::approximateBytes() const {
+    constexpr qint64 ROW_BYTES = sizeof(RowId) + sizeof(VirtualFieldTuple) + sizeof(RowCache);
+    qint64 total = sizeof(Model) + modelIds.size() * ROW_BYTES
+            + qint64(pendingChanges.size()) * (sizeof(RowId) + sizeof(uint64_t) + MAP_NODE_BYTES);
+    // The virtual fields' children are typically models of other tables, which those tables account for, so only
+    // the bookkeeping for them is counted here
+    if constexpr (VIRTUAL_ROLE_COUNT > 0)
+        for (const auto& fields : modelVirtualFields)
+            std::apply([&total](const auto&... field) {
+                total += ((field.childCount() * (sizeof(QMetaObject::Connection) + MAP_NODE_BYTES)) + ...);
+            }, fields);
+    return total;
+}
+
 template<class Row> bool AbstractTable<Row>::rowIsLoading(RowId id, bool markAsLoading) {
     // The duration a loading request may be waiting before it may be dropped and reloaded
     constexpr static qint64 MAX_LOADING_SECONDS_BEFORE_DROPPED = 7;
@@ -395,23 +818,67 @@ template<class Row> bool AbstractTable<Row>::rowIsLoading(RowId id, bool markAsL
 }
 
 template<class Row>
-void AbstractTable<Row>::updateScope(QString newScope) {
+void AbstractTable<Row>::updateScope(uint64_t newScope) {
     if (newScope != scope) {
-        tableAndScope = tableAndScope.left(tableAndScope.indexOf('[')) + "[" + newScope + "]";
-        emit scopeChanged(scope = newScope);
+        scope = newScope;
+        tableAndScope = QLatin1String("%1[%2]").arg(*TableName, QString::number(scope));
+        emit scopeChanged(tableScope());
         fullRefresh();
     }
 }
 
-template<class Row> QAbstractListModel* AbstractTable<Row>::allRows() {
+template<class Row>
+typename AbstractTable<Row>::Model* AbstractTable<Row>::openModel(typename Model::Filter filter,
+                                                                  const QList<RowId>* rowIds, bool irreversible) {
     if (models.empty())
         fullRefresh();
-    Model* model = new Model(this, blockchain);
+    Model* model = new Model(this, blockchain, std::move(filter), rowIds, irreversible);
     models.insert(model);
     connect(model, &QObject::destroyed, this, [this, model] { models.remove(model); });
     return model;
 }
 
+template<class Row> QAbstractListModel* AbstractTable<Row>::allRows() {
+    return openModel();
+}
+
+template<class Row> QAbstractListModel* AbstractTable<Row>::irreversibleRows() {
+    return openModel({}, nullptr, true);
+}
+
+template<class Row> QAbstractListModel* AbstractTable<Row>::rowsWithTags(QString expression) {
+    if constexpr (!RowTags<Row>::defined) {
+        qWarning() << tableAndScope << "Cannot filter by tags: rows have no tags";
+        return nullptr;
+    } else {
+        QString error;
+        auto parsed = TagExpression::parse(expression, &error);
+        if (!parsed.isValid()) {
+            qWarning() << tableAndScope << "Invalid tag expression" << expression << "--" << error;
+            return nullptr;
+        }
+
+        // Populate the model from the index, then keep it current by checking each changed row's tags
+        auto ids = tagIndex.find(parsed);
+        return openModel([parsed](const Row& row) { return parsed.matches(RowTags<Row>::get(row)); }, &ids);
+    }
+}
+
+template<class Row> int AbstractTable<Row>::countRowsWithTags(QString expression) const {
+    if constexpr (!RowTags<Row>::defined) {
+        qWarning() << tableAndScope << "Cannot count by tags: rows have no tags";
+        return -1;
+    } else {
+        QString error;
+        auto parsed = TagExpression::parse(expression, &error);
+        if (!parsed.isValid()) {
+            qWarning() << tableAndScope << "Invalid tag expression" << expression << "--" << error;
+            return -1;
+        }
+        return int(tagIndex.count(parsed));
+    }
+}
+
 template<class Row> QJSValue AbstractTable<Row>::findRowIf(QJSValue predicate) const {
     auto* engine = qjsEngine(this);
     if (rowList.isEmpty() || !predicate.isCallable() || engine == nullptr)
@@ -430,7 +897,7 @@ template<class Row> QJSValue AbstractTable<Row>::findRowIf(QJSValue predicate) c
 
 template<class Row> QVariantMap AbstractTable<Row>::getRow(QVariant id) const {
     LoadState state;
-    const auto* row = getRow(id.value<RowId>(), &state);
+    const auto* row = getRow(fromQml<RowId>(id), &state);
     if (row == nullptr)
         return {};
     auto variantRow = Convert<Row>::toVariantMap(*row);
@@ -449,6 +916,117 @@ template<class Row> QVariantList AbstractTable<Row>::localRows() const {
     return result;
 }
 
+template<class Row> qint64 AbstractTable<Row>::approximateBytes() const {
+    qint64 total = sizeof(*this) + approximateRowListBytes(rowList) + rowStates.capacity() * sizeof(LoadState)
+            + approximateRowListBytes(backups.getRows())
+            + qint64(loadingRows.size()) * (sizeof(RowId) + sizeof(qint64) + MAP_NODE_BYTES);
+    if constexpr (RowTags<Row>::defined)
+        total += tagIndex.approximateBytes();
+    for (const auto& change : forkDelta.getChanges())
+        total += sizeof(change) + MAP_NODE_BYTES + (change.second.base? approximateRowBytes(*change.second.base) : 0);
+    for (const Model* model : models)
+        total += model->approximateBytes();
+    return total;
+}
+
+template<class Row> QByteArray AbstractTable<Row>::spill() const {
+    // Rows still loading or stale would be restored as though they were current, so only spill fully loaded tables
+    if (rowList.isEmpty() || std::any_of(rowStates.begin(), rowStates.end(),
+                                         [](LoadState state) { return state != LoadState::Loaded; }))
+        return {};
+
+    QByteArray spilled;
+    QDataStream stream(&spilled, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << SPILL_VERSION << qint64(rowList.size());
+    for (const Row& row : rowList)
+        infra::typelist::runtime::for_each(RowFields(), [&stream, &row](auto Descriptor) {
+            using descriptor = typename decltype(Descriptor)::type;
+            writeField(stream, descriptor::get(row));
+        });
+    return qCompress(spilled);
+}
+
+template<class Row> std::optional<QList<Row>> AbstractTable<Row>::unspill(const QByteArray& spilled) const {
+    auto uncompressed = qUncompress(spilled);
+    QDataStream stream(uncompressed);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 version = 0;
+    qint64 count = 0;
+    stream >> version >> count;
+    if (version != SPILL_VERSION || count < 0) {
+        qWarning() << tableAndScope << "Spilled rows have unrecognized format" << version;
+        return {};
+    }
+
+    QList<Row> rows;
+    rows.reserve(count);
+    for (qint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        Row row;
+        infra::typelist::runtime::for_each(RowFields(), [&stream, &row](auto Descriptor) {
+            using descriptor = typename decltype(Descriptor)::type;
+            readField(stream, descriptor::get(row));
+        });
+        rows.append(std::move(row));
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << tableAndScope << "Spilled rows are truncated or corrupt";
+        return {};
+    }
+    return rows;
+}
+
+template<class Row> bool AbstractTable<Row>::restore(const QByteArray& spilled) {
+    if (!rowList.isEmpty()) {
+        qWarning() << tableAndScope << "Not restoring spilled rows into a table which already has rows";
+        return false;
+    }
+    auto rows = unspill(spilled);
+    if (!rows.has_value())
+        return false;
+
+    qInfo() << tableAndScope << "Restored" << rows->size() << "spilled rows";
+    rowList = std::move(*rows);
+    rowStates.fill(LoadState::Loaded, rowList.size());
+    for (const Row& row : rowList)
+        indexRow(row);
+    RowOps::RowsAdded(rowList, this);
+    tableChanged();
+    return true;
+}
+
+template<class Row> bool AbstractTable<Row>::replaceRows(const QByteArray& spilled) {
+    auto rows = unspill(spilled);
+    if (!rows.has_value())
+        return false;
+
+    // Delete the rows the new contents lack, except local additions, which the backend hasn't seen yet. Keep the
+    // rows which are unchanged out of the merge, so models hear only of real changes.
+    QList<RowId> removed;
+    QList<Row> changed;
+    auto next = rows->begin();
+    for (int i = 0; i < rowList.size(); ++i) {
+        const Row& row = rowList[i];
+        for (; next != rows->end() && next->getId() < row.getId(); ++next)
+            changed.append(std::move(*next));
+        if (next != rows->end() && next->getId() == row.getId()) {
+            if (rowStates[i] != LoadState::Loaded || *next != row)
+                changed.append(std::move(*next));
+            ++next;
+        } else if (rowStates[i] != LoadState::DraftAdd && rowStates[i] != LoadState::PendingAdd) {
+            removed.append(row.getId());
+        }
+    }
+    for (; next != rows->end(); ++next)
+        changed.append(std::move(*next));
+
+    for (const auto& id : removed)
+        deleteRow(id);
+    if (!changed.isEmpty())
+        mergeRows(changed);
+    return true;
+}
+
 template<class Row> const Row* AbstractTable<Row>::getRow(RowId id, LoadState* rowState) const {
     auto pos = std::lower_bound(rowList.begin(), rowList.end(), id, CompareId<Row>());
     if (pos != rowList.end() && pos->getId() == id) {
@@ -464,14 +1042,8 @@ template<class Row> template<class Callback> void AbstractTable<Row>::refreshRow
         // Already loading; don't load it again
         return;
 
-    QString lowerBound;
-    if constexpr (std::is_same_v<RowId, QString>)
-        lowerBound = '"' + id + '"';
-    else
-        lowerBound = QString::number(id);
-
-    auto* reply = callApi(Strings::GetTableRows, getTableJson(*TableName, scope, lowerBound, 1));
-    connect(reply, &QNetworkReply::finished, [this, reply, id, cb=std::move(callback)] {
+    auto* reply = requestRows(getTableJson(*TableName, QString::number(scope), tableKey(id), 1, false, rowFormat));
+    connect(reply, &QNetworkReply::finished, this, [this, reply, id, cb=std::move(callback)] {
         loadingRows.remove(id);
         processRowsResponse(reply, 1);
         cb(getRow(id));
@@ -483,33 +1055,56 @@ template<class Row> void AbstractTable<Row>::refreshRow(RowId id) {
         // Already loading; don't load it again
         return;
 
-    QString lowerBound;
-    if constexpr (std::is_same_v<RowId, QString>)
-        lowerBound = '"' + id + '"';
-    else
-        lowerBound = QString::number(id);
-
-    auto* reply = callApi(Strings::GetTableRows, getTableJson(*TableName, scope, lowerBound, 1));
-    connect(reply, &QNetworkReply::finished, [this, id, reply] {
+    auto* reply = requestRows(getTableJson(*TableName, QString::number(scope), tableKey(id), 1, false, rowFormat));
+    connect(reply, &QNetworkReply::finished, this, [this, id, reply] {
         loadingRows.erase(id);
         processRowsResponse(reply, 1);
     });
 }
 
+template<class Row> QNetworkReply* AbstractTable<Row>::requestRows(QByteArray json) {
+    auto* reply = callApi(Strings::GetTableRows, std::move(json));
+    ++requestsInFlight;
+    // The table may be evicted while the request is in flight, so make it the context of all connections to replies.
+    // Once the last request finishes, publish a snapshot even if no rows changed, so readers see the load is done.
+    connect(reply, &QNetworkReply::finished, this, [this] {
+        if (--requestsInFlight == 0)
+            tableChanged();
+    });
+    return reply;
+}
+
 template<class Row> void AbstractTable<Row>::fullRefresh() {
-    auto* reply = callApi(Strings::GetTableRows, getTableJson(*TableName, scope));
-    connect(reply, &QNetworkReply::finished, [this, reply] { processRowsResponse(reply, 0); });
+    auto* reply = requestRows(getTableJson(*TableName, QString::number(scope), rowFormat));
+    connect(reply, &QNetworkReply::finished, this, [this, reply] { processRowsResponse(reply, 0); });
 }
 
 template<class Row> void AbstractTable<Row>::processJournal(QList<JournalEntry> entries) {
-    std::for_each(entries.begin(), entries.end(), [this](const JournalEntry& entry) {
-        if (entry.table == *TableName && QString::number(entry.scope) == scope) {
-            auto key = [&entry] {
-                if constexpr (std::is_same_v<RowId, QString>)
-                    return eosio::name_to_string(entry.key);
-                else
-                    return entry.key;
-            };
+    QList<Row> replayedRows;
+    // Entries normally arrive already routed to this table by JournalRouter, but check anyway; it's cheap
+    std::for_each(entries.begin(), entries.end(), [this, &replayedRows](const JournalEntry& entry) {
+        if (entry.scope == scope && entry.table == *TableName) {
+            auto key = [&entry] { return rowIdFromKey<RowId>(entry.key); };
+            if (entry.replayed) {
+                // Rolling back the fork reloaded the row, so it already shows this change; only note the change as
+                // reversible again, against the row as it was before the reverted change
+                auto reverted = revertedChanges.find(key());
+                if (reverted != revertedChanges.end()) {
+                    if (entry.blockNumber > irreversibleBlock) {
+                        if (!forkDelta.contains(key()))
+                            forkDelta.record(key(), entry.blockNumber, reverted->second.base,
+                                             reverted->second.baseState);
+                        else
+                            forkDelta.record(key(), entry.blockNumber, {}, LoadState::Loaded);
+                        deltaChanged = true;
+                    }
+                    if (const Row* row = getRow(key()); row != nullptr)
+                        replayedRows.append(*row);
+                    return;
+                }
+            }
+            if (entry.blockNumber > irreversibleBlock)
+                recordSpeculative(key(), entry.blockNumber);
             if (entry.type == JournalEntry::DeleteRow) {
                 qInfo() << tableAndScope << "deleting row ID" << entry.key << "as per journal";
                 deleteRow(key());
@@ -522,146 +1117,345 @@ template<class Row> void AbstractTable<Row>::processJournal(QList<JournalEntry>
             }
         }
     });
+
+    if (!replayedRows.isEmpty()) {
+        tableChanged();
+        // The irreversible view shows the replayed rows as they were before their changes again
+        std::for_each(models.begin(), models.end(), [&replayedRows](Model* model) { model->updateRows(replayedRows); });
+    }
 }
 
-template<class Row> void AbstractTable<Row>::draftEditRow(QVariant rowId, QVariantMap changeMap) {
-    // No new edits allowed when edits are pending
-    if (pendingEdits)
+template<class Row> void AbstractTable<Row>::settleIrreversible(quint64 irreversibleBlock) {
+    if (irreversibleBlock <= this->irreversibleBlock)
+        return;
+    this->irreversibleBlock = irreversibleBlock;
+    // Changes rolled back in blocks now irreversible won't be replayed any more
+    for (auto itr = revertedChanges.begin(); itr != revertedChanges.end();)
+        itr = itr->second.block <= irreversibleBlock? revertedChanges.erase(itr) : std::next(itr);
+    if (forkDelta.isEmpty())
         return;
 
-    // Find the row to edit
-    auto id = rowId.value<RowId>();
-    auto rowItr = std::lower_bound(rowList.begin(), rowList.end(), id, CompareId<Row>());
-    if (rowItr == rowList.end() || rowItr->getId() != id) {
-        qCritical() << tableAndScope << "Asked to make draft edits to row ID" << id << "but row not found!";
+    auto settled = forkDelta.settle(irreversibleBlock);
+    if (settled.isEmpty())
         return;
+    deltaChanged = true;
+    tableChanged();
+    std::for_each(models.begin(), models.end(), [&settled](Model* model) { model->settleRows(settled); });
+}
+
+template<class Row> void AbstractTable<Row>::rollBackFork(quint64 firstRevertedBlock) {
+    auto reverted = forkDelta.takeReverted(firstRevertedBlock);
+    revertedChanges.clear();
+    if (reverted.empty())
+        return;
+    qInfo() << tableAndScope << "Rolling back" << reverted.size() << "rows changed in blocks reverted by a fork";
+    deltaChanged = true;
+    tableChanged();
+
+    QList<Row> restored;
+    for (auto& [id, change] : reverted) {
+        LoadState state = LoadState::Loading;
+        const Row* row = getRow(id, &state);
+        if (row != nullptr && state != LoadState::Loaded && state != LoadState::Stale && state != LoadState::Loading) {
+            // The row has local edits; treat it as changed in the backend, which reloads it and settles the edits
+            markStale(id);
+            continue;
+        }
+
+        // Keep the change, so if the journal replays it from the new chain, it can be noted as reversible again
+        revertedChanges.insert({id, change});
+        if (!change.base.has_value()) {
+            if (row != nullptr)
+                deleteRow(id);
+        } else {
+            putRow(*change.base, change.baseState);
+            restored.append(std::move(*change.base));
+        }
+        // Whatever the blocks that replaced the reverted ones did to the row, load it as it is now
+        refreshRow(id);
     }
-    auto rowState = rowStates[rowItr - rowList.begin()];
-    if (rowState == LoadState::DraftDelete) {
-        qWarning() << tableAndScope << "Asked to make draft edit to row ID" << id << "but that row is draft deleted";
+    if (!restored.isEmpty())
+        std::for_each(models.begin(), models.end(), [&restored](Model* model) { model->updateRows(restored); });
+}
+
+template<class Row> void AbstractTable<Row>::recordSpeculative(RowId id, uint64_t block) {
+    if (forkDelta.contains(id)) {
+        forkDelta.record(id, block, {}, LoadState::Loaded);
+        deltaChanged = true;
         return;
     }
-    auto oldRow = std::move(*rowItr);
 
-    // Check that the row ID is unchanged
-    QStringList unusedKeys;
-    auto scratchRow = Convert<Row>::fromVariantMap(changeMap, oldRow, &unusedKeys);
-    if (!unusedKeys.isEmpty())
-        qWarning() << tableAndScope << "Asked to make draft edits to row, but edits contained unknown fields:"
-                   << unusedKeys;
-    if (scratchRow.getId() != oldRow.getId()) {
-        qWarning() << tableAndScope << "Asked to make draft edits to row ID" << id << "which change the row's ID";
+    // The row as the backend last had it: from the backup if it has local edits, or else as it is now
+    std::optional<Row> base;
+    LoadState baseState = LoadState::Loaded;
+    LoadState state = LoadState::Loading;
+    const Row* row = getRow(id, &state);
+    if (auto backup = backups.get(id); backup.has_value()) {
+        if (std::get<1>(*backup) != LoadState::DraftAdd) {
+            base = std::get<0>(*backup);
+            baseState = std::get<1>(*backup);
+        }
+    } else if (row != nullptr && state != LoadState::Loading && state != LoadState::DraftAdd &&
+               state != LoadState::PendingAdd) {
+        base = *row;
+        baseState = state;
+    }
+    forkDelta.record(id, block, std::move(base), baseState);
+    deltaChanged = true;
+}
+
+template<class Row> void AbstractTable<Row>::putRow(const Row& row, LoadState state) {
+    auto pos = std::lower_bound(rowList.begin(), rowList.end(), row.getId(), CompareId<Row>());
+    auto rowNumber = pos - rowList.begin();
+    if (pos != rowList.end() && pos->getId() == row.getId()) {
+        auto oldRow = std::move(*pos);
+        *pos = row;
+        rowStates[rowNumber] = state;
+        RowOps::RowUpdated(oldRow, *pos, this);
+    } else {
+        pos = rowList.insert(pos, row);
+        rowStates.insert(rowNumber, state);
+        RowOps::RowsAdded({row}, this);
+    }
+    indexRow(*pos);
+    tableChanged();
+}
+
+template<class Row> void AbstractTable<Row>::draftEditRow(QVariant rowId, QVariantMap changeMap) {
+    draftEditRows({rowId}, {changeMap});
+}
+
+template<class Row> void AbstractTable<Row>::draftEditRows(QVariantList rowIds, QVariantList changeMaps) {
+    // No new edits allowed when edits are pending
+    if (pendingEdits)
+        return;
+    if (rowIds.size() != changeMaps.size()) {
+        qCritical() << tableAndScope << "Asked to make draft edits to" << rowIds.size() << "rows, but given"
+                    << changeMaps.size() << "sets of changes!";
         return;
     }
 
-    if (rowState != LoadState::DraftAdd && rowState != LoadState::DraftEdit) {
-        auto& state = rowStates[rowItr-rowList.begin()];
-        // Save a backup of the unedited row, if one isn't already saved, unless the row was already a draft
-        backups.save(oldRow, state);
-        // Update the row state to draft, but again, not if the row was a draft already
-        state = LoadState::DraftEdit;
-    } else if (rowState == LoadState::DraftAdd) {
-        // When editing a draft added row, update any values in the locally added rows to the edited values.
-        // This is to ensure that we still match the updated row when we get it from the backend.
-        auto itr = std::find_if(locallyAddedRows.begin(), locallyAddedRows.end(), [rowId](QVariantMap row) {
-                return row[Strings::DraftId] == rowId;
-        });
-        if (itr != locallyAddedRows.end()) {
-            auto keys = changeMap.keys();
-            while (!keys.empty()) {
-                auto pos = itr->find(keys.first());
-                if (pos != itr->end())
-                    *pos = changeMap[keys.takeFirst()];
-            }
+    // Backups are saved together at the end, rather than inserted one at a time
+    QList<Row> backupRows;
+    QList<LoadState> backupStates;
+    std::set<RowId> editedIds;
+    for (int i = 0; i < rowIds.size(); ++i) {
+        QVariantMap changeMap = changeMaps[i].toMap();
+
+        // Find the row to edit
+        auto id = fromQml<RowId>(rowIds[i]);
+        auto rowItr = std::lower_bound(rowList.begin(), rowList.end(), id, CompareId<Row>());
+        if (rowItr == rowList.end() || rowItr->getId() != id) {
+            qCritical() << tableAndScope << "Asked to make draft edits to row ID" << id << "but row not found!";
+            continue;
         }
+        auto& state = rowStates[rowItr - rowList.begin()];
+        if (state == LoadState::DraftDelete) {
+            qWarning() << tableAndScope << "Asked to make draft edit to row ID" << id
+                       << "but that row is draft deleted";
+            continue;
+        }
+
+        // Check that the row ID is unchanged
+        QStringList unusedKeys;
+        auto scratchRow = Convert<Row>::fromVariantMap(changeMap, *rowItr, &unusedKeys);
+        if (!unusedKeys.isEmpty())
+            qWarning() << tableAndScope << "Asked to make draft edits to row, but edits contained unknown fields:"
+                       << unusedKeys;
+        if (scratchRow.getId() != id) {
+            qWarning() << tableAndScope << "Asked to make draft edits to row ID" << id << "which change the row's ID";
+            continue;
+        }
+        auto oldRow = std::move(*rowItr);
+
+        if (state != LoadState::DraftAdd && state != LoadState::DraftEdit) {
+            // Save a backup of the unedited row, unless the row was already a draft
+            backupRows.append(oldRow);
+            backupStates.append(state);
+            // Update the row state to draft, but again, not if the row was a draft already
+            state = LoadState::DraftEdit;
+        } else if (state == LoadState::DraftAdd) {
+            // When editing a draft added row, update any values in the locally added rows to the edited values.
+            // This is to ensure that we still match the updated row when we get it from the backend.
+            locallyAddedRows.update(id, changeMap);
+        }
+
+        // Apply the edits to the table
+        *rowItr = std::move(scratchRow);
+        indexRow(*rowItr);
+        RowOps::RowDraftEdited(oldRow, *rowItr, this);
+        editedIds.insert(id);
     }
+    backups.saveAll(backupRows, backupStates);
 
-    // Apply the edits to the table
-    *rowItr = std::move(scratchRow);
-    RowOps::RowDraftEdited(oldRow, *rowItr, this);
+    tableChanged();
 
-    // Notify the models
-    QList<Row> updates(rowItr, rowItr+1);
-    std::for_each(models.begin(), models.end(), [&updates](Model* model) { model->updateRows(updates); });
+    // Notify the models, in ID order
+    QList<Row> updates;
+    updates.reserve(editedIds.size());
+    for (const auto& id : editedIds)
+        updates.append(*getRow(id));
+    if (!updates.isEmpty())
+        std::for_each(models.begin(), models.end(), [&updates](Model* model) { model->updateRows(updates); });
 }
 
 template<class Row> void AbstractTable<Row>::draftAddRow(QVariantMap fieldMap) {
+    draftAddRows({fieldMap});
+}
+
+template<class Row> void AbstractTable<Row>::draftAddRows(QVariantList fieldMaps) {
+    addDraftRows(std::move(fieldMaps));
+}
+
+template<class Row> auto AbstractTable<Row>::addDraftRows(QVariantList fieldMaps) -> QList<RowId> {
     // No new edits allowed when edits are pending
     if (pendingEdits)
-        return;
+        return {};
 
-    QStringList unusedKeys;
-    Row newRow = Convert<Row>::fromVariantMap(fieldMap, Row(), &unusedKeys);
-    if (!unusedKeys.isEmpty())
-        qWarning() << tableAndScope << "Asked to draft add row, but row contained unknown fields:" << unusedKeys;
-    // Numeric IDs for draft rows are assigned by the table
-    if constexpr (std::is_integral_v<RowId>) {
-        if (newRow.getId() != RowId()) {
-            qWarning() << tableAndScope << "Asked to draft add row" << fieldMap << "which specifies a numerid ID."
-                       << "Draft added rows cannot specify their own numeric IDs";
-            return;
+    // Validate all of the new rows first, then place them in the table together
+    QList<QPair<Row, QVariantMap>> added;
+    added.reserve(fieldMaps.size());
+    RowId nextDraftId{};
+    if constexpr (std::is_integral_v<RowId>)
+        nextDraftId = (rowList.isEmpty() ||
+                       rowList.last().getId() < BASE_DRAFT_ID)? BASE_DRAFT_ID : (rowList.last().getId() + 1);
+    QSet<RowId> addedIds;
+    QList<RowId> draftIds(fieldMaps.size(), RowId());
+    for (int i = 0; i < fieldMaps.size(); ++i) {
+        QVariantMap fieldMap = fieldMaps[i].toMap();
+        QStringList unusedKeys;
+        Row newRow = Convert<Row>::fromVariantMap(fieldMap, Row(), &unusedKeys);
+        if (!unusedKeys.isEmpty())
+            qWarning() << tableAndScope << "Asked to draft add row, but row contained unknown fields:" << unusedKeys;
+        // Numeric IDs for draft rows are assigned by the table
+        if constexpr (std::is_integral_v<RowId>) {
+            if (newRow.getId() != RowId()) {
+                qWarning() << tableAndScope << "Asked to draft add row" << fieldMap << "which specifies a numerid ID."
+                           << "Draft added rows cannot specify their own numeric IDs";
+                continue;
+            }
+            newRow.setId(nextDraftId++);
+        } else {
+            // String IDs must be checked against collisions, including with the other new rows
+            if (getRow(newRow.getId()) != nullptr || addedIds.contains(newRow.getId())) {
+                qWarning() << tableAndScope << "Asked to draft add row" << newRow << "but ID collides with other row";
+                continue;
+            }
+            addedIds.insert(newRow.getId());
         }
-        newRow.setId((rowList.isEmpty() ||
-                      rowList.last().getId() < BASE_DRAFT_ID)? BASE_DRAFT_ID : (rowList.last().getId() + 1));
+        // Store the draft ID in the fieldMap to aid in lookup later
+        fieldMap[Strings::DraftId] = toQml(newRow.getId());
+        draftIds[i] = newRow.getId();
+        added.append(qMakePair(std::move(newRow), std::move(fieldMap)));
+    }
+    if (added.isEmpty())
+        return draftIds;
+    std::sort(added.begin(), added.end(), [](const auto& a, const auto& b) {
+        return a.first.getId() < b.first.getId();
+    });
+
+    // Add the rows to the table: at the end if they go there, as numeric draft IDs do, or else merged in one pass
+    if (rowList.isEmpty() || rowList.last().getId() < added.first().first.getId()) {
+        for (const auto& newRow : added)
+            rowList.append(newRow.first);
+        rowStates.insert(rowStates.end(), added.size(), LoadState::DraftAdd);
     } else {
-        // String IDs must be checked against collisions
-        if (getRow(newRow.getId()) != nullptr) {
-            qWarning() << tableAndScope << "Asked to draft add row" << newRow << "but ID collides with other row";
-            return;
+        QList<Row> mergedRows;
+        QVector<LoadState> mergedStates;
+        mergedRows.reserve(rowList.size() + added.size());
+        mergedStates.reserve(rowList.size() + added.size());
+        int i = 0;
+        for (const auto& newRow : added) {
+            for (; i < rowList.size() && rowList[i].getId() < newRow.first.getId(); ++i) {
+                mergedRows.append(std::move(rowList[i]));
+                mergedStates.append(rowStates[i]);
+            }
+            mergedRows.append(newRow.first);
+            mergedStates.append(LoadState::DraftAdd);
+        }
+        for (; i < rowList.size(); ++i) {
+            mergedRows.append(std::move(rowList[i]));
+            mergedStates.append(rowStates[i]);
         }
+        rowList = std::move(mergedRows);
+        rowStates = std::move(mergedStates);
+    }
+
+    // Add the rows to the new rows list
+    QList<Row> addedRows;
+    addedRows.reserve(added.size());
+    for (auto& newRow : added) {
+        indexRow(newRow.first);
+        locallyAddedRows.add(newRow.first.getId(), std::move(newRow.second));
+        RowOps::RowDraftAdded(newRow.first, this);
+        addedRows.append(std::move(newRow.first));
     }
-    // Store the draft ID in the fieldMap to aid in lookup later
-    fieldMap[Strings::DraftId] = QVariant::fromValue(newRow.getId());
 
-    // Add the row to the table and the new rows list
-    auto pos = std::lower_bound(rowList.begin(), rowList.end(), newRow.getId(), CompareId<Row>());
-    pos = rowList.insert(pos, newRow);
-    rowStates.insert(pos - rowList.begin(), LoadState::DraftAdd);
-    locallyAddedRows.append(fieldMap);
-    RowOps::RowDraftAdded(newRow, this);
+    // Add the rows to the backup rows with the DraftAdd state to signify that there was no backed up row
+    backups.saveAll(addedRows, QList<LoadState>(addedRows.size(), LoadState::DraftAdd));
 
-    // Add the row to the backup rows with the DraftAdd state to signify that there was no backed up row
-    backups.save(newRow, LoadState::DraftAdd);
+    tableChanged();
 
     // Notify the models
-    QList<Row> added{std::move(newRow)};
-    std::for_each(models.begin(), models.end(), [&added](Model* model) { model->updateRows(added); });
+    std::for_each(models.begin(), models.end(), [&addedRows](Model* model) { model->updateRows(addedRows); });
+    return draftIds;
 }
 
 template<class Row> void AbstractTable<Row>::draftDeleteRow(QVariant rowId) {
+    draftDeleteRows({rowId});
+}
+
+template<class Row> void AbstractTable<Row>::draftDeleteRows(QVariantList rowIds) {
     // No new edits allowed when edits are pending
     if (pendingEdits)
         return;
-    auto id = rowId.value<RowId>();
-    qInfo() << tableAndScope << "Draft deleting row ID" << id;
 
-    // Find the row
-    auto pos = std::lower_bound(rowList.begin(), rowList.end(), id, CompareId<Row>());
-    if (pos == rowList.end() || pos->getId() != id) {
-        qWarning() << tableAndScope << "Asked to draft delete row ID" << id << "but that ID wasn't found";
-        return;
+    QList<Row> backupRows;
+    QList<LoadState> backupStates;
+    QList<RowId> draftAddedIds;
+    std::set<RowId> deletedIds;
+    for (const QVariant& rowId : rowIds) {
+        auto id = fromQml<RowId>(rowId);
+        qInfo() << tableAndScope << "Draft deleting row ID" << id;
+
+        // Find the row
+        auto pos = std::lower_bound(rowList.begin(), rowList.end(), id, CompareId<Row>());
+        if (pos == rowList.end() || pos->getId() != id) {
+            qWarning() << tableAndScope << "Asked to draft delete row ID" << id << "but that ID wasn't found";
+            continue;
+        }
+
+        // If row is draft added, just delete it; it's not really there! Do so once the other backups are saved.
+        auto& state = rowStates[pos-rowList.begin()];
+        if (state == LoadState::DraftAdd) {
+            draftAddedIds.append(id);
+            continue;
+        }
+
+        // Mark row as draft delete and add it to the backup list
+        backupRows.append(*pos);
+        backupStates.append(state);
+        state = LoadState::DraftDelete;
+        RowOps::RowDraftDeleted(*pos, this);
+        deletedIds.insert(id);
     }
+    backups.saveAll(backupRows, backupStates);
 
-    // If row is draft added, just delete it; it's not really there!
-    auto& state = rowStates[pos-rowList.begin()];
-    if (state == LoadState::DraftAdd) {
-        auto itr = std::remove_if(locallyAddedRows.begin(), locallyAddedRows.end(), [rowId](QVariantMap row) {
-            return row[Strings::DraftId] == rowId;
-        });
-        locallyAddedRows.erase(itr, locallyAddedRows.end());
+    for (const auto& id : draftAddedIds) {
+        locallyAddedRows.remove(id);
         deleteRow(id);
         deleteBackupRow(id);
-        return;
     }
 
-    // Mark row as draft delete and add it to the backup list
-    backups.save(*pos, state);
-    state = LoadState::DraftDelete;
-    RowOps::RowDraftDeleted(*pos, this);
+    tableChanged();
 
-    // Notify the models
-    QList<Row> removed{*pos};
-    std::for_each(models.begin(), models.end(), [&removed](Model* model) { model->updateRows(removed); });
+    // Notify the models, in ID order
+    QList<Row> removed;
+    removed.reserve(deletedIds.size());
+    for (const auto& id : deletedIds)
+        removed.append(*getRow(id));
+    if (!removed.isEmpty())
+        std::for_each(models.begin(), models.end(), [&removed](Model* model) { model->updateRows(removed); });
 }
 
 template<class Row> void AbstractTable<Row>::markEditsPending() {
@@ -690,6 +1484,8 @@ template<class Row> void AbstractTable<Row>::markEditsPending() {
     });
     RowOps::DraftChangesPending(this);
 
+    tableChanged();
+
     // Notify the models
     std::for_each(models.begin(), models.end(), [&updates](Model* model) { model->updateRows(updates); });
     // Edits are now pending rather than draft, so set hasPendingEdits to true
@@ -712,8 +1508,10 @@ template<class Row> void AbstractTable<Row>::resetEdits() {
             } else {
                 qInfo() << tableAndScope << "Reverting locally edited or deleted row" << pos->getId();
                 // If the row was a local edit, restore its pre-edit value
-                if (rowState == LoadState::DraftEdit || rowState == LoadState::PendingEdit)
+                if (rowState == LoadState::DraftEdit || rowState == LoadState::PendingEdit) {
                     *pos = bak;
+                    indexRow(*pos);
+                }
                 // Whether it was a local edit or local delete, restore its old state
                 rowState = bakState;
             }
@@ -725,6 +1523,8 @@ template<class Row> void AbstractTable<Row>::resetEdits() {
     });
     RowOps::LocalChangesReset(this);
 
+    tableChanged();
+
     // Notify the models
     std::for_each(models.begin(), models.end(), [this](Model* model) { model->updateRows(backups.getRows()); });
 
@@ -739,28 +1539,36 @@ template<class Row> void AbstractTable<Row>::processRowsResponse(QNetworkReply*
     if (reply->error() != QNetworkReply::NoError)
         return;
 
-    // Sanity check response
-    QJsonValue nextKey;
-    auto jsonDoc = QJsonDocument::fromJson(reply->readAll());
-    auto rows = parseRows(jsonDoc, &nextKey);
-    if (!rows.has_value()) {
-        qWarning() << "Error in" << tableAndScope << "table: response to request for rows not sensible:" << jsonDoc;
+    // Sanity check and decode response
+    QList<Row> decodedRows;
+    std::optional<QString> nextKey;
+    auto response = reply->readAll();
+    if (!RowDecoder<Row>::decodeResponse(response, decodedRows, &nextKey)) {
+        qWarning() << "Error in" << tableAndScope << "table: response to request for rows not sensible:" << response;
+        if (rowFormat == RowFormat::Binary) {
+            // Most likely the contract's rows don't match our layout, so go back to JSON and reload
+            qWarning() << tableAndScope << "Falling back to JSON rows";
+            rowFormat = RowFormat::Json;
+            fullRefresh();
+        }
         return;
     }
 
     // Check if there's more to load and load it
-    if (!nextKey.isNull() && (loadCount == 0 || rows.value().size() < loadCount)) {
-        auto json = getTableJson(*TableName, scope, nextKey.toString());
-        auto* reply = callApi(Strings::GetTableRows, json);
-        size_t remaining = loadCount == 0? 0 : (loadCount - rows.value().size());
-        connect(reply, &QNetworkReply::finished, [this, reply, remaining] { processRowsResponse(reply, remaining); });
+    if (nextKey.has_value() && (loadCount == 0 || size_t(decodedRows.size()) < loadCount)) {
+        auto json = getTableJson(*TableName, QString::number(scope), nextKey.value(), rowFormat);
+        auto* reply = requestRows(std::move(json));
+        size_t remaining = loadCount == 0? 0 : (loadCount - decodedRows.size());
+        connect(reply, &QNetworkReply::finished, this,
+                [this, reply, remaining] { processRowsResponse(reply, remaining); });
     }
 
-    if (rows.value().isEmpty())
-        return;
+    if (!decodedRows.isEmpty())
+        mergeRows(decodedRows);
+}
 
+template<class Row> void AbstractTable<Row>::mergeRows(const QList<Row>& newRows) {
     // Find the position in the table where we'll begin placing rows
-    const QList<Row> newRows = Convert<Row>::fromJsonArray(rows.value());
     auto pos = std::lower_bound(rowList.begin(), rowList.end(), newRows.first(), CompareId<Row>());
     auto newPos = newRows.begin();
 
@@ -773,9 +1581,12 @@ template<class Row> void AbstractTable<Row>::processRowsResponse(QNetworkReply*
         rowList.append(newRows);
         // Insert the loadState roles
         rowStates.insert(rowStates.end(), newRows.length(), LoadState::Loaded);
+        for (const Row& row : newRows)
+            indexRow(row);
         RowOps::RowsAdded(newRows, this);
     } else {
         // Updating throughout
+        QList<Row> insertedRows;
         while (newPos != newRows.end()) {
             auto rowNumber = pos - rowList.begin();
             //Overwrite or insert?
@@ -786,6 +1597,7 @@ template<class Row> void AbstractTable<Row>::processRowsResponse(QNetworkReply*
                 auto oldState = rowStates[rowNumber];
                 *pos = std::move(*newPos);
                 rowStates[rowNumber] = LoadState::Loaded;
+                indexRow(*pos);
                 // Check the row against the edit tracking to see if it matches local insertion or edit
                 if (oldState == LoadState::PendingAdd || oldState == LoadState::Loading) {
                     RowOps::RowLoaded(*pos, this);
@@ -799,14 +1611,20 @@ template<class Row> void AbstractTable<Row>::processRowsResponse(QNetworkReply*
                 qInfo() << tableAndScope << "Inserting row ID" << newPos->getId();
                 pos = rowList.insert(pos, *newPos);
                 rowStates.insert(rowNumber, LoadState::Loaded);
+                indexRow(*pos);
+                insertedRows.append(*newPos);
                 // Check the row against the edit tracking to see if it matches a local insertion
                 checkPendingInsertion(*newPos);
             }
             if (++newPos != newRows.end())
                 pos = std::lower_bound(pos, rowList.end(), *newPos, CompareId<Row>());
         }
+        if (!insertedRows.isEmpty())
+            RowOps::RowsAdded(insertedRows, this);
     }
 
+    tableChanged();
+
     // Notify the models
     std::for_each(models.begin(), models.end(), [newRows](Model* model) { model->updateRows(newRows); });
 }
@@ -818,7 +1636,9 @@ template<class Row> void AbstractTable<Row>::deleteRow(RowId id) {
         rowStates.removeAt(pos - rowList.begin());
         auto row = std::move(*pos);
         rowList.erase(pos);
+        unindexRow(id);
         RowOps::RowDeleted(row, this);
+        tableChanged();
         if (state == LoadState::PendingDelete) {
             RowOps::PendingDeleteSettled(row, this);
             emit pendingEditSettled(Convert<Row>::toVariantMap(row), {{Strings::Deleted, QVariant(true)}});
@@ -826,7 +1646,7 @@ template<class Row> void AbstractTable<Row>::deleteRow(RowId id) {
                 qWarning() << tableAndScope << "Deleting row with pending delete state, but couldn't find the backup";
         } else if (state == LoadState::DraftAdd || state == LoadState::DraftEdit || state == LoadState::DraftDelete) {
             RowOps::DraftRowInvalidated(row, {}, this);
-            emit draftEditInvalidated(QVariant::fromValue(id));
+            emit draftEditInvalidated(toQml(id));
             deleteBackupRow(id);
         }
     }
@@ -844,13 +1664,18 @@ template<class Row> void AbstractTable<Row>::markStale(RowId id) {
         }
         // If row is in a draft state, reset it and notify that it got munged
         if (state == LoadState::DraftAdd || state == LoadState::DraftEdit || state == LoadState::DraftDelete) {
-            emit draftEditInvalidated(QVariant::fromValue(id));
+            emit draftEditInvalidated(toQml(id));
             if (!deleteBackupRow(id, &*pos, &state))
                 qWarning() << tableAndScope << "Draft row invalidated, but couldn't find the backup";
+            indexRow(*pos);
         }
 
         state = LoadState::Stale;
         RowOps::RowStale(*pos, this);
+        tableChanged();
+        // Models reload their stale rows, but a table followed without models, as by a virtual field, must do so itself
+        if (models.empty())
+            refreshRow(id);
     }
     std::for_each(models.begin(), models.end(), [id](Model* model) { model->markRowStale(id); });
 }
@@ -875,10 +1700,37 @@ template<class Row> void AbstractTable<Row>::getNew(RowId id) {
     {
         Row row;
         row.setId(id);
-        rowList.insert(pos, std::move(row));
+        pos = rowList.insert(pos, std::move(row));
     }
     rowStates.insert(index, LoadState::Loading);
+    indexRow(*pos);
     RowOps::RowLoading(*pos, this);
+    tableChanged();
+}
+
+template<class Row> void AbstractTable<Row>::tableChanged() {
+    if (snapshotQueued)
+        return;
+    snapshotQueued = true;
+    QMetaObject::invokeMethod(this, [this] { publishSnapshot(); }, Qt::QueuedConnection);
+}
+
+template<class Row> void AbstractTable<Row>::publishSnapshot() {
+    snapshotQueued = false;
+    // The lists are implicitly shared, so this is cheap. The table's next change detaches them from the snapshot.
+    auto next = std::make_shared<TableSnapshot<Row>>();
+    next->version = ++snapshotVersion;
+    next->scope = scope;
+    next->rows = rowList;
+    next->states = rowStates;
+    // The delta is usually small, and is only copied when it changes
+    if (deltaChanged) {
+        deltaChanged = false;
+        publishedDelta = forkDelta.isEmpty()? nullptr : std::make_shared<const ForkDelta<Row>>(forkDelta);
+    }
+    next->delta = publishedDelta;
+    std::atomic_store(&publishedSnapshot, std::shared_ptr<const TableSnapshot<Row>>(std::move(next)));
+    emit snapshotPublished();
 }
 
 template<class Row> void AbstractTable<Row>::checkPendingInsertion(const Row& newRow) {
@@ -888,29 +1740,19 @@ template<class Row> void AbstractTable<Row>::checkPendingInsertion(const Row& ne
     if (locallyAddedRows.isEmpty())
         return;
 
-    // Predicate to check if all fields specified in the QVariantMap match our new row
-    auto matchesRow = [&newRow](const QVariantMap newFields) {
-        return infra::typelist::runtime::all_of(RowFields(), [&newRow, &newFields] (auto Descriptor) {
-            using descriptor = typename decltype(Descriptor)::type;
-            QString fieldName(descriptor::get_name());
-            auto itr = newFields.find(fieldName);
-            if (itr != newFields.end())
-                return itr->value<typename descriptor::type>() == descriptor::get(newRow);
-            return true;
-        });
-    };
-
-    qInfo() << tableAndScope << "Checking incoming row" << newRow << "against added rows:" << locallyAddedRows;
-    auto match = std::find_if(locallyAddedRows.begin(), locallyAddedRows.end(), matchesRow);
-    if (match == locallyAddedRows.end())
+    // Only the count is logged here: the list may be thousands of rows long, and this runs for every incoming row
+    qInfo() << tableAndScope << "Checking incoming row" << newRow << "against" << locallyAddedRows.size()
+            << "added rows";
+    int otherMatches = 0;
+    auto match = locallyAddedRows.takeMatch(newRow, &otherMatches);
+    if (!match)
         // New row does not match a pending add
         return;
 
-    // We have a match! Remove it from the added rows list and delete any draft row that might be left
+    // We have a match! Delete any draft row that might be left
     qInfo() << tableAndScope << "New row" << newRow << "from backend matches a pending insertion" << *match;
-    QVariantMap matchFields = *match;
-    match = locallyAddedRows.erase(match);
-    auto draftID = matchFields[Strings::DraftId].value<RowId>();
+    QVariantMap matchFields = std::move(*match);
+    auto draftID = fromQml<RowId>(matchFields[Strings::DraftId]);
     if (draftID != newRow.getId())
         deleteRow(draftID);
     RowOps::PendingAddSettled(draftID, newRow, this);
@@ -924,7 +1766,7 @@ template<class Row> void AbstractTable<Row>::checkPendingInsertion(const Row& ne
         qWarning() << tableAndScope << "Matched inserted row to pending insertion, but couldn't find the backup";
 
     // Hopefully there was only one match; warn if there was another
-    if (std::find_if(locallyAddedRows.begin(), locallyAddedRows.end(), matchesRow) != locallyAddedRows.end())
+    if (otherMatches > 0)
         qWarning() << tableAndScope << "Multiple pending insertions matched an inserted row";
 }
 
@@ -940,21 +1782,16 @@ template<class Row> void AbstractTable<Row>::checkOverwrittenEdit(Row oldRow, Lo
         // This will probably never happen: an added row overwrites a draft addition
         qInfo() << tableAndScope << "Updated row from backend collides in ID with a draft added row";
         RowOps::DraftRowInvalidated(oldRow, newRow, this);
-        emit draftEditInvalidated(QVariant::fromValue(id));
+        emit draftEditInvalidated(toQml(id));
 
         // Remove row from locally added rows list
-        auto addItr = std::find_if(locallyAddedRows.begin(), locallyAddedRows.end(), [id](QVariantMap row) {
-                return row[Strings::DraftId].value<RowId>() == id;
-        });
-        if (addItr != locallyAddedRows.end())
-            locallyAddedRows.erase(addItr);
-        else
+        if (!locallyAddedRows.remove(id))
             qWarning() << tableAndScope << "Unable to find locally added row record for munged draft add row";
     } else if (oldState == LoadState::DraftEdit) {
         qInfo() << tableAndScope << "Update from backend overwrote draft edit on row ID" << id;
         RowOps::DraftRowInvalidated(oldRow, newRow, this);
         // Notify of the overwritten Draft edit
-        emit draftEditInvalidated(QVariant::fromValue(id));
+        emit draftEditInvalidated(toQml(id));
     } else if (oldState == LoadState::PendingEdit) {
         qInfo() << tableAndScope << "Update from backend overwrote pending edit on row ID" << id;
         RowOps::PendingEditSettled(oldRow, newRow, this);
@@ -968,7 +1805,7 @@ template<class Row> void AbstractTable<Row>::checkOverwrittenEdit(Row oldRow, Lo
     } else if (oldState == LoadState::DraftDelete || oldState == LoadState::PendingDelete) {
         qInfo() << tableAndScope << "Updated row from backend changes a row we had a local delete for";
         RowOps::DraftRowInvalidated(oldRow, newRow, this);
-        emit draftEditInvalidated(QVariant::fromValue(id));
+        emit draftEditInvalidated(toQml(id));
     }
 
     // In most cases, we want to delete the backup, but not if the row was Loading, and PendingAdd did it already
@@ -1,6 +1,15 @@
 #include <AbstractTableInterface.hpp>
 #include <BlockchainInterface.hpp>
+#include <FpsTimer.hpp>
+
+#include <QCoreApplication>
 
 // We can't inline this because we need to see the real definition of BlockchainInterface to cast it to QObject
-AbstractTableInterface::AbstractTableInterface(BlockchainInterface* blockchain, QString scope)
+AbstractTableInterface::AbstractTableInterface(BlockchainInterface* blockchain, uint64_t scope)
     : QObject(blockchain), blockchain(blockchain), scope(scope) {}
+
+FpsTimer* AbstractTableInterface::frameTimer() {
+    // Models live in the main thread, so this is only ever called from there
+    static FpsTimer* timer = new FpsTimer(QCoreApplication::instance());
+    return timer;
+}
@@ -9,6 +9,7 @@
 #include <QAbstractListModel>
 
 class BlockchainInterface;
+class FpsTimer;
 
 //! \brief An entry in the database journal, declaring a change in one of the other tables
 struct JournalEntry {
@@ -22,6 +23,10 @@ struct JournalEntry {
         DeleteRow,
         ModifyRow
     } type;
+    //! The latest block the change may have been made in, found from the entry's timestamp; 0 if unknown
+    uint64_t blockNumber = 0;
+    //! Set if the entry makes the same change as one applied before a fork reverted it, and is read again after it
+    bool replayed = false;
 
     JournalEntry() {}
     JournalEntry(QJsonObject json);
@@ -34,6 +39,11 @@ struct JournalEntry {
                 std::tie(other.id, other.timestamp, other.table, other.scope, other.key, other.type);
     }
     bool operator!=(const JournalEntry& other) const { return !(*this == other); }
+    //! True if the entries record the same change, even if the change was made at a different time
+    bool isSameChange(const JournalEntry& other) const {
+        return std::tie(id, table, scope, key, type) ==
+                std::tie(other.id, other.table, other.scope, other.key, other.type);
+    }
 };
 
 /*!
@@ -61,10 +71,10 @@ class AbstractTableInterface : public QObject {
 protected:
     bool pendingEdits = false;
     BlockchainInterface* blockchain;
-    QString scope;
+    uint64_t scope;
 
 public:
-    explicit AbstractTableInterface(BlockchainInterface* blockchain, QString scope);
+    explicit AbstractTableInterface(BlockchainInterface* blockchain, uint64_t scope);
     virtual ~AbstractTableInterface() {}
 
     constexpr static uint64_t BASE_DRAFT_ID = 1'000'000'000'000;
@@ -73,19 +83,79 @@ public:
     quint64 baseDraftId() const { return BASE_DRAFT_ID; }
 
     virtual QString tableName() const = 0;
-    virtual QVariant tableScope() const { return scope; }
+    virtual QVariant tableScope() const { return QString::number(scope); }
+    //! The scope of the table, as the number journal entries identify it by
+    uint64_t scopeValue() const { return scope; }
     virtual bool hasPendingEdits() const = 0;
 
     Q_INVOKABLE virtual QAbstractListModel* allRows() = 0;
+    /*!
+     * \brief Get a model of all rows as of the last irreversible block
+     *
+     * Unlike allRows, which shows the rows as of the head block, this model leaves out changes made in blocks which
+     * may yet be reverted by a fork. It follows the table as the irreversible block advances and the changes settle.
+     */
+    Q_INVOKABLE virtual QAbstractListModel* irreversibleRows() = 0;
+    /*!
+     * \brief Get a model of the rows whose tags match an expression
+     * \param expression Tags combined with & (and), | (or) and ! (not), and grouped with parentheses, such as
+     * `board & !observer`. Tags containing spaces or operators may be quoted with double quotes.
+     *
+     * Like the model from allRows, the model follows the table as it changes, gaining and losing rows as their tags
+     * come to match the expression or stop matching it. Returns null if the table's rows have no tags, or the
+     * expression is invalid.
+     */
+    Q_INVOKABLE virtual QAbstractListModel* rowsWithTags(QString expression) = 0;
+    //! \brief Count the table's rows, as the model from allRows would show them, without making a model of them
+    Q_INVOKABLE virtual int countRows() const = 0;
+    //! \brief Count the rows whose tags match an expression, as for rowsWithTags, without making a model of them.
+    //! Returns -1 if the table's rows have no tags, or the expression is invalid.
+    Q_INVOKABLE virtual int countRowsWithTags(QString expression) const = 0;
     Q_INVOKABLE virtual QJSValue findRowIf(QJSValue predicate) const = 0;
     Q_INVOKABLE virtual QVariantMap getRow(QVariant id) const = 0;
     Q_INVOKABLE virtual QVariantList localRows() const = 0;
 
     BlockchainInterface* getBlockchain() const { return blockchain; }
 
+    //! The approximate number of bytes of memory used by the table, its backups, and its models
+    virtual qint64 approximateBytes() const = 0;
+    //! The number of models open on the table
+    virtual int modelCount() const = 0;
+    //! True if the table has edits, draft or pending; false otherwise
+    virtual bool hasLocalEdits() const = 0;
+    //! True while requests for the table's rows are awaiting a response
+    virtual bool isLoading() const = 0;
+    /*!
+     * \brief Save the table's rows in a compact form, so that they can be restored into a new table
+     * \return The saved rows, or an empty array if the table has rows which are not fully loaded
+     */
+    virtual QByteArray spill() const = 0;
+    /*!
+     * \brief Load rows saved by \ref spill into the table, as though they had been loaded from the backend
+     * \return True if the rows were restored; false if the table is not empty, or the saved rows can't be read
+     */
+    virtual bool restore(const QByteArray& spilled) = 0;
+    /*!
+     * \brief Replace the table's rows with rows saved by \ref spill, as though they were the table's full contents
+     * just loaded from the backend
+     * \return True if the rows were replaced; false if the saved rows can't be read
+     *
+     * Rows the saved rows lack are deleted, other than local additions; new and changed rows are placed in the table
+     * and settle local edits just as rows from the backend do. Unchanged rows are left alone.
+     */
+    virtual bool replaceRows(const QByteArray& spilled) = 0;
+
+    //! The frame timer which table models align their change notifications to
+    static FpsTimer* frameTimer();
+
 public slots:
     virtual void fullRefresh() = 0;
     virtual void processJournal(QList<JournalEntry> entries) = 0;
+    //! \brief Settle the changes made in the given block or before, which can no longer be reverted
+    virtual void settleIrreversible(quint64 irreversibleBlock) = 0;
+    //! \brief Undo the changes which may have been made in the given block or after, which a fork has reverted, and
+    //! reload the rows they changed
+    virtual void rollBackFork(quint64 firstRevertedBlock) = 0;
 
     /*!
      * \brief Make edits to a row, marking the row state as Draft
@@ -121,6 +191,29 @@ public slots:
      * Sets a row in the table to PendingDelete state. If the table has pending edits, the edit will fail.
      */
     virtual void draftDeleteRow(QVariant rowId) = 0;
+    /*!
+     * \brief Make draft edits to many rows at once
+     * \param rowIds The IDs of the rows to edit
+     * \param changeMaps The changes to make to each row, parallel to rowIds
+     *
+     * Equivalent to calling \ref draftEditRow for each row, but models are notified of all of the edits together.
+     */
+    virtual void draftEditRows(QVariantList rowIds, QVariantList changeMaps) = 0;
+    /*!
+     * \brief Make draft edits adding many new rows at once
+     * \param fieldMaps The fields of each new row
+     *
+     * Equivalent to calling \ref draftAddRow for each row, but the rows are placed in the table in a single pass, and
+     * models are notified of all of the new rows together. Rows which fail validation are skipped.
+     */
+    virtual void draftAddRows(QVariantList fieldMaps) = 0;
+    /*!
+     * \brief Make draft edits deleting many rows at once
+     * \param rowIds The IDs of the rows to delete
+     *
+     * Equivalent to calling \ref draftDeleteRow for each row, but models are notified of all of the deletions together.
+     */
+    virtual void draftDeleteRows(QVariantList rowIds) = 0;
     //! \brief Update all edits in this table to a Pending status instead of Draft. If table already has Pending
     //! edits, this function does nothing.
     virtual void markEditsPending() = 0;
@@ -175,6 +268,8 @@ signals:
     void pendingEditSettled(QVariantMap pendingRow, QVariantMap settledRow);
 
     void hasPendingEditsChanged(bool hasPendingEdits);
+    //! \brief Emitted after a batch of changes to the table's rows, once the table has published a new snapshot
+    void snapshotPublished();
     void blockchainChanged(BlockchainInterface* blockchain);
 };
 
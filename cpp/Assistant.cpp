@@ -5,9 +5,12 @@
 
 #include <QCache>
 #include <QMap>
+#include <QMutex>
 #include <QPainter>
 #include <QPainterPath>
 #include <QReadWriteLock>
+#include <QRunnable>
+#include <QThreadPool>
 
 // File-local, mutex-protected pointer to a shared FpsTimer for all assistants
 static FpsTimer* timer = nullptr;
@@ -149,125 +152,204 @@ Task* Assistant::createTask() {
 // Constexpr sqrt based on Newton-Raphson method. Adapted from https://stackoverflow.com/a/34134071
 double constexpr nr_sqrt(double x, double a = 1, double b = 0) { return (a == b)? a : nr_sqrt(x, 0.5*(a+x/a), a); }
 
-void drawRing(QPainter* painter, QSizeF size) {
+// The logo shapes are built once, at this edge length, and scaled to whatever size is requested. The boolean path
+// operations are expensive, so they must never run per request.
+constexpr static qreal LOGO_REFERENCE_EDGE = 1000;
+
+const QPainterPath& ringPath() {
+    static const QPainterPath path = [] {
+        auto edge = LOGO_REFERENCE_EDGE;
+        QSizeF canvasSize(edge, edge);
+        QPainterPath path;
+        constexpr auto ringScale = .1;
+        constexpr auto root2 = nr_sqrt(2.0);
+        auto ringWidth = edge * ringScale;
+        auto gapWidth = ringWidth / 2;
+        auto leg = gapWidth / root2;
+
+        // First, draw the outer circle of the ring filling the entire canvas
+        path.addEllipse(QRectF(QPointF(), canvasSize));
+
+        // Cut out the center of the ring
+        {
+            QPainterPath cutout;
+            cutout.addEllipse(QRectF(QPointF(ringWidth, ringWidth), canvasSize*(1 - 2*ringScale)));
+            path = path.subtracted(cutout);
+        }
+
+        // Cut out the four gaps in the ring
+        {
+            QPainterPath cutout;
+            cutout.moveTo(ringWidth/2, edge/2 + leg);
+            cutout.lineTo(cutout.currentPosition().x() + ringWidth, cutout.currentPosition().y() - ringWidth);
+            cutout.lineTo(cutout.currentPosition().x() - leg, cutout.currentPosition().y() - leg);
+            cutout.lineTo(cutout.currentPosition().x() - ringWidth*2, cutout.currentPosition().y() + ringWidth*2);
+            cutout.lineTo(cutout.currentPosition().x() + leg, cutout.currentPosition().y() + leg);
+
+            cutout.moveTo(edge/2 - leg, ringWidth/2);
+            cutout.lineTo(cutout.currentPosition().x() + ringWidth, cutout.currentPosition().y() + ringWidth);
+            cutout.lineTo(cutout.currentPosition().x() + leg, cutout.currentPosition().y() - leg);
+            cutout.lineTo(cutout.currentPosition().x() - ringWidth*2, cutout.currentPosition().y() - ringWidth*2);
+            cutout.lineTo(cutout.currentPosition().x() - leg, cutout.currentPosition().y() + leg);
+
+            cutout.moveTo(edge - ringWidth/2, edge/2 - leg);
+            cutout.lineTo(cutout.currentPosition().x() - ringWidth, cutout.currentPosition().y() + ringWidth);
+            cutout.lineTo(cutout.currentPosition().x() + leg, cutout.currentPosition().y() + leg);
+            cutout.lineTo(cutout.currentPosition().x() + ringWidth*2, cutout.currentPosition().y() - ringWidth*2);
+            cutout.lineTo(cutout.currentPosition().x() - leg, cutout.currentPosition().y() - leg);
+
+            cutout.moveTo(edge/2 - leg, edge - ringWidth/2);
+            cutout.lineTo(cutout.currentPosition().x() + ringWidth, cutout.currentPosition().y() + ringWidth);
+            cutout.lineTo(cutout.currentPosition().x() + leg, cutout.currentPosition().y() - leg);
+            cutout.lineTo(cutout.currentPosition().x() - ringWidth*2, cutout.currentPosition().y() - ringWidth*2);
+            cutout.lineTo(cutout.currentPosition().x() - leg, cutout.currentPosition().y() + leg);
+
+            path = path.subtracted(cutout);
+        }
+        return path;
+    }();
+    return path;
+}
+
+const QPainterPath& veePath() {
+    static const QPainterPath path = [] {
+        QSizeF canvasSize(LOGO_REFERENCE_EDGE, LOGO_REFERENCE_EDGE);
+        QPainterPath path;
+        auto veeHeight = canvasSize.height() * .421;
+        auto veeWidth = veeHeight * 1.1;
+        auto veeSlope = 1.52;
+        auto pointSlope = 1.538;
+        auto hCenter = canvasSize.width() / 2;
+        // The vee sits slightly below vertical center
+        auto veeBase = canvasSize.height()/2 + veeHeight/1.6;
+        auto veeTop = veeBase - veeHeight;
+        auto veeLeft = canvasSize.width()/2 - veeWidth/2;
+        auto veeRight = veeLeft + veeWidth;
+
+        // Start at bottom point
+        QPointF bottomPoint(hCenter, veeBase);
+        auto deltaX = veeRight - hCenter;
+        // Draw a line up to the right edge
+        QPointF rightEdge(veeRight, veeBase - (deltaX*veeSlope));
+        auto deltaY = rightEdge.y() - veeTop;
+        // Draw a line up to the top of the right point
+        QPointF rightTip(rightEdge.x() + deltaY/-pointSlope, veeTop);
+        // Draw a line back to the center, now on the higher edge of the V
+        deltaX = rightTip.x() - hCenter;
+        QPointF higherEdgeBottomPoint(hCenter, rightTip.y() + deltaX*veeSlope);
+        // We've now drawn the right half of the vee. Calculate the left half points by reflection.
+        QPointF leftTip(veeLeft + (veeRight - rightTip.x()), veeTop);
+        QPointF leftEdge(veeLeft, rightEdge.y());
+
+        QPolygonF vee({bottomPoint, rightEdge, rightTip, higherEdgeBottomPoint, leftTip, leftEdge, bottomPoint});
+        path.addPolygon(vee);
+        return path;
+    }();
+    return path;
+}
+
+void drawLogoPath(QPainter* painter, QSizeF size, const QPainterPath& path) {
     // Leave 1 pixel padding around entire path
     auto edge = std::min(size.width(), size.height()) - 2;
-    QSizeF canvasSize(edge, edge);
-    QPainterPath path;
-    constexpr auto ringScale = .1;
-    constexpr auto root2 = nr_sqrt(2.0);
-    auto ringWidth = edge * ringScale;
-    auto gapWidth = ringWidth / 2;
-    auto leg = gapWidth / root2;
-
-    // First, draw the outer circle of the ring filling the entire canvas
-    path.addEllipse(QRectF(QPointF(), canvasSize));
-
-    // Cut out the center of the ring
+    auto scale = edge / LOGO_REFERENCE_EDGE;
+
+    painter->translate(1, 1);
+    painter->scale(scale, scale);
+    painter->fillPath(path, QBrush(Qt::black));
+    // The pen is scaled along with the path, so a width of .001 of the reference edge is .001 of the painted edge
+    painter->strokePath(path, QPen(Qt::white, LOGO_REFERENCE_EDGE * .001));
+}
+
+QImage renderLogo(const QString& id, QSize paintSize) {
+    QImage image(paintSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    if (id == "ring")
+        drawLogoPath(&painter, paintSize, ringPath());
+    else if (id == "vee")
+        drawLogoPath(&painter, paintSize, veePath());
+    else
+        qCritical() << "AssistantImageProvider: Asked to provide image with unknown ID" << id;
+
+    return image;
+}
+
+// Rendered logo images are cached by ID and size bucket. Requested sizes are rounded up to the bucket granularity,
+// so an animated resize hits the cache for most frames, and the cached image is scaled down to the size requested.
+constexpr static int LOGO_SIZE_BUCKET = 16;
+// Maximum size of the image cache, in kilobytes
+constexpr static int LOGO_CACHE_KB = 16 * 1024;
+static QCache<QString, QImage> logoCache(LOGO_CACHE_KB);
+static QMutex logoCacheLock;
+
+QSize logoSize(QSize requestedSize) { return requestedSize.isEmpty()? QSize(100, 100) : requestedSize; }
+
+QSize bucketLogoSize(QSize requestedSize) {
+    auto paintSize = logoSize(requestedSize);
+    auto roundUp = [](int dimension) {
+        return std::max(LOGO_SIZE_BUCKET, (dimension + LOGO_SIZE_BUCKET - 1) / LOGO_SIZE_BUCKET * LOGO_SIZE_BUCKET);
+    };
+    return QSize(roundUp(paintSize.width()), roundUp(paintSize.height()));
+}
+
+QImage cachedLogo(const QString& id, QSize requestedSize) {
+    auto paintSize = bucketLogoSize(requestedSize);
+    auto key = QStringLiteral("%1@%2x%3").arg(id).arg(paintSize.width()).arg(paintSize.height());
+    auto fitted = [size = logoSize(requestedSize)](const QImage& image) {
+        return image.size() == size? image : image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    };
+
     {
-        QPainterPath cutout;
-        cutout.addEllipse(QRectF(QPointF(ringWidth, ringWidth), canvasSize*(1 - 2*ringScale)));
-        path = path.subtracted(cutout);
+        QMutexLocker lock(&logoCacheLock);
+        if (auto* image = logoCache.object(key)) {
+            QImage cached = *image;
+            lock.unlock();
+            return fitted(cached);
+        }
     }
 
-    // Cut out the four gaps in the ring
+    // Render outside the lock; if two threads race to render the same image, the loser's copy simply replaces it
+    auto image = renderLogo(id, paintSize);
     {
-        QPainterPath cutout;
-        cutout.moveTo(ringWidth/2, edge/2 + leg);
-        cutout.lineTo(cutout.currentPosition().x() + ringWidth, cutout.currentPosition().y() - ringWidth);
-        cutout.lineTo(cutout.currentPosition().x() - leg, cutout.currentPosition().y() - leg);
-        cutout.lineTo(cutout.currentPosition().x() - ringWidth*2, cutout.currentPosition().y() + ringWidth*2);
-        cutout.lineTo(cutout.currentPosition().x() + leg, cutout.currentPosition().y() + leg);
-
-        cutout.moveTo(edge/2 - leg, ringWidth/2);
-        cutout.lineTo(cutout.currentPosition().x() + ringWidth, cutout.currentPosition().y() + ringWidth);
-        cutout.lineTo(cutout.currentPosition().x() + leg, cutout.currentPosition().y() - leg);
-        cutout.lineTo(cutout.currentPosition().x() - ringWidth*2, cutout.currentPosition().y() - ringWidth*2);
-        cutout.lineTo(cutout.currentPosition().x() - leg, cutout.currentPosition().y() + leg);
-
-        cutout.moveTo(edge - ringWidth/2, edge/2 - leg);
-        cutout.lineTo(cutout.currentPosition().x() - ringWidth, cutout.currentPosition().y() + ringWidth);
-        cutout.lineTo(cutout.currentPosition().x() + leg, cutout.currentPosition().y() + leg);
-        cutout.lineTo(cutout.currentPosition().x() + ringWidth*2, cutout.currentPosition().y() - ringWidth*2);
-        cutout.lineTo(cutout.currentPosition().x() - leg, cutout.currentPosition().y() - leg);
-
-        cutout.moveTo(edge/2 - leg, edge - ringWidth/2);
-        cutout.lineTo(cutout.currentPosition().x() + ringWidth, cutout.currentPosition().y() + ringWidth);
-        cutout.lineTo(cutout.currentPosition().x() + leg, cutout.currentPosition().y() - leg);
-        cutout.lineTo(cutout.currentPosition().x() - ringWidth*2, cutout.currentPosition().y() - ringWidth*2);
-        cutout.lineTo(cutout.currentPosition().x() - leg, cutout.currentPosition().y() + leg);
-
-        path = path.subtracted(cutout);
+        QMutexLocker lock(&logoCacheLock);
+        logoCache.insert(key, new QImage(image), std::max<qsizetype>(1, image.sizeInBytes() / 1024));
     }
-
-    path.translate(1, 1);
-    painter->fillPath(path, QBrush(Qt::black));
-    painter->strokePath(path, QPen(Qt::white, canvasSize.width() * .001));
+    return fitted(image);
 }
 
-void drawVee(QPainter* painter, QSizeF size) {
-    // Leave 1 pixel padding around entire path
-    auto edge = std::min(size.width(), size.height()) - 2;
-    QSizeF canvasSize(edge, edge);
-    QPainterPath path;
-    auto veeHeight = canvasSize.height() * .421;
-    auto veeWidth = veeHeight * 1.1;
-    auto veeSlope = 1.52;
-    auto pointSlope = 1.538;
-    auto hCenter = canvasSize.width() / 2;
-    // The vee sits slightly below vertical center
-    auto veeBase = canvasSize.height()/2 + veeHeight/1.6;
-    auto veeTop = veeBase - veeHeight;
-    auto veeLeft = canvasSize.width()/2 - veeWidth/2;
-    auto veeRight = veeLeft + veeWidth;
-
-    // Start at bottom point
-    QPointF bottomPoint(hCenter, veeBase);
-    auto deltaX = veeRight - hCenter;
-    // Draw a line up to the right edge
-    QPointF rightEdge(veeRight, veeBase - (deltaX*veeSlope));
-    auto deltaY = rightEdge.y() - veeTop;
-    // Draw a line up to the top of the right point
-    QPointF rightTip(rightEdge.x() + deltaY/-pointSlope, veeTop);
-    // Draw a line back to the center, now on the higher edge of the V
-    deltaX = rightTip.x() - hCenter;
-    QPointF higherEdgeBottomPoint(hCenter, rightTip.y() + deltaX*veeSlope);
-    // We've now drawn the right half of the vee. Calculate the left half points by reflection.
-    QPointF leftTip(veeLeft + (veeRight - rightTip.x()), veeTop);
-    QPointF leftEdge(veeLeft, rightEdge.y());
-
-    QPolygonF vee({bottomPoint, rightEdge, rightTip, higherEdgeBottomPoint, leftTip, leftEdge, bottomPoint});
-    path.addPolygon(vee);
-
-    path.translate(1, 1);
-    painter->fillPath(path, QBrush(Qt::black));
-    painter->strokePath(path, QPen(Qt::white, canvasSize.width() * .001));
-}
+class AssistantImageResponse : public QQuickImageResponse, public QRunnable {
+    QString id;
+    QSize requestedSize;
+    QImage image;
+
+public:
+    AssistantImageResponse(QString id, QSize requestedSize) : id(std::move(id)), requestedSize(requestedSize) {
+        setAutoDelete(false);
+    }
+
+    QQuickTextureFactory* textureFactory() const override {
+        return QQuickTextureFactory::textureFactoryForImage(image);
+    }
+
+    void run() override {
+        image = cachedLogo(id, requestedSize);
+        emit finished();
+    }
+};
+
+class AssistantImageProvider : public QQuickAsyncImageProvider {
+    QThreadPool pool;
 
-class AssistantImageProvider : public QQuickImageProvider {
 public:
-    AssistantImageProvider() : QQuickImageProvider(QQuickImageProvider::Image) {}
-
-    QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override {
-        QSize paintSize(100, 100);
-        if (!requestedSize.isEmpty())
-            paintSize = requestedSize;
-        *size = paintSize;
-
-        QImage image(paintSize, QImage::Format_ARGB32);
-        image.fill(Qt::transparent);
-        QPainter painter(&image);
-        painter.setRenderHint(QPainter::Antialiasing);
-
-        if (id == "ring")
-            drawRing(&painter, paintSize);
-        else if (id == "vee")
-            drawVee(&painter, paintSize);
-        else
-            qCritical() << "AssistantImageProvider: Asked to provide image with unknown ID" << id;
-
-        return image;
+    AssistantImageProvider() { pool.setMaxThreadCount(1); }
+
+    QQuickImageResponse* requestImageResponse(const QString& id, const QSize& requestedSize) override {
+        auto* response = new AssistantImageResponse(id, requestedSize);
+        pool.start(response);
+        return response;
     }
 };
 
-QQuickImageProvider* Assistant::getLogoProvider() { return new AssistantImageProvider(); }
+QQuickAsyncImageProvider* Assistant::getLogoProvider() { return new AssistantImageProvider(); }
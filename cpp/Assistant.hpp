@@ -17,7 +17,7 @@ public:
     explicit Assistant(QObject *parent = nullptr);
     virtual ~Assistant();
 
-    static QQuickImageProvider* getLogoProvider();
+    static QQuickAsyncImageProvider* getLogoProvider();
     static QByteArray getLoggingTag(const Task* t);
     static void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message);
 
@@ -1,11 +1,21 @@
 #include <BlockchainInterface.hpp>
+#include <CannedReply.hpp>
+#include <HttpTransport.hpp>
+#include <JournalRouter.hpp>
+#include <NodePool.hpp>
+#include <NodeProber.hpp>
+#include <SharedTableCache.hpp>
+#include <TableRegistry.hpp>
 #include <Tables.hpp>
+#include <TrafficLog.hpp>
 
 #include <QEventLoop>
+#include <QHash>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QNetworkReply>
+#include <QPointer>
 #include <QTimeZone>
 #include <QTimer>
 #include <QQmlEngine>
@@ -14,13 +24,29 @@
 class BlockchainInterface_Private {
 public:
     QUrl nodeUrl;
+    // Nodes other than nodeUrl which may serve requests
+    QList<QUrl> extraNodeUrls;
+    NodePool nodes;
+    // The node most recently selected to serve reads
+    QUrl activeNode;
+    // The most recent probe of candidate nodes
+    NodeProber* prober = nullptr;
     QByteArray chainId;
     QByteArray headBlockId;
     unsigned long headBlockNumber = 0;
     unsigned long irreversibleBlockNumber = 0;
     QDateTime headBlockTime;
     uint64_t serverLatency = 0;
-    QNetworkAccessManager* network;
+    HttpTransport* http;
+    // If set, API calls are sent through this rather than the network
+    ApiCallback transport;
+    MetricsRegistry* metrics;
+    JournalRouter* journalRouter;
+    TableRegistry* tableRegistry;
+    // If set, tables are shared with other processes through this cache
+    SharedTableCache* sharedCache = nullptr;
+    // If set, API calls and their responses are recorded through this
+    TrafficRecorder* recorder = nullptr;
     BlockchainInterface::SyncStatus syncStatus = BlockchainInterface::SyncStatus::Idle;
     uint32_t syncInterval = 2500;
     uint32_t syncStaleSeconds = 10;
@@ -28,14 +54,49 @@ public:
     QTimer* syncTimer = nullptr;
     JournalEntry lastJournalEntry;
 
+    // Blocks seen at the head which are not yet irreversible, by number: their IDs, to spot forks which revert them,
+    // and their times, to find which blocks journal entries are from
+    struct SeenBlock {
+        QByteArray id;
+        QDateTime time;
+    };
+    QMap<unsigned long, SeenBlock> reversibleBlocks;
+    // The irreversible block the tables were last told of, and the time of it or of the latest block seen before it
+    unsigned long settledBlock = 0;
+    QDateTime settledBlockTime;
+    // The highest head block any node has reported, and its time
+    unsigned long latestHeadNumber = 0;
+    QDateTime latestHeadTime;
+    // Journal entries which may be from blocks that are not yet irreversible, to follow again if a fork reverts them
+    QList<JournalEntry> reversibleJournal;
+    // Entries which were applied and then reverted by a fork, by ID, to recognize them if they are read again, and the
+    // ID of the last of them
+    QHash<uint64_t, JournalEntry> revertedJournal;
+    uint64_t lastRevertedEntry = 0;
+
     PollingGroupsTable* pollingGroupTable = nullptr;
     QMap<uint64_t, GroupMembersTable*> groupAccountsTables;
 };
 
 // Constructor & destructor
 BlockchainInterface::BlockchainInterface(QObject *parent) : QObject(parent), data(new BlockchainInterface_Private()) {
-    data->network = new QNetworkAccessManager(this);
+    data->http = new HttpTransport(this);
+    data->metrics = new MetricsRegistry(this);
+    data->journalRouter = new JournalRouter(this);
+    connect(this, &BlockchainInterface::newJournalEntries, data->journalRouter, &JournalRouter::route);
+    data->tableRegistry = new TableRegistry(this);
+    connect(this, &BlockchainInterface::newJournalEntries, data->tableRegistry, &TableRegistry::processJournal);
+    connect(this, &BlockchainInterface::refreshAllTables, data->tableRegistry, &TableRegistry::discardSpilled);
+    connect(this, &BlockchainInterface::nodeError, data->metrics, &MetricsRegistry::nodeErrorOccurred);
     connect(this, &BlockchainInterface::nodeUrlChanged, &BlockchainInterface::connectNow);
+
+    // Operators running several instances on one machine can have them share their tables without configuring each
+    auto sharedCacheName = qEnvironmentVariable("POLLARIS_SHARED_CACHE");
+    if (!sharedCacheName.isEmpty())
+        setSharedCacheName(sharedCacheName);
+    auto trafficLogPath = qEnvironmentVariable("POLLARIS_RECORD_TRAFFIC");
+    if (!trafficLogPath.isEmpty())
+        setTrafficLogPath(trafficLogPath);
 }
 
 BlockchainInterface::~BlockchainInterface() {
@@ -51,26 +112,47 @@ AbstractTableInterface* BlockchainInterface::getPollingGroupTable() {
     auto scope = eosio::string_to_uint64_t(Strings::Global);
     auto table = data->pollingGroupTable = new PollingGroupsTable(this, makeApiCaller(), scope);
     connect(table, &QObject::destroyed, this, [this] { data->pollingGroupTable = nullptr; });
-    connect(this, &BlockchainInterface::refreshAllTables, table, &AbstractTableInterface::fullRefresh);
-    connect(this, &BlockchainInterface::newJournalEntries, table, &AbstractTableInterface::processJournal);
+    connectTable(table);
+    data->journalRouter->addTable(table);
+    if (data->sharedCache != nullptr)
+        data->sharedCache->addTable(table);
     return table;
 }
 
 AbstractTableInterface* BlockchainInterface::getGroupMembersTable(quint64 groupId) {
-    if (data->groupAccountsTables.contains(groupId))
-        return data->groupAccountsTables[groupId];
+    if (data->groupAccountsTables.contains(groupId)) {
+        auto table = data->groupAccountsTables[groupId];
+        data->tableRegistry->touch(table);
+        return table;
+    }
 
     auto table = data->groupAccountsTables[groupId] = new GroupMembersTable(this, makeApiCaller(), groupId);
-    connect(table, &QObject::destroyed, this, [this, groupId] { data->groupAccountsTables.remove(groupId); });
-    connect(this, &BlockchainInterface::refreshAllTables, table, &AbstractTableInterface::fullRefresh);
-    connect(this, &BlockchainInterface::newJournalEntries, table, &AbstractTableInterface::processJournal);
+    // The table may have been rescoped since, so find it by pointer, not by the group it was made for
+    connect(table, &QObject::destroyed, this, [this, table] {
+        for (auto itr = data->groupAccountsTables.begin(); itr != data->groupAccountsTables.end(); ++itr)
+            if (itr.value() == table) {
+                data->groupAccountsTables.erase(itr);
+                return;
+            }
+    });
+    connectTable(table);
+    data->journalRouter->addTable(table);
+    // If the table was evicted before, show its rows straight away; the first model will refresh them
+    auto spilled = data->tableRegistry->takeSpilled(table->tableName(), groupId);
+    if (!spilled.isEmpty())
+        table->restore(spilled);
+    // Group members tables are opened for every group ever viewed, so let the registry evict those not in use.
+    // The polling groups table is never evicted: there's only one, and nearly everything uses it.
+    data->tableRegistry->addTable(table);
+    if (data->sharedCache != nullptr)
+        data->sharedCache->addTable(table);
     return table;
 }
 
 void BlockchainInterface::rescopeGroupMembersTable(quint64 oldGroup, quint64 newGroup) {
     if (data->groupAccountsTables.contains(oldGroup)) {
         auto table = data->groupAccountsTables.take(oldGroup);
-        table->updateScope(QString::number(newGroup));
+        table->updateScope(newGroup);
 
         if (data->groupAccountsTables.contains(newGroup)) {
             qWarning() << "BlockchainInterface: Rescoping GroupMembers table" << oldGroup << "to" << newGroup
@@ -94,9 +176,35 @@ QNetworkReply* BlockchainInterface::getBlock(unsigned long number) {
     return reply;
 }
 
+void BlockchainInterface::setTransport(ApiCallback transport) { data->transport = std::move(transport); }
+
 // Getters
 BlockchainInterface::SyncStatus BlockchainInterface::syncStatus() const { return data->syncStatus; }
 QString BlockchainInterface::nodeUrl() const { return data->nodeUrl.toString(); }
+QStringList BlockchainInterface::nodeUrls() const {
+    QStringList result;
+    auto urls = data->nodes.urls();
+    std::transform(urls.begin(), urls.end(), std::back_inserter(result),
+                   [](const QUrl& url) { return url.toString(); });
+    return result;
+}
+QString BlockchainInterface::activeNodeUrl() const { return data->activeNode.toString(); }
+QVariantList BlockchainInterface::nodeStatistics() const { return data->nodes.describe(); }
+QVariantList BlockchainInterface::nodeRanking() const {
+    return data->prober == nullptr? QVariantList() : data->prober->describeRanking();
+}
+MetricsRegistry* BlockchainInterface::metrics() const { return data->metrics; }
+HttpTransport* BlockchainInterface::httpTransport() const { return data->http; }
+TableRegistry* BlockchainInterface::tableRegistry() const { return data->tableRegistry; }
+SharedTableCache* BlockchainInterface::sharedCache() const { return data->sharedCache; }
+QString BlockchainInterface::sharedCacheName() const {
+    return data->sharedCache == nullptr? QString() : data->sharedCache->name();
+}
+TrafficRecorder* BlockchainInterface::trafficRecorder() const { return data->recorder; }
+QString BlockchainInterface::trafficLogPath() const {
+    return data->recorder == nullptr? QString() : data->recorder->path();
+}
+qint64 BlockchainInterface::tableMemoryBudget() const { return data->tableRegistry->budget(); }
 QByteArray BlockchainInterface::headBlockId() const { return data->headBlockId; }
 unsigned long BlockchainInterface::headBlockNumber() const { return data->headBlockNumber; }
 unsigned long BlockchainInterface::irreversibleBlockNumber() const { return data->irreversibleBlockNumber; }
@@ -112,8 +220,66 @@ void BlockchainInterface::setNodeUrl(QString nodeUrl) {
     if (data->nodeUrl == url)
         return;
     data->nodeUrl = url;
+    rebuildNodePool();
     emit nodeUrlChanged(data->nodeUrl.toString());
 }
+void BlockchainInterface::setNodeUrls(QStringList nodeUrls) {
+    QList<QUrl> urls;
+    std::transform(nodeUrls.begin(), nodeUrls.end(), std::back_inserter(urls),
+                   [](const QString& url) { return QUrl::fromUserInput(url); });
+    auto primary = urls.isEmpty()? QUrl() : urls.takeFirst();
+    if (primary == data->nodeUrl && urls == data->extraNodeUrls)
+        return;
+
+    data->extraNodeUrls = urls;
+    if (primary != data->nodeUrl) {
+        // Changing the primary node reconnects, as it does when setting nodeUrl directly
+        setNodeUrl(primary.toString());
+    } else {
+        rebuildNodePool();
+    }
+    emit nodeUrlsChanged(this->nodeUrls());
+}
+void BlockchainInterface::probeNodes(QStringList candidates, int timeoutMsecs) {
+    QList<QUrl> urls;
+    std::transform(candidates.begin(), candidates.end(), std::back_inserter(urls),
+                   [](const QString& url) { return QUrl::fromUserInput(url); });
+
+    // Only a later probe's result matters now
+    if (data->prober != nullptr) {
+        data->prober->disconnect(this);
+        data->prober->deleteLater();
+    }
+    // A lone candidate may be on another chain, as that is how the user switches networks
+    auto expectedChainId = urls.size() > 1? data->chainId : QByteArray();
+    auto sendProbe = [this](const QUrl& node) { return makeCall(Strings::GetInfo, QByteArrayLiteral("{}"), node); };
+    auto prober = data->prober = new NodeProber(urls, expectedChainId, data->syncStaleSeconds, sendProbe, this);
+
+    connect(prober, &NodeProber::decided, this, [this](QUrl winner) {
+        emit nodeRankingChanged();
+        if (!winner.isEmpty()) {
+            // Setting the node already set doesn't connect, so connect to it explicitly if disconnected
+            bool reconnect = data->nodeUrl == winner && data->syncStatus == SyncStatus::Idle;
+            setNodeUrls({winner.toString()});
+            if (reconnect)
+                connectNow();
+        }
+        emit nodeProbeFinished(winner.toString());
+    });
+    connect(prober, &NodeProber::finished, this, [this, prober] {
+        emit nodeRankingChanged();
+        // Keep the other fresh candidates as fallbacks, unless the nodes have been changed since the winner was chosen
+        auto winner = prober->winner();
+        if (winner.isEmpty() || data->nodeUrl != winner || !data->extraNodeUrls.isEmpty())
+            return;
+        QStringList nodes{winner.toString()};
+        for (const auto& result : prober->ranking())
+            if (result.verdict == NodeProber::Verdict::Fresh && result.url != winner)
+                nodes.append(result.url.toString());
+        setNodeUrls(nodes);
+    });
+    prober->start(timeoutMsecs);
+}
 void BlockchainInterface::setSyncInterval(uint32_t syncRate) {
     if (data->syncInterval == syncRate)
         return;
@@ -124,6 +290,65 @@ void BlockchainInterface::setSyncStaleSeconds(uint32_t syncStaleSeconds) {
         return;
     emit syncStaleSecondsChanged(data->syncStaleSeconds = syncStaleSeconds);
 }
+void BlockchainInterface::setTableMemoryBudget(qint64 tableMemoryBudget) {
+    if (data->tableRegistry->budget() == tableMemoryBudget)
+        return;
+    data->tableRegistry->setBudget(tableMemoryBudget);
+    emit tableMemoryBudgetChanged(tableMemoryBudget);
+}
+void BlockchainInterface::setSharedCacheName(QString sharedCacheName) {
+    if (this->sharedCacheName() == sharedCacheName)
+        return;
+
+    bool wasReading = data->sharedCache != nullptr && data->sharedCache->isReader();
+    delete data->sharedCache;
+    data->sharedCache = nullptr;
+    if (!sharedCacheName.isEmpty()) {
+        auto cache = new SharedTableCache(sharedCacheName, this);
+        // When the cache's role changes, reading takes over from syncing, or syncing from reading
+        connect(cache, &SharedTableCache::roleChanged, this, [this, cache](SharedTableCache::Role role) {
+            // Opening the cache sets its first role, which calls for no change here
+            if (data->sharedCache == cache && role == SharedTableCache::Role::Publisher) {
+                // Start following the journal afresh; the first entries found will refresh the tables
+                data->lastJournalEntry = JournalEntry();
+                emit refreshAllTables();
+            }
+        });
+        if (cache->open()) {
+            data->sharedCache = cache;
+            if (data->pollingGroupTable != nullptr)
+                cache->addTable(data->pollingGroupTable);
+            for (auto* table : std::as_const(data->groupAccountsTables))
+                cache->addTable(table);
+        } else {
+            delete cache;
+        }
+    }
+    // Tables which were filled by the cache must load from the node now
+    if (wasReading && (data->sharedCache == nullptr || !data->sharedCache->isReader())) {
+        data->lastJournalEntry = JournalEntry();
+        emit refreshAllTables();
+    }
+    emit sharedCacheNameChanged(this->sharedCacheName());
+}
+void BlockchainInterface::setTrafficLogPath(QString trafficLogPath) {
+    if (this->trafficLogPath() == trafficLogPath)
+        return;
+
+    // Calls in flight to the old recorder are left out of both logs
+    delete data->recorder;
+    data->recorder = nullptr;
+    if (!trafficLogPath.isEmpty()) {
+        auto recorder = new TrafficRecorder(trafficLogPath, this);
+        if (recorder->open()) {
+            qInfo() << "BlockchainInterface: Recording API traffic to" << trafficLogPath;
+            data->recorder = recorder;
+        } else {
+            delete recorder;
+        }
+    }
+    emit trafficLogPathChanged(this->trafficLogPath());
+}
 
 
 // Business logic
@@ -164,7 +389,17 @@ void BlockchainInterface::submitTransaction(BroadcastableTransaction* transactio
         return;
     }
 
-    auto reply = makeCall("/v1/chain/push_transaction", QJsonDocument(transaction->json()).toJson());
+    // Broadcast each transaction through a single node, so a rebroadcast never races a copy sent through another
+    // node. Only if that node has left the pool, or been found on another chain, does the transaction move.
+    auto node = transaction->property("pinned-node").toUrl();
+    if (node.isEmpty() || data->nodes.indexOf(node) == -1 || data->nodes.isExcluded(node)) {
+        if (!node.isEmpty())
+            qInfo() << "BlockchainInterface: Node" << node << "is no longer usable; moving transaction to another node";
+        node = selectNode();
+        transaction->setProperty("pinned-node", node);
+    }
+
+    auto reply = makeCall("/v1/chain/push_transaction", QJsonDocument(transaction->json()).toJson(), node);
     connect(reply, &QNetworkReply::finished,
             [transaction, reply] { transaction->broadcastFinished(reply->readAll()); });
 }
@@ -174,6 +409,10 @@ void BlockchainInterface::beginSync() {
     connect(reply, &QNetworkReply::finished, [this, reply] { processInfoReply(reply); });
     connectNetworkReply(reply);
 
+    // Tables filled from a shared cache are kept current by its publisher, which follows the journal for them
+    if (data->sharedCache != nullptr && data->sharedCache->isReader())
+        return;
+
     // Have we already connected and processed journal entries?
     if (data->lastJournalEntry.isValid())
         // Yes, so get all entries after the last we've seen
@@ -193,18 +432,34 @@ void BlockchainInterface::processInfoReply(QNetworkReply* reply) {
         return;
 
     // Sanity check response
+    auto node = reply->property("node-url").toUrl();
     auto jsonDoc = QJsonDocument::fromJson(reply->readAll());
     QJsonObject response;
     // Check JSON is an object and assign it to response while checking the object contains a "head_block_id" field
     if (!jsonDoc.isObject() || !(response = jsonDoc.object()).contains(Strings::HeadBlockId)) {
         qWarning() << "BlockchainInterface: Error: get_info response not sensible:" << jsonDoc;
+        data->nodes.recordFailure(node);
         emit nodeResponseNonsense();
         updateSyncStatus(SyncStatus::RecoveringConnection);
         return;
     }
 
-    // Update properties
+    // A node on a different chain than the one we're synced to must never serve us; a single configured node is
+    // allowed to change chains, though, as that is how the user switches networks
     auto chainId = response[Strings::ChainId].toString().toLocal8Bit();
+    if (!data->chainId.isEmpty() && chainId != data->chainId && data->nodes.size() > 1) {
+        qWarning() << "BlockchainInterface: Node" << node << "is on chain" << chainId << "rather than"
+                   << data->chainId << "-- ignoring it";
+        data->nodes.recordFailure(node);
+        data->nodes.exclude(node);
+        if (node == data->activeNode) {
+            data->activeNode.clear();
+            selectNode();
+        }
+        return;
+    }
+
+    // Update properties
     if (chainId != data->chainId)
         emit chainIdChanged(data->chainId = chainId);
     data->headBlockId = response[Strings::HeadBlockId].toString().toLocal8Bit();
@@ -213,6 +468,82 @@ void BlockchainInterface::processInfoReply(QNetworkReply* reply) {
     data->headBlockTime = QDateTime::fromString(response[Strings::HeadBlockTime].toString(), Qt::DateFormat::ISODate);
     data->headBlockTime.setTimeZone(QTimeZone::utc());
     emit headBlockChanged();
+
+    if (data->headBlockNumber >= data->latestHeadNumber && data->headBlockTime.isValid()) {
+        data->latestHeadNumber = data->headBlockNumber;
+        data->latestHeadTime = data->headBlockTime;
+    }
+    checkForFork(node, response[Strings::LastIrreversibleBlockId].toString().toLocal8Bit());
+}
+
+void BlockchainInterface::checkForFork(const QUrl& node, const QByteArray& irreversibleBlockId) {
+    // A node reporting a different block at a number we saw before means a fork replaced that block. Only the head
+    // and irreversible blocks are reported, but every block we saw at the head is checked when it becomes irreversible.
+    auto replaced = [this](unsigned long number, const QByteArray& id) {
+        auto seen = data->reversibleBlocks.constFind(number);
+        return !id.isEmpty() && seen != data->reversibleBlocks.constEnd() && seen->id != id;
+    };
+    if (replaced(data->headBlockNumber, data->headBlockId) ||
+            replaced(data->irreversibleBlockNumber, irreversibleBlockId)) {
+        // Which of the blocks since the last irreversible one were reverted isn't known, so revert them all
+        auto firstReverted = data->settledBlock + 1;
+        qWarning() << "BlockchainInterface: Node" << node << "reports a fork; reverting changes since block"
+                   << firstReverted;
+        data->reversibleBlocks.clear();
+        // Follow the journal again from the first entry that may be from a reverted block. Only the ID of the last
+        // entry matters for following the journal, so stand in for the entry before it with a copy of it.
+        if (!data->reversibleJournal.isEmpty()) {
+            data->lastJournalEntry = data->reversibleJournal.first();
+            data->lastJournalEntry.id -= 1;
+            for (const auto& entry : data->reversibleJournal)
+                data->revertedJournal.insert(entry.id, entry);
+            data->lastRevertedEntry = data->reversibleJournal.last().id;
+            data->reversibleJournal.clear();
+        }
+        emit chainForked(firstReverted);
+    }
+
+    if (data->headBlockNumber > data->irreversibleBlockNumber)
+        data->reversibleBlocks.insert(data->headBlockNumber, {data->headBlockId, data->headBlockTime});
+    if (data->irreversibleBlockNumber > data->settledBlock) {
+        data->settledBlock = data->irreversibleBlockNumber;
+        auto settled = data->reversibleBlocks.upperBound(data->settledBlock);
+        // Any block seen at or before the settled one is no later than it, so its time can stand in for the settled
+        // block's time to settle entries conservatively
+        if (settled != data->reversibleBlocks.begin())
+            data->settledBlockTime = std::prev(settled)->time;
+        data->reversibleBlocks.erase(data->reversibleBlocks.begin(), settled);
+        // Entries are tagged in order, so the settled ones are at the front
+        auto unsettled = std::find_if(data->reversibleJournal.begin(), data->reversibleJournal.end(),
+                                      [this](const JournalEntry& e) { return e.blockNumber > data->settledBlock; });
+        data->reversibleJournal.erase(data->reversibleJournal.begin(), unsettled);
+        emit irreversibleBlockChanged(data->settledBlock);
+    }
+}
+
+uint64_t BlockchainInterface::latestBlockAt(QDateTime timestamp) const {
+    if (!timestamp.isValid() || !data->latestHeadTime.isValid())
+        return 0;
+    // The journal may stamp entries to the second, so allow for the block being up to a second later
+    timestamp = timestamp.addMSecs(999);
+
+    // Blocks are numbered in time order, so the change is in the first block seen stamped at or after its time, or in
+    // a block before that
+    if (data->settledBlockTime.isValid() && timestamp <= data->settledBlockTime)
+        return data->settledBlock;
+    auto seen = std::find_if(data->reversibleBlocks.cbegin(), data->reversibleBlocks.cend(),
+                             [&timestamp](const auto& block) { return block.time >= timestamp; });
+    if (seen != data->reversibleBlocks.cend())
+        return seen.key();
+    // Newer than any block seen, and at most one block is produced every half second
+    return data->latestHeadNumber + std::max<qint64>(0, data->latestHeadTime.msecsTo(timestamp)) / 500;
+}
+
+void BlockchainInterface::connectTable(AbstractTableInterface* table) {
+    connect(this, &BlockchainInterface::refreshAllTables, table, &AbstractTableInterface::fullRefresh);
+    connect(this, &BlockchainInterface::irreversibleBlockChanged, table, &AbstractTableInterface::settleIrreversible);
+    connect(this, &BlockchainInterface::chainForked, table, &AbstractTableInterface::rollBackFork);
+    table->settleIrreversible(data->settledBlock);
 }
 
 void BlockchainInterface::processJournalReply(QNetworkReply* reply) {
@@ -235,6 +566,23 @@ void BlockchainInterface::processJournalReply(QNetworkReply* reply) {
         // No news
         return;
     auto entries = JournalEntry::fromJsonArray(rows.value());
+    // The journal doesn't say which block an entry is from, so tag each entry with the latest block it may be from, by
+    // its timestamp; its change is then reverted by any fork that could have reverted it, and settled once none can
+    for (auto& entry : entries) {
+        entry.blockNumber = latestBlockAt(entry.timestamp);
+        if (entry.blockNumber > data->settledBlock)
+            data->reversibleJournal.append(entry);
+    }
+    if (!data->revertedJournal.isEmpty()) {
+        // Entries read again after a fork which make the same changes as entries reverted by it are replays: the
+        // tables reloaded their rows when rolling back, so the entries need only be noted as reversible again
+        for (auto& entry : entries) {
+            auto reverted = data->revertedJournal.constFind(entry.id);
+            entry.replayed = reverted != data->revertedJournal.constEnd() && reverted->isSameChange(entry);
+        }
+        if (entries.last().id >= data->lastRevertedEntry)
+            data->revertedJournal.clear();
+    }
 
     // If we've been syncing the journal, notify of these new entries
     if (data->lastJournalEntry.isValid() && entries.first().id == data->lastJournalEntry.id + 1)
@@ -249,25 +597,50 @@ void BlockchainInterface::processJournalReply(QNetworkReply* reply) {
     qInfo() << "BlockchainInterface: Synchronized journal through entry" << data->lastJournalEntry.id;
 }
 
-QNetworkReply* BlockchainInterface::makeCall(QString apiPath, QByteArray json) {
-    // Create request and set headers
-    QNetworkRequest request(data->nodeUrl.toString() + apiPath);
-    request.setHeader(QNetworkRequest::UserAgentHeader, QByteArrayLiteral("Pollaris Alpha"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArrayLiteral("application/json"));
-    request.setHeader(QNetworkRequest::ContentLengthHeader, json.length());
+QNetworkReply* BlockchainInterface::makeCall(QString apiPath, QByteArray json, QUrl node) {
+    if (node.isEmpty())
+        node = selectNode();
+    // If every node has been excluded, there's nowhere to send the call, so fail it rather than post it nowhere
+    if (!node.isValid() && !data->transport) {
+        qWarning() << "BlockchainInterface: No usable node to send" << apiPath
+                   << "to; every node is on another chain. Configure a node on chain" << data->chainId;
+        return new CannedReply({}, 0, this);
+    }
 
     // POST the request
-    auto* reply = data->network->post(request, json);
+    auto endpoint = MetricsRegistry::endpointName(apiPath, json);
+    auto metricsToken = data->metrics->requestStarted(endpoint, json.size());
+    auto* reply = data->transport? data->transport(apiPath, json) : data->http->post(node, apiPath, json);
     reply->setProperty("request-content", json);
+    reply->setProperty("node-url", node);
     reply->setProperty("time-sent", QDateTime::currentMSecsSinceEpoch());
+    QPointer<TrafficRecorder> recorder = data->recorder;
+    auto recordedSent = recorder.isNull()? 0 : recorder->elapsed();
 
     // Schedule RTT recording immediately so it's the first slot to run
-    QObject::connect(reply, &QNetworkReply::finished, [this, reply] {
+    QObject::connect(reply, &QNetworkReply::finished,
+                     [this, reply, node, endpoint, metricsToken, apiPath, json, recorder, recordedSent] {
+        // Nothing has read the reply yet, so everything the node sent is still available
+        auto received = reply->bytesAvailable();
+        auto* decoded = qobject_cast<DecodedReply*>(reply);
+        data->metrics->requestFinished(endpoint, metricsToken, received, decoded? decoded->wireBytes() : received,
+                                       reply->error() != QNetworkReply::NoError);
+        if (!recorder.isNull() && recorder == data->recorder)
+            recorder->record(apiPath, node, json, reply, recordedSent);
+
+        if (reply->error() != QNetworkReply::NoError) {
+            // If the node never gave an HTTP response, it's unreachable rather than merely unhappy with a request
+            auto httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+            data->nodes.recordFailure(node, !httpStatus.isValid());
+            return;
+        }
+
         auto now = QDateTime::currentMSecsSinceEpoch();
         auto timeSent = reply->property("time-sent");
         if (!timeSent.isNull()) {
             auto rtt = now - timeSent.toULongLong();
             reply->setProperty("rtt", rtt);
+            data->nodes.recordSuccess(node, rtt);
             if (rtt != data->serverLatency)
                 emit serverLatencyChanged(data->serverLatency = rtt);
         }
@@ -275,8 +648,46 @@ QNetworkReply* BlockchainInterface::makeCall(QString apiPath, QByteArray json) {
     return reply;
 }
 
+QUrl BlockchainInterface::selectNode() {
+    auto index = data->nodes.select();
+    // If every node in the pool is on another chain, there's nowhere to send the call
+    if (index == -1)
+        return data->nodes.isEmpty()? data->nodeUrl : QUrl();
+
+    auto node = data->nodes.node(index).url;
+    if (node != data->activeNode) {
+        if (!data->activeNode.isEmpty())
+            qInfo() << "BlockchainInterface: Switching reads from node" << data->activeNode << "to" << node;
+        data->activeNode = node;
+        // Most calls will go to this node now, so have a connection to it ready
+        if (!data->transport)
+            data->http->warmUp(node);
+        emit activeNodeUrlChanged(node.toString());
+    }
+    return node;
+}
+
+void BlockchainInterface::rebuildNodePool() {
+    QList<QUrl> urls;
+    if (!data->nodeUrl.isEmpty())
+        urls.append(data->nodeUrl);
+    urls.append(data->extraNodeUrls);
+    data->nodes.setUrls(urls);
+
+    // Failing over between nodes leaves the journal position and table caches untouched, but if the active node was
+    // removed from the pool, pick a new one now
+    if (data->nodes.indexOf(data->activeNode) == -1) {
+        data->activeNode.clear();
+        selectNode();
+    }
+}
+
 ApiCallback BlockchainInterface::makeApiCaller() {
-    return [this](QString apiPath, QByteArray json) {
+    return [this](QString apiPath, QByteArray json) -> QNetworkReply* {
+        // Tables filled from a shared cache don't load from the node; their requests find nothing, and the rows come
+        // from the cache instead
+        if (data->sharedCache != nullptr && data->sharedCache->isReader() && apiPath == Strings::GetTableRows)
+            return new CannedReply(QByteArrayLiteral("{\"rows\":[],\"more\":false}"), 200, this);
         auto reply = makeCall(apiPath, json);
         connectNetworkReply(reply);
         return reply;
@@ -3,6 +3,7 @@
 #include <AbstractTableInterface.hpp>
 #include <MutableTransaction.hpp>
 #include <BroadcastableTransaction.hpp>
+#include <Metrics.hpp>
 
 #include <QObject>
 #include <QUrl>
@@ -10,6 +11,11 @@
 #include <QMetaEnum>
 
 class BlockchainInterface_Private;
+class TableRegistry;
+class SharedTableCache;
+class NodeProber;
+class TrafficRecorder;
+class HttpTransport;
 
 class BlockchainInterface : public QObject {
     Q_OBJECT
@@ -19,9 +25,17 @@ class BlockchainInterface : public QObject {
 
     // Configuration properties (writeable)
     Q_PROPERTY(QString nodeUrl READ nodeUrl WRITE setNodeUrl NOTIFY nodeUrlChanged)
+    Q_PROPERTY(QStringList nodeUrls READ nodeUrls WRITE setNodeUrls NOTIFY nodeUrlsChanged)
     Q_PROPERTY(quint32 syncInterval READ syncInterval WRITE setSyncInterval NOTIFY syncIntervalChanged)
+    //! \property tableMemoryBudget Approximate bytes that tables no longer in view may use before being evicted
+    Q_PROPERTY(qint64 tableMemoryBudget READ tableMemoryBudget WRITE setTableMemoryBudget
+               NOTIFY tableMemoryBudgetChanged)
     Q_PROPERTY(quint32 syncStaleSeconds READ syncStaleSeconds WRITE setSyncStaleSeconds
                NOTIFY syncStaleSecondsChanged)
+    //! \property sharedCacheName Name of the cache to share tables through with other processes; empty for none
+    Q_PROPERTY(QString sharedCacheName READ sharedCacheName WRITE setSharedCacheName NOTIFY sharedCacheNameChanged)
+    //! \property trafficLogPath File to record the node API traffic to, for replay; empty for none
+    Q_PROPERTY(QString trafficLogPath READ trafficLogPath WRITE setTrafficLogPath NOTIFY trafficLogPathChanged)
 
     // Status properties (read-only)
     Q_PROPERTY(SyncStatus syncStatus READ syncStatus NOTIFY syncStatusChanged)
@@ -32,6 +46,11 @@ class BlockchainInterface : public QObject {
     Q_PROPERTY(unsigned long irreversibleBlockNumber READ irreversibleBlockNumber NOTIFY headBlockChanged)
     Q_PROPERTY(QDateTime headBlockTime READ headBlockTime NOTIFY headBlockChanged)
     Q_PROPERTY(quint64 serverLatency READ serverLatency NOTIFY serverLatencyChanged)
+    Q_PROPERTY(QString activeNodeUrl READ activeNodeUrl NOTIFY activeNodeUrlChanged)
+    Q_PROPERTY(QVariantList nodeStatistics READ nodeStatistics NOTIFY serverLatencyChanged)
+    //! \property nodeRanking Candidates of the last probeNodes call, best first, with the outcome of probing each
+    Q_PROPERTY(QVariantList nodeRanking READ nodeRanking NOTIFY nodeRankingChanged)
+    Q_PROPERTY(MetricsRegistry* metrics READ metrics CONSTANT)
 
 public:
     /*!
@@ -68,9 +87,30 @@ public:
 
     Q_INVOKABLE QNetworkReply* getBlock(unsigned long number);
 
+    /*!
+     * \brief Replace the network with another transport for all API calls
+     * \param transport Callback to send an API call and return its reply, or an empty callback to use the network
+     *
+     * All calls, including those made by tables, go through the transport, and are tracked in metrics and node
+     * statistics as though they had been sent to the selected node. Used to run against canned or recorded traffic.
+     */
+    void setTransport(ApiCallback transport);
+
     SyncStatus syncStatus() const;
     QString syncStatusString() const { return QMetaEnum::fromType<SyncStatus>().valueToKey(int(syncStatus())); }
     QString nodeUrl() const;
+    QStringList nodeUrls() const;
+    QString activeNodeUrl() const;
+    QVariantList nodeStatistics() const;
+    QVariantList nodeRanking() const;
+    MetricsRegistry* metrics() const;
+    HttpTransport* httpTransport() const;
+    TableRegistry* tableRegistry() const;
+    qint64 tableMemoryBudget() const;
+    SharedTableCache* sharedCache() const;
+    QString sharedCacheName() const;
+    TrafficRecorder* trafficRecorder() const;
+    QString trafficLogPath() const;
     QByteArray headBlockId() const;
     unsigned long headBlockNumber() const;
     unsigned long irreversibleBlockNumber() const;
@@ -82,8 +122,46 @@ public:
 
 public slots:
     void setNodeUrl(QString nodeUrl);
+    /*!
+     * \brief Set the full list of nodes to use
+     * \param nodeUrls The nodes to use; the first becomes nodeUrl, and the rest are used alongside it
+     *
+     * Reads are sent to whichever node in the list is currently fastest and healthy, and traffic fails over to the
+     * other nodes automatically if one stops responding. Setting nodeUrl alone replaces only the first node.
+     */
+    void setNodeUrls(QStringList nodeUrls);
+    /*!
+     * \brief Find the best of several candidate nodes and connect to it
+     * \param candidates The nodes to choose from
+     * \param timeoutMsecs Time to wait for the candidates to answer
+     *
+     * All candidates are asked for their chain info at once, and the first to answer sensibly with a fresh head block
+     * becomes the node, just as though nodeUrls had been set to it; see \ref NodeProber. When several candidates are
+     * given, they must be on the chain already connected to, if any. nodeProbeFinished is emitted with the chosen node,
+     * or with an empty URL if none was usable, in which case nodeRanking says why. Once every candidate has answered,
+     * the others with fresh head blocks join the node pool as fallbacks.
+     */
+    void probeNodes(QStringList candidates, int timeoutMsecs = 10000);
     void setSyncInterval(uint32_t syncRate);
     void setSyncStaleSeconds(uint32_t syncStaleSeconds);
+    void setTableMemoryBudget(qint64 tableMemoryBudget);
+    /*!
+     * \brief Share tables with the other processes on this machine using the same cache name
+     * \param sharedCacheName The name of the cache, or empty to stop sharing
+     *
+     * One process sharing a cache syncs its tables with the node and publishes them; the rest fill their tables from
+     * the cache instead of the node. See \ref SharedTableCache. Sharing can also be enabled by setting the
+     * environment variable POLLARIS_SHARED_CACHE to the cache name.
+     */
+    void setSharedCacheName(QString sharedCacheName);
+    /*!
+     * \brief Record every API call and its response, with their timing, to a file
+     * \param trafficLogPath The file to record to, which is replaced, or empty to stop recording
+     *
+     * The log can be replayed with \ref TrafficReplayer to reproduce the session without the node. Recording can also
+     * be enabled by setting the environment variable POLLARIS_RECORD_TRAFFIC to the file to record to.
+     */
+    void setTrafficLogPath(QString trafficLogPath);
 
     void disconnect();
     void connectNow();
@@ -94,11 +172,20 @@ signals:
     // Property change signals
     void syncStatusChanged(SyncStatus syncStatus);
     void nodeUrlChanged(QString nodeUrl);
+    void nodeUrlsChanged(QStringList nodeUrls);
+    void activeNodeUrlChanged(QString activeNodeUrl);
     void chainIdChanged(QByteArray chainId);
     void headBlockChanged();
     void syncIntervalChanged(uint32_t syncInterval);
     void syncStaleSecondsChanged(uint32_t syncStaleSeconds);
+    void tableMemoryBudgetChanged(qint64 tableMemoryBudget);
+    void sharedCacheNameChanged(QString sharedCacheName);
+    void trafficLogPathChanged(QString trafficLogPath);
     void serverLatencyChanged(quint64 serverLatency);
+    void nodeRankingChanged();
+
+    // Signal that probeNodes has chosen a node, or found none usable if nodeUrl is empty
+    void nodeProbeFinished(QString nodeUrl);
 
     // Signal that node returned an error; errorCode will be an HTTP status, or -1 for protocol unknown, -2 for
     // connection refused, 0 for some other non-HTTP error
@@ -109,12 +196,21 @@ signals:
     // Signals to tables to refresh their data
     void newJournalEntries(QList<JournalEntry> entries);
     void refreshAllTables();
+    // Signal that changes made in irreversibleBlock or before can no longer be reverted
+    void irreversibleBlockChanged(quint64 irreversibleBlock);
+    // Signal that a fork reverted blocks, and changes made in firstRevertedBlock or after must be undone
+    void chainForked(quint64 firstRevertedBlock);
 
 private:
     void beginSync();
     void processInfoReply(QNetworkReply* reply);
     void processJournalReply(QNetworkReply* reply);
-    QNetworkReply* makeCall(QString apiPath, QByteArray json = QByteArrayLiteral("{}"));
+    void checkForFork(const QUrl& node, const QByteArray& irreversibleBlockId);
+    uint64_t latestBlockAt(QDateTime timestamp) const;
+    void connectTable(AbstractTableInterface* table);
+    QNetworkReply* makeCall(QString apiPath, QByteArray json = QByteArrayLiteral("{}"), QUrl node = QUrl());
+    QUrl selectNode();
+    void rebuildNodePool();
     ApiCallback makeApiCaller();
     void connectNetworkReply(QNetworkReply* reply);
     void updateSyncStatus(SyncStatus status);
@@ -0,0 +1,57 @@
+#include <CannedReply.hpp>
+
+#include <QTimer>
+
+#include <cstring>
+
+CannedReply::CannedReply(QByteArray content, int httpStatus, QObject* parent, int delayMsecs)
+    : QNetworkReply(parent), content(std::move(content)) {
+    setOperation(QNetworkAccessManager::PostOperation);
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    QTimer::singleShot(std::max(0, delayMsecs), Qt::PreciseTimer, this, [this, httpStatus] { deliver(httpStatus); });
+}
+
+CannedReply::~CannedReply() {}
+
+void CannedReply::abort() {
+    if (isFinished())
+        return;
+    content.clear();
+    offset = 0;
+    setError(OperationCanceledError, QStringLiteral("Operation canceled"));
+    setFinished(true);
+    emit errorOccurred(OperationCanceledError);
+    emit finished();
+}
+
+qint64 CannedReply::readData(char* data, qint64 maxSize) {
+    auto count = std::min(maxSize, content.size() - offset);
+    if (count <= 0)
+        return isFinished()? -1 : 0;
+    std::memcpy(data, content.constData() + offset, count);
+    offset += count;
+    return count;
+}
+
+void CannedReply::deliver(int httpStatus) {
+    if (isFinished())
+        return;
+
+    if (httpStatus != 0) {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, httpStatus);
+        setHeader(QNetworkRequest::ContentTypeHeader, QByteArrayLiteral("application/json"));
+        setHeader(QNetworkRequest::ContentLengthHeader, content.size());
+        emit metaDataChanged();
+    }
+    if (httpStatus == 0)
+        setError(ConnectionRefusedError, QStringLiteral("Connection refused"));
+    else if (httpStatus < 200 || httpStatus >= 300)
+        setError(InternalServerError, QStringLiteral("HTTP status %1").arg(httpStatus));
+    setFinished(true);
+
+    if (!content.isEmpty())
+        emit readyRead();
+    if (error() != NoError)
+        emit errorOccurred(error());
+    emit finished();
+}
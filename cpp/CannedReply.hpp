@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QNetworkReply>
+
+/*!
+ * \brief A QNetworkReply which serves a fixed response without touching the network
+ *
+ * The reply finishes on the next pass of the event loop, or after a given delay, so callers can connect to its signals
+ * after receiving it, just as with a reply from QNetworkAccessManager. Used to substitute a transport for the node
+ * API, as in \ref BlockchainInterface::setTransport.
+ */
+class CannedReply : public QNetworkReply {
+    Q_OBJECT
+
+    QByteArray content;
+    qint64 offset = 0;
+
+public:
+    /*!
+     * \brief Create a reply
+     * \param content The body of the response
+     * \param httpStatus The HTTP status of the response; a status other than 2xx makes the reply fail with
+     * QNetworkReply::InternalServerError, and 0 makes it fail with QNetworkReply::ConnectionRefusedError
+     * \param delayMsecs Time to wait before finishing, as a node's response time would
+     */
+    explicit CannedReply(QByteArray content, int httpStatus = 200, QObject* parent = nullptr, int delayMsecs = 0);
+    virtual ~CannedReply();
+
+    void abort() override;
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return content.size() - offset + QIODevice::bytesAvailable(); }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+
+private:
+    void deliver(int httpStatus);
+};
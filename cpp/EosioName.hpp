@@ -1,6 +1,12 @@
 #pragma once
 
 #include <QString>
+#include <QDataStream>
+#include <QDebug>
+#include <QHash>
+#include <QMetaType>
+
+#include <string_view>
 
 // This code adapted from eosio, to convert name strings to and from integers
 namespace eosio {
@@ -30,6 +36,17 @@ inline static uint64_t string_to_uint64_t(QString str) {
     return n;
 }
 
+// As above, for names still in the UTF-8 text they arrived in
+inline static uint64_t string_to_uint64_t(std::string_view str) {
+    uint64_t n = 0;
+    size_t i;
+    for (i = 0; i < str.length() && i < 12; ++i)
+        n |= (char_to_symbol(str[i]) & 0x1f) << (64 - 5 * (i + 1));
+    if (i == 12 && str.length() > 12)
+        n |= char_to_symbol(str[12]) & 0x0F;
+    return n;
+}
+
 inline static QString name_to_string(uint64_t name) {
     static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
 
@@ -46,3 +63,37 @@ inline static QString name_to_string(uint64_t name) {
     return str;
 }
 } // namespace eosio
+
+/*!
+ * \brief An eosio name, such as an account name, held in its 64-bit encoding
+ *
+ * Names compare, sort and hash as integers, which orders them as the chain orders them. They are only converted to
+ * strings to be displayed, or when they are handed to QML.
+ */
+class EosioName {
+    uint64_t encoded = 0;
+
+public:
+    EosioName() = default;
+    explicit EosioName(uint64_t value) : encoded(value) {}
+    explicit EosioName(const QString& name) : encoded(eosio::string_to_uint64_t(name)) {}
+
+    uint64_t value() const { return encoded; }
+    QString toString() const { return eosio::name_to_string(encoded); }
+    bool isEmpty() const { return encoded == 0; }
+
+    bool operator==(EosioName other) const { return encoded == other.encoded; }
+    bool operator!=(EosioName other) const { return encoded != other.encoded; }
+    bool operator<(EosioName other) const { return encoded < other.encoded; }
+};
+Q_DECLARE_METATYPE(EosioName)
+
+inline size_t qHash(EosioName name, size_t seed = 0) { return qHash(quint64(name.value()), seed); }
+inline QDebug operator<<(QDebug debug, EosioName name) { return debug << name.toString(); }
+inline QDataStream& operator<<(QDataStream& stream, EosioName name) { return stream << quint64(name.value()); }
+inline QDataStream& operator>>(QDataStream& stream, EosioName& name) {
+    quint64 value = 0;
+    stream >> value;
+    name = EosioName(value);
+    return stream;
+}
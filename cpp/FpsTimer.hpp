@@ -3,6 +3,8 @@
 #include <QTimer>
 #include <QDebug>
 
+#include <chrono>
+
 class FpsTimer : public QObject {
     Q_OBJECT
 
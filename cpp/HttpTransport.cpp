@@ -0,0 +1,215 @@
+#include <HttpTransport.hpp>
+
+#include <QDebug>
+#include <QSslConfiguration>
+
+#include <zlib.h>
+
+#include <cstring>
+
+DecodedReply::DecodedReply(QNetworkReply* raw, QObject* parent) : QNetworkReply(parent), raw(raw) {
+    raw->setParent(this);
+    setRequest(raw->request());
+    setUrl(raw->url());
+    setOperation(raw->operation());
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    connect(raw, &QNetworkReply::metaDataChanged, this, [this] {
+        copyMetaData();
+        emit metaDataChanged();
+    });
+    connect(raw, &QNetworkReply::readyRead, this, &DecodedReply::receive);
+    connect(raw, &QNetworkReply::finished, this, &DecodedReply::finish);
+    connect(raw, &QNetworkReply::uploadProgress, this, &QNetworkReply::uploadProgress);
+}
+
+DecodedReply::~DecodedReply() {
+    if (inflater)
+        inflateEnd(inflater.get());
+}
+
+void DecodedReply::abort() {
+    if (isFinished())
+        return;
+    raw->abort();
+    // The network reply finishes as it aborts, but in case it didn't, finish now
+    if (!isFinished()) {
+        setError(OperationCanceledError, QStringLiteral("Operation canceled"));
+        setFinished(true);
+        emit errorOccurred(OperationCanceledError);
+        emit finished();
+    }
+}
+
+qint64 DecodedReply::readData(char* data, qint64 maxSize) {
+    auto count = std::min(maxSize, content.size() - offset);
+    if (count <= 0)
+        return isFinished()? -1 : 0;
+    std::memcpy(data, content.constData() + offset, count);
+    offset += count;
+    if (offset == content.size()) {
+        content.clear();
+        offset = 0;
+    }
+    return count;
+}
+
+void DecodedReply::copyMetaData() {
+    for (auto attribute : {QNetworkRequest::HttpStatusCodeAttribute, QNetworkRequest::HttpReasonPhraseAttribute,
+                           QNetworkRequest::Http2WasUsedAttribute, QNetworkRequest::ConnectionEncryptedAttribute})
+        setAttribute(attribute, raw->attribute(attribute));
+
+    auto encoding = raw->rawHeader("Content-Encoding").trimmed().toLower();
+    bool encoded = !encoding.isEmpty() && encoding != "identity";
+    for (const auto& header : raw->rawHeaderPairs()) {
+        auto name = header.first.toLower();
+        if (name != "content-encoding" && (name != "content-length" || !encoded))
+            setRawHeader(header.first, header.second);
+    }
+
+    if (!encoded || inflater || decodeFailed)
+        return;
+    if (encoding != "gzip" && encoding != "x-gzip" && encoding != "deflate") {
+        qWarning() << "DecodedReply: Node at" << url() << "sent a response with unsupported encoding" << encoding;
+        decodeFailed = true;
+        return;
+    }
+    // Adding 32 to the window size makes zlib detect the gzip or zlib header, which covers both encodings
+    inflater = std::make_unique<z_stream>();
+    if (inflateInit2(inflater.get(), MAX_WBITS + 32) != Z_OK) {
+        qWarning() << "DecodedReply: Unable to start decoding response:" << inflater->msg;
+        inflater.reset();
+        decodeFailed = true;
+    }
+}
+
+void DecodedReply::receive() {
+    auto chunk = raw->readAll();
+    if (chunk.isEmpty())
+        return;
+    wireCount += chunk.size();
+    if (decodeFailed)
+        return;
+
+    auto before = decodedCount;
+    if (!decode(chunk, false))
+        decodeFailed = true;
+    if (decodedCount > before)
+        emit readyRead();
+}
+
+void DecodedReply::finish() {
+    if (isFinished())
+        return;
+
+    copyMetaData();
+    receive();
+    if (raw->error() == NoError && !decodeFailed && !decode({}, true))
+        decodeFailed = true;
+    if (attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid())
+        setHeader(QNetworkRequest::ContentLengthHeader, decodedCount);
+
+    if (raw->error() != NoError)
+        setError(raw->error(), raw->errorString());
+    else if (decodeFailed)
+        setError(ProtocolFailure, QStringLiteral("Unable to decode the response"));
+    setFinished(true);
+
+    if (error() != NoError)
+        emit errorOccurred(error());
+    emit finished();
+}
+
+bool DecodedReply::decode(const QByteArray& chunk, bool last) {
+    if (!inflater) {
+        content += chunk;
+        decodedCount += chunk.size();
+        return true;
+    }
+
+    char buffer[16384];
+    inflater->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(chunk.constData()));
+    inflater->avail_in = uInt(chunk.size());
+    while (!streamEnded) {
+        inflater->next_out = reinterpret_cast<Bytef*>(buffer);
+        inflater->avail_out = sizeof(buffer);
+        auto result = inflate(inflater.get(), Z_NO_FLUSH);
+        if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+            qWarning() << "DecodedReply: Unable to decode response from" << url() << ":" << inflater->msg;
+            return false;
+        }
+
+        auto produced = qint64(sizeof(buffer) - inflater->avail_out);
+        content.append(buffer, produced);
+        decodedCount += produced;
+        if (result == Z_STREAM_END)
+            streamEnded = true;
+        // Stop once the input is used up, unless the output filled up and there may be more waiting in the inflater
+        else if (result == Z_BUF_ERROR || (inflater->avail_in == 0 && inflater->avail_out != 0))
+            break;
+    }
+
+    // A compressed body cut short leaves the stream unfinished
+    if (last && !streamEnded && wireCount > 0) {
+        qWarning() << "DecodedReply: Response from" << url() << "ended before its compressed stream did";
+        return false;
+    }
+    return true;
+}
+
+HttpTransport::HttpTransport(QObject* parent) : QObject(parent), network(new QNetworkAccessManager(this)) {}
+
+HttpTransport::~HttpTransport() {}
+
+const QNetworkRequest& HttpTransport::requestTemplate(const QUrl& node, const QString& apiPath) {
+    auto key = node.toString() + apiPath;
+    auto itr = requestTemplates.find(key);
+    if (itr != requestTemplates.end())
+        return *itr;
+
+    QNetworkRequest request(key);
+    request.setHeader(QNetworkRequest::UserAgentHeader, QByteArrayLiteral("Pollaris Alpha"));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArrayLiteral("application/json"));
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    // Setting Accept-Encoding ourselves stops Qt decoding the response, which would hide its size on the wire
+    request.setRawHeader("Accept-Encoding", compression? QByteArrayLiteral("gzip, deflate")
+                                                       : QByteArrayLiteral("identity"));
+    return *requestTemplates.insert(key, request);
+}
+
+QNetworkReply* HttpTransport::post(const QUrl& node, const QString& apiPath, const QByteArray& json) {
+    // Qt sets Content-Length from the body, so the template is sent as is
+    auto* reply = network->post(requestTemplate(node, apiPath), json);
+
+    auto nodeName = node.toString();
+    if (!http2Nodes.contains(nodeName))
+        connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply, nodeName] {
+            if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool() && !http2Nodes.contains(nodeName)) {
+                http2Nodes.insert(nodeName);
+                qInfo() << "HttpTransport: Node" << nodeName << "serves requests over HTTP/2";
+            }
+        });
+
+    if (!compression)
+        return reply;
+    return new DecodedReply(reply, this);
+}
+
+void HttpTransport::warmUp(const QUrl& node) {
+    if (node.scheme() == QStringLiteral("https")) {
+        // Offer HTTP/2 while connecting, as requests will, so the connection can be used for them
+        auto configuration = QSslConfiguration::defaultConfiguration();
+        configuration.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                               QSslConfiguration::NextProtocolHttp1_1});
+        network->connectToHostEncrypted(node.host(), quint16(node.port(443)), configuration);
+    } else {
+        network->connectToHost(node.host(), quint16(node.port(80)));
+    }
+}
+
+void HttpTransport::setCompressionEnabled(bool enabled) {
+    if (enabled == compression)
+        return;
+    compression = enabled;
+    requestTemplates.clear();
+}
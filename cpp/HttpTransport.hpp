@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSet>
+#include <QUrl>
+
+#include <memory>
+
+struct z_stream_s;
+
+/*!
+ * \brief A reply to a node API call which inflates a compressed response as it arrives
+ *
+ * Wraps the reply from the network, which carries the response as the node sent it, and serves the response body
+ * decoded as though the node had sent it uncompressed. The Content-Encoding header is removed, and once the reply
+ * finishes, Content-Length is the length of the decoded body. The error, HTTP status and headers of the network reply
+ * are passed through; a body which fails to decode makes the reply fail with QNetworkReply::ProtocolFailure.
+ *
+ * Unlike Qt's own decompression, this keeps count of the bytes received over the wire, for \ref wireBytes.
+ */
+class DecodedReply : public QNetworkReply {
+    Q_OBJECT
+
+    QNetworkReply* raw;
+    std::unique_ptr<z_stream_s> inflater;
+    QByteArray content;
+    qint64 offset = 0;
+    qint64 wireCount = 0;
+    qint64 decodedCount = 0;
+    bool streamEnded = false;
+    bool decodeFailed = false;
+
+public:
+    //! \brief Wrap a reply from the network, taking ownership of it
+    explicit DecodedReply(QNetworkReply* raw, QObject* parent = nullptr);
+    virtual ~DecodedReply();
+
+    //! \brief Bytes of the response body received so far, as sent by the node
+    qint64 wireBytes() const { return wireCount; }
+    //! \brief Bytes of the response body decoded so far
+    qint64 decodedBytes() const { return decodedCount; }
+
+    void abort() override;
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return content.size() - offset + QIODevice::bytesAvailable(); }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+
+private:
+    void copyMetaData();
+    void receive();
+    void finish();
+    bool decode(const QByteArray& chunk, bool last);
+};
+
+/*!
+ * \brief Sends node API calls over HTTP, tuned for many small polls and some large table pages
+ *
+ * The request for each node and API path is built once and reused for every call to it, rather than rebuilding the
+ * URL and headers per call. Requests allow HTTP/2, so nodes which negotiate it over TLS serve all calls, however
+ * many are in flight, over a single connection; other nodes are served over persistent HTTP/1.1 connections, which
+ * \ref warmUp can open ahead of the first call to a node.
+ *
+ * Requests ask for gzip or deflate compressed responses. The response is decoded here rather than by Qt, so replies
+ * report the bytes received over the wire as well as the decoded bytes; see \ref DecodedReply.
+ */
+class HttpTransport : public QObject {
+    Q_OBJECT
+
+    QNetworkAccessManager* network;
+    // Prebuilt requests by node URL and API path
+    QHash<QString, QNetworkRequest> requestTemplates;
+    // Nodes which have served a response over HTTP/2
+    QSet<QString> http2Nodes;
+    bool compression = true;
+
+    const QNetworkRequest& requestTemplate(const QUrl& node, const QString& apiPath);
+
+public:
+    explicit HttpTransport(QObject* parent = nullptr);
+    virtual ~HttpTransport();
+
+    /*!
+     * \brief POST an API call to a node
+     * \return The reply, a \ref DecodedReply if compression is enabled
+     */
+    QNetworkReply* post(const QUrl& node, const QString& apiPath, const QByteArray& json);
+    //! \brief Open a connection to a node, if none is open, so the next call to it needn't wait for one
+    void warmUp(const QUrl& node);
+
+    bool compressionEnabled() const { return compression; }
+    //! \brief Set whether to ask for compressed responses; takes effect for calls made afterward
+    void setCompressionEnabled(bool enabled);
+    //! \brief Whether a node has been seen to serve responses over HTTP/2
+    bool usesHttp2(const QUrl& node) const { return http2Nodes.contains(node.toString()); }
+};
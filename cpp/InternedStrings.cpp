@@ -0,0 +1,85 @@
+#include <InternedStrings.hpp>
+
+#include <QReadWriteLock>
+
+#include <deque>
+
+namespace {
+struct InternTable {
+    QReadWriteLock lock;
+    QHash<QString, quint32> ids;
+    // A deque, so that growing it never moves the strings
+    std::deque<QString> strings;
+};
+
+InternTable& table() {
+    static InternTable table;
+    return table;
+}
+}
+
+InternedStringList::InternedStringList(const QStringList& strings) {
+    ids.reserve(strings.size());
+    for (const auto& string : strings)
+        ids.append(intern(string));
+}
+
+quint32 InternedStringList::intern(const QString& string) {
+    auto& t = table();
+    {
+        QReadLocker locker(&t.lock);
+        auto itr = t.ids.constFind(string);
+        if (itr != t.ids.constEnd())
+            return *itr;
+    }
+
+    QWriteLocker locker(&t.lock);
+    // Another thread may have added it while we waited for the lock
+    auto itr = t.ids.constFind(string);
+    if (itr != t.ids.constEnd())
+        return *itr;
+    quint32 id = t.strings.size();
+    t.strings.push_back(string);
+    t.ids.insert(string, id);
+    return id;
+}
+
+std::optional<quint32> InternedStringList::find(const QString& string) {
+    auto& t = table();
+    QReadLocker locker(&t.lock);
+    auto itr = t.ids.constFind(string);
+    if (itr == t.ids.constEnd())
+        return {};
+    return *itr;
+}
+
+QString InternedStringList::lookup(quint32 id) {
+    auto& t = table();
+    QReadLocker locker(&t.lock);
+    if (id >= t.strings.size()) {
+        qWarning() << "InternedStringList: Looked up unknown string ID" << id;
+        return {};
+    }
+    return t.strings[id];
+}
+
+qsizetype InternedStringList::internedCount() {
+    auto& t = table();
+    QReadLocker locker(&t.lock);
+    return t.strings.size();
+}
+
+QStringList InternedStringList::toStringList() const {
+    QStringList result;
+    result.reserve(ids.size());
+    auto& t = table();
+    QReadLocker locker(&t.lock);
+    for (auto id : ids)
+        result.append(id < t.strings.size()? t.strings[id] : QString());
+    return result;
+}
+
+bool InternedStringList::contains(const QString& string) const {
+    auto id = find(string);
+    return id && ids.contains(*id);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QDataStream>
+#include <QDebug>
+#include <QHash>
+#include <QMetaType>
+
+#include <optional>
+
+/*!
+ * \brief A list of strings from a small vocabulary, such as tags, held as IDs into a shared intern table
+ *
+ * Each distinct string is stored once for the whole process, and lists hold only the 32-bit IDs of their strings, so
+ * the many rows sharing a handful of tags don't each keep copies of them. IDs are assigned in order of first use and
+ * mean nothing outside the process. Strings are only looked up when a list is displayed or handed to QML.
+ *
+ * The intern table is locked, as rows are read from table snapshots on other threads.
+ */
+class InternedStringList {
+    QList<quint32> ids;
+
+public:
+    InternedStringList() = default;
+    explicit InternedStringList(const QStringList& strings);
+
+    //! Get the ID of a string, adding it to the intern table if it is not there yet
+    static quint32 intern(const QString& string);
+    //! Get the ID of a string, if it is in the intern table
+    static std::optional<quint32> find(const QString& string);
+    //! Get the string with an ID. The ID must have been returned by intern().
+    static QString lookup(quint32 id);
+    //! The number of distinct strings interned so far
+    static qsizetype internedCount();
+
+    QStringList toStringList() const;
+    const QList<quint32>& idList() const { return ids; }
+
+    qsizetype size() const { return ids.size(); }
+    bool isEmpty() const { return ids.isEmpty(); }
+    QString at(qsizetype i) const { return lookup(ids[i]); }
+    bool contains(const QString& string) const;
+    void append(const QString& string) { ids.append(intern(string)); }
+    void reserve(qsizetype size) { ids.reserve(size); }
+
+    bool operator==(const InternedStringList& other) const { return ids == other.ids; }
+    bool operator!=(const InternedStringList& other) const { return ids != other.ids; }
+};
+Q_DECLARE_METATYPE(InternedStringList)
+
+inline size_t qHash(const InternedStringList& list, size_t seed = 0) {
+    return qHashRange(list.idList().begin(), list.idList().end(), seed);
+}
+inline QDebug operator<<(QDebug debug, const InternedStringList& list) { return debug << list.toStringList(); }
+// IDs are only meaningful within the process, so the strings themselves are streamed
+inline QDataStream& operator<<(QDataStream& stream, const InternedStringList& list) {
+    return stream << list.toStringList();
+}
+inline QDataStream& operator>>(QDataStream& stream, InternedStringList& list) {
+    QStringList strings;
+    stream >> strings;
+    list = InternedStringList(strings);
+    return stream;
+}
@@ -0,0 +1,52 @@
+#include <JournalRouter.hpp>
+
+#include <QDebug>
+
+JournalRouter::JournalRouter(QObject* parent) : QObject(parent) {}
+
+void JournalRouter::addTable(AbstractTableInterface* table) {
+    if (table == nullptr || routes.contains(table))
+        return;
+
+    Route route(table->tableName(), table->scopeValue());
+    routes.insert(table, route);
+    tables.insert(route, table);
+
+    connect(table, &AbstractTableInterface::scopeChanged, this, [this, table] {
+        auto itr = routes.find(table);
+        if (itr == routes.end())
+            return;
+        tables.remove(*itr, table);
+        *itr = Route(table->tableName(), table->scopeValue());
+        tables.insert(*itr, table);
+    });
+    // By the time destroyed is emitted, the table is no longer an AbstractTableInterface, so only use the pointer
+    connect(table, &QObject::destroyed, this, [this, table] { removeTable(table); });
+}
+
+void JournalRouter::removeTable(AbstractTableInterface* table) {
+    auto itr = routes.find(table);
+    if (itr == routes.end())
+        return;
+    tables.remove(*itr, table);
+    routes.erase(itr);
+    disconnect(table, nullptr, this, nullptr);
+}
+
+void JournalRouter::route(QList<JournalEntry> entries) {
+    // Bucket the entries by table and scope, skipping any for tables nobody has open
+    QHash<Route, QList<JournalEntry>> buckets;
+    for (const auto& entry : entries) {
+        Route route(entry.table, entry.scope);
+        if (tables.contains(route))
+            buckets[route].append(entry);
+    }
+
+    for (auto bucket = buckets.begin(); bucket != buckets.end(); ++bucket) {
+        // Copy the recipients, in case processing the journal causes tables to be added or removed
+        auto recipients = tables.values(bucket.key());
+        for (auto* table : recipients)
+            if (routes.contains(table))
+                table->processJournal(bucket.value());
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <AbstractTableInterface.hpp>
+
+#include <QObject>
+#include <QHash>
+#include <QMultiHash>
+#include <QPair>
+
+/*!
+ * \brief Delivers journal entries to the tables they concern, and only those tables
+ *
+ * Tables register with the router, which indexes them by table name and numeric scope. A batch of journal entries is
+ * split into per-table buckets in a single pass, in the order received, and each table with entries in the batch gets
+ * its own bucket. A batch thus costs time in proportion to its size, regardless of how many tables are open.
+ *
+ * The router follows tables' scope changes, and forgets tables when they are destroyed.
+ */
+class JournalRouter : public QObject {
+    Q_OBJECT
+
+public:
+    explicit JournalRouter(QObject* parent = nullptr);
+
+    void addTable(AbstractTableInterface* table);
+    void removeTable(AbstractTableInterface* table);
+
+    int tableCount() const { return routes.size(); }
+
+public slots:
+    void route(QList<JournalEntry> entries);
+
+private:
+    using Route = QPair<QString, quint64>;
+    QMultiHash<Route, AbstractTableInterface*> tables;
+    QHash<AbstractTableInterface*, Route> routes;
+};
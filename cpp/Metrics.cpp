@@ -0,0 +1,259 @@
+#include <Metrics.hpp>
+#include <Strings.hpp>
+
+#include <QtAlgorithms>
+#include <QSaveFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+void LatencyHistogram::record(uint64_t micros) {
+    if (counts.empty())
+        counts.resize(MAX_SHIFT * HALF_BUCKETS + SUB_BUCKETS);
+
+    ++counts[indexOf(micros)];
+    ++total;
+    totalMicros += micros;
+    minimum = std::min(minimum, micros);
+    maximum = std::max(maximum, micros);
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    if (total == 0)
+        return 0;
+
+    auto rank = std::max<uint64_t>(1, uint64_t(std::ceil(std::clamp(fraction, 0.0, 1.0) * total)));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank)
+            return std::min(highestValueAt(i), maximum);
+    }
+    return maximum;
+}
+
+std::size_t LatencyHistogram::indexOf(uint64_t micros) {
+    if (micros < SUB_BUCKETS)
+        return micros;
+
+    int msb = 63 - qCountLeadingZeroBits(quint64(micros));
+    int shift = msb - (SUB_BUCKET_BITS - 1);
+    if (shift > MAX_SHIFT)
+        return MAX_SHIFT * HALF_BUCKETS + SUB_BUCKETS - 1;
+    return std::size_t(shift) * HALF_BUCKETS + (micros >> shift);
+}
+
+uint64_t LatencyHistogram::highestValueAt(std::size_t index) {
+    if (index < SUB_BUCKETS)
+        return index;
+
+    auto shift = index / HALF_BUCKETS - 1;
+    auto subBucket = index - shift * HALF_BUCKETS;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+MetricsRegistry::MetricsRegistry(QObject* parent) : QObject(parent) {
+    clock.start();
+}
+
+MetricsRegistry::~MetricsRegistry() {}
+
+QString MetricsRegistry::endpointName(const QString& apiPath, const QByteArray& requestJson) {
+    auto name = apiPath.section('/', -1);
+    if (apiPath != Strings::GetTableRows)
+        return name;
+
+    // Split table reads by table. Our request bodies come from getTableJson(), so the table name can be found
+    // without parsing the whole request.
+    const static QByteArray tableKey = QByteArrayLiteral("\"table\":");
+    auto start = requestJson.indexOf(tableKey);
+    if (start == -1)
+        return name;
+    start = requestJson.indexOf('"', start + tableKey.size());
+    auto end = requestJson.indexOf('"', start + 1);
+    if (start == -1 || end == -1)
+        return name;
+    return name + '/' + QString::fromLatin1(requestJson.mid(start + 1, end - start - 1));
+}
+
+qint64 MetricsRegistry::requestStarted(const QString& endpoint, uint64_t bytesSent) {
+    auto& metrics = endpointMetrics[endpoint];
+    ++metrics.requests;
+    metrics.bytesSent += bytesSent;
+    ++requestsInFlight;
+    scheduleUpdate();
+    return clock.nsecsElapsed();
+}
+
+void MetricsRegistry::requestFinished(const QString& endpoint, qint64 startToken, uint64_t bytesReceived,
+                                      uint64_t wireBytes, bool failed) {
+    auto& metrics = endpointMetrics[endpoint];
+    metrics.latency.record(uint64_t(clock.nsecsElapsed() - startToken) / 1000);
+    metrics.bytesReceived += bytesReceived;
+    metrics.wireBytesReceived += wireBytes;
+    if (failed)
+        ++metrics.failures;
+    if (requestsInFlight > 0)
+        --requestsInFlight;
+    scheduleUpdate();
+}
+
+void MetricsRegistry::nodeErrorOccurred(int errorCode) {
+    ++nodeErrorCounts[errorCode];
+    scheduleUpdate();
+}
+
+const MetricsRegistry::Endpoint* MetricsRegistry::getEndpoint(const QString& name) const {
+    auto itr = endpointMetrics.find(name);
+    return itr == endpointMetrics.end()? nullptr : &*itr;
+}
+
+QVariantMap MetricsRegistry::endpoints() const {
+    QVariantMap result;
+    for (auto itr = endpointMetrics.begin(); itr != endpointMetrics.end(); ++itr)
+        result[itr.key()] = endpoint(itr.key());
+    return result;
+}
+
+QVariantMap MetricsRegistry::nodeErrors() const {
+    QVariantMap result;
+    for (auto itr = nodeErrorCounts.begin(); itr != nodeErrorCounts.end(); ++itr)
+        result[QString::number(itr.key())] = QVariant::fromValue(itr.value());
+    return result;
+}
+
+QVariantMap MetricsRegistry::endpoint(QString name) const {
+    auto metrics = getEndpoint(name);
+    if (metrics == nullptr)
+        return {};
+
+    auto millis = [](uint64_t micros) { return micros / 1000.0; };
+    return {
+        {QStringLiteral("requests"), QVariant::fromValue(metrics->requests)},
+        {QStringLiteral("failures"), QVariant::fromValue(metrics->failures)},
+        {QStringLiteral("bytesSent"), QVariant::fromValue(metrics->bytesSent)},
+        {QStringLiteral("bytesReceived"), QVariant::fromValue(metrics->bytesReceived)},
+        {QStringLiteral("wireBytesReceived"), QVariant::fromValue(metrics->wireBytesReceived)},
+        {QStringLiteral("p50"), millis(metrics->latency.percentile(.5))},
+        {QStringLiteral("p90"), millis(metrics->latency.percentile(.9))},
+        {QStringLiteral("p99"), millis(metrics->latency.percentile(.99))},
+        {QStringLiteral("max"), millis(metrics->latency.max())}
+    };
+}
+
+QByteArray MetricsRegistry::toPrometheus() const {
+    QByteArray out;
+    auto line = [&out](const char* metric, const QString& labels, auto value) {
+        out += metric;
+        if (!labels.isEmpty())
+            out += '{' + labels.toUtf8() + '}';
+        out += ' ' + QByteArray::number(value) + '\n';
+    };
+    auto endpointLabel = [](const QString& name) { return QStringLiteral("endpoint=\"%1\"").arg(name); };
+
+    out += "# HELP pollaris_api_latency_seconds Round trip time of node API calls\n"
+           "# TYPE pollaris_api_latency_seconds summary\n";
+    for (auto itr = endpointMetrics.begin(); itr != endpointMetrics.end(); ++itr) {
+        const auto& latency = itr->latency;
+        for (double quantile : {.5, .9, .99})
+            line("pollaris_api_latency_seconds",
+                 endpointLabel(itr.key()) + QStringLiteral(",quantile=\"%1\"").arg(quantile),
+                 latency.percentile(quantile) / 1e6);
+        line("pollaris_api_latency_seconds_sum", endpointLabel(itr.key()), latency.sum() / 1e6);
+        line("pollaris_api_latency_seconds_count", endpointLabel(itr.key()), qulonglong(latency.count()));
+    }
+
+    out += "# HELP pollaris_api_requests_total Node API calls sent\n"
+           "# TYPE pollaris_api_requests_total counter\n";
+    for (auto itr = endpointMetrics.begin(); itr != endpointMetrics.end(); ++itr)
+        line("pollaris_api_requests_total", endpointLabel(itr.key()), qulonglong(itr->requests));
+    out += "# HELP pollaris_api_failures_total Node API calls which failed\n"
+           "# TYPE pollaris_api_failures_total counter\n";
+    for (auto itr = endpointMetrics.begin(); itr != endpointMetrics.end(); ++itr)
+        line("pollaris_api_failures_total", endpointLabel(itr.key()), qulonglong(itr->failures));
+    out += "# HELP pollaris_api_sent_bytes_total Request body bytes sent to the node\n"
+           "# TYPE pollaris_api_sent_bytes_total counter\n";
+    for (auto itr = endpointMetrics.begin(); itr != endpointMetrics.end(); ++itr)
+        line("pollaris_api_sent_bytes_total", endpointLabel(itr.key()), qulonglong(itr->bytesSent));
+    out += "# HELP pollaris_api_received_bytes_total Response body bytes received from the node\n"
+           "# TYPE pollaris_api_received_bytes_total counter\n";
+    for (auto itr = endpointMetrics.begin(); itr != endpointMetrics.end(); ++itr)
+        line("pollaris_api_received_bytes_total", endpointLabel(itr.key()), qulonglong(itr->bytesReceived));
+    out += "# HELP pollaris_api_received_wire_bytes_total Response body bytes received from the node, before decoding\n"
+           "# TYPE pollaris_api_received_wire_bytes_total counter\n";
+    for (auto itr = endpointMetrics.begin(); itr != endpointMetrics.end(); ++itr)
+        line("pollaris_api_received_wire_bytes_total", endpointLabel(itr.key()), qulonglong(itr->wireBytesReceived));
+
+    out += "# HELP pollaris_api_in_flight Node API calls awaiting a response\n"
+           "# TYPE pollaris_api_in_flight gauge\n";
+    line("pollaris_api_in_flight", QString(), qulonglong(requestsInFlight));
+
+    out += "# HELP pollaris_node_errors_total Node errors by code (HTTP status, or -1, -2, 0 as in nodeError)\n"
+           "# TYPE pollaris_node_errors_total counter\n";
+    for (auto itr = nodeErrorCounts.begin(); itr != nodeErrorCounts.end(); ++itr)
+        line("pollaris_node_errors_total", QStringLiteral("code=\"%1\"").arg(itr.key()), qulonglong(itr.value()));
+
+    return out;
+}
+
+bool MetricsRegistry::dumpToFile(QString path) const {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "MetricsRegistry: Unable to open" << path << "to dump metrics:" << file.errorString();
+        return false;
+    }
+    file.write(toPrometheus());
+    return file.commit();
+}
+
+bool MetricsRegistry::serveHttp(quint16 port) {
+    if (server != nullptr) {
+        server->close();
+        server->deleteLater();
+        server = nullptr;
+    }
+    if (port == 0)
+        return true;
+
+    server = new QTcpServer(this);
+    if (!server->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "MetricsRegistry: Unable to serve metrics on port" << port << ":" << server->errorString();
+        server->deleteLater();
+        server = nullptr;
+        return false;
+    }
+    qInfo() << "MetricsRegistry: Serving metrics at http://127.0.0.1:" << port;
+
+    connect(server, &QTcpServer::newConnection, this, [this] {
+        while (auto* socket = server->nextPendingConnection()) {
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            // Every request gets the metrics, so respond once the request line arrives and ignore the rest of it
+            connect(socket, &QTcpSocket::readyRead, socket, [this, socket] {
+                if (!socket->canReadLine())
+                    return;
+                socket->readAll();
+                auto body = toPrometheus();
+                socket->write("HTTP/1.0 200 OK\r\n"
+                              "Content-Type: text/plain; version=0.0.4\r\n"
+                              "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n");
+                socket->write(body);
+                socket->disconnectFromHost();
+            });
+        }
+    });
+    return true;
+}
+
+void MetricsRegistry::scheduleUpdate() {
+    if (updatePending)
+        return;
+    updatePending = true;
+    QTimer::singleShot(1000, this, [this] {
+        updatePending = false;
+        emit updated();
+    });
+}
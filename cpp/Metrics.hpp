@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QObject>
+#include <QMap>
+#include <QVariantMap>
+#include <QElapsedTimer>
+
+#include <limits>
+#include <vector>
+
+class QTcpServer;
+
+/*!
+ * \brief A histogram of latencies with bounded relative error, in the style of HdrHistogram
+ *
+ * Values are recorded in microseconds. Values below SUB_BUCKETS are counted exactly; above that, each power of two
+ * range is split into SUB_BUCKETS/2 linear buckets, so a value is always reported within about 6% of what was
+ * recorded. Memory is fixed at a few kilobytes regardless of how many values are recorded.
+ */
+class LatencyHistogram {
+public:
+    constexpr static int SUB_BUCKET_BITS = 5;
+    constexpr static int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    constexpr static int HALF_BUCKETS = SUB_BUCKETS / 2;
+    //! Largest power of two range tracked; values above 2^(MAX_SHIFT+SUB_BUCKET_BITS) us are clamped (~9 hours)
+    constexpr static int MAX_SHIFT = 30;
+
+    void record(uint64_t micros);
+
+    uint64_t count() const { return total; }
+    uint64_t sum() const { return totalMicros; }
+    uint64_t min() const { return total == 0? 0 : minimum; }
+    uint64_t max() const { return maximum; }
+    //! Get the value, in microseconds, below which the given fraction of recorded values fall
+    uint64_t percentile(double fraction) const;
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t totalMicros = 0;
+    uint64_t minimum = std::numeric_limits<uint64_t>::max();
+    uint64_t maximum = 0;
+
+    static std::size_t indexOf(uint64_t micros);
+    static uint64_t highestValueAt(std::size_t index);
+};
+
+/*!
+ * \brief A registry of request metrics for the node API
+ *
+ * Keeps a latency histogram, request and byte counters for each API endpoint, the number of requests in flight, and
+ * the distribution of node error codes. Endpoints are named after the API call, with get_table_rows further split by
+ * table, i.e. "get_info", "get_table_rows/group.accts" or "push_transaction".
+ *
+ * The metrics can be read from QML, and exported in the Prometheus text format either to a file or over a loopback
+ * HTTP endpoint.
+ */
+class MetricsRegistry : public QObject {
+    Q_OBJECT
+
+    //! \property endpoints Map of endpoint name to a summary of its metrics; see \ref endpoint()
+    Q_PROPERTY(QVariantMap endpoints READ endpoints NOTIFY updated)
+    Q_PROPERTY(quint64 inFlight READ inFlight NOTIFY updated)
+    //! \property nodeErrors Map of error code (as in BlockchainInterface::nodeError) to number of occurrences
+    Q_PROPERTY(QVariantMap nodeErrors READ nodeErrors NOTIFY updated)
+
+public:
+    struct Endpoint {
+        LatencyHistogram latency;
+        uint64_t requests = 0;
+        uint64_t failures = 0;
+        uint64_t bytesSent = 0;
+        uint64_t bytesReceived = 0;
+        //! Response bytes as received over the wire, before decompression
+        uint64_t wireBytesReceived = 0;
+    };
+
+    explicit MetricsRegistry(QObject* parent = nullptr);
+    virtual ~MetricsRegistry();
+
+    //! Get the endpoint name for an API call
+    static QString endpointName(const QString& apiPath, const QByteArray& requestJson);
+
+    //! Note that a request was sent; returns a token to pass to \ref requestFinished
+    qint64 requestStarted(const QString& endpoint, uint64_t bytesSent);
+    /*!
+     * \brief Note that a request finished
+     * \param bytesReceived The size of the response body, decoded
+     * \param wireBytes The size of the response body as the node sent it, which is smaller if it was compressed
+     */
+    void requestFinished(const QString& endpoint, qint64 startToken, uint64_t bytesReceived, uint64_t wireBytes,
+                         bool failed);
+    void nodeErrorOccurred(int errorCode);
+
+    const Endpoint* getEndpoint(const QString& name) const;
+
+    QVariantMap endpoints() const;
+    quint64 inFlight() const { return requestsInFlight; }
+    QVariantMap nodeErrors() const;
+
+    /*!
+     * \brief Get a summary of an endpoint's metrics
+     * \return A map with keys requests, failures, bytesSent, bytesReceived, wireBytesReceived, and p50, p90, p99 and
+     * max latencies in milliseconds; or an empty map if the endpoint has not been called
+     */
+    Q_INVOKABLE QVariantMap endpoint(QString name) const;
+    //! Get the metrics in the Prometheus text exposition format
+    Q_INVOKABLE QByteArray toPrometheus() const;
+    //! Write the metrics in Prometheus text format to the specified file, replacing it atomically
+    Q_INVOKABLE bool dumpToFile(QString path) const;
+    //! Serve the metrics in Prometheus format over HTTP on 127.0.0.1 at the given port; 0 stops serving
+    Q_INVOKABLE bool serveHttp(quint16 port);
+
+signals:
+    //! Emitted, at most once per second, after metrics change
+    void updated();
+
+private:
+    QMap<QString, Endpoint> endpointMetrics;
+    QMap<int, uint64_t> nodeErrorCounts;
+    uint64_t requestsInFlight = 0;
+    QElapsedTimer clock;
+    QTcpServer* server = nullptr;
+    bool updatePending = false;
+
+    void scheduleUpdate();
+};
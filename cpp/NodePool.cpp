@@ -0,0 +1,132 @@
+#include <NodePool.hpp>
+
+#include <QDateTime>
+#include <QVariantMap>
+#include <QDebug>
+
+void NodePool::setUrls(QList<QUrl> urls) {
+    bool changed = urls != this->urls();
+    QList<Node> newNodes;
+    newNodes.reserve(urls.size());
+    for (const QUrl& url : urls) {
+        if (url.isEmpty() ||
+                std::any_of(newNodes.begin(), newNodes.end(), [&url](const Node& n) { return n.url == url; }))
+            continue;
+        auto existing = indexOf(url);
+        if (existing != -1) {
+            newNodes.append(nodes[existing]);
+            if (changed)
+                newNodes.last().excluded = false;
+        } else {
+            Node node;
+            node.url = url;
+            newNodes.append(node);
+        }
+    }
+    nodes = std::move(newNodes);
+}
+
+QList<QUrl> NodePool::urls() const {
+    QList<QUrl> result;
+    result.reserve(nodes.size());
+    std::transform(nodes.begin(), nodes.end(), std::back_inserter(result), [](const Node& n) { return n.url; });
+    return result;
+}
+
+double NodePool::score(const Node& node) const {
+    // Nodes we haven't heard from yet are scored optimistically so they get tried, but behind any node we know is
+    // fast. Errors inflate the score, so a fast but flaky node loses to a slightly slower, reliable one.
+    constexpr double UNKNOWN_LATENCY = 250;
+    auto latency = node.latency < 0? UNKNOWN_LATENCY : node.latency;
+    return latency * (1 + 4 * node.errorRate);
+}
+
+int NodePool::select() const {
+    if (nodes.isEmpty())
+        return -1;
+
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    int best = -1;
+    for (int i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].excluded || nodes[i].isQuarantined(now))
+            continue;
+        if (best == -1 || score(nodes[i]) < score(nodes[best]))
+            best = i;
+    }
+    if (best != -1)
+        return best;
+
+    // Every node is quarantined or excluded. Use whichever quarantined node comes out of quarantine first rather than
+    // stalling, but never an excluded one.
+    for (int i = 0; i < nodes.size(); ++i)
+        if (!nodes[i].excluded && (best == -1 || nodes[i].quarantinedUntil < nodes[best].quarantinedUntil))
+            best = i;
+    return best;
+}
+
+int NodePool::indexOf(const QUrl& url) const {
+    auto itr = std::find_if(nodes.begin(), nodes.end(), [&url](const Node& n) { return n.url == url; });
+    return itr == nodes.end()? -1 : int(itr - nodes.begin());
+}
+
+bool NodePool::isExcluded(const QUrl& url) const {
+    auto index = indexOf(url);
+    return index != -1 && nodes[index].excluded;
+}
+
+void NodePool::recordSuccess(const QUrl& url, qint64 rttMsecs) {
+    auto index = indexOf(url);
+    if (index == -1)
+        return;
+
+    Node& node = nodes[index];
+    ++node.requests;
+    node.latency = node.latency < 0? rttMsecs : (LATENCY_ALPHA * rttMsecs + (1 - LATENCY_ALPHA) * node.latency);
+    node.errorRate *= (1 - ERROR_ALPHA);
+    node.consecutiveFailures = 0;
+    node.quarantinedUntil = 0;
+    node.quarantineMsecs = 0;
+}
+
+void NodePool::recordFailure(const QUrl& url, bool unreachable) {
+    auto index = indexOf(url);
+    if (index == -1)
+        return;
+
+    Node& node = nodes[index];
+    ++node.requests;
+    ++node.failures;
+    node.errorRate = ERROR_ALPHA + (1 - ERROR_ALPHA) * node.errorRate;
+    if (++node.consecutiveFailures >= FAILURES_BEFORE_QUARANTINE || unreachable) {
+        node.quarantineMsecs = node.quarantineMsecs == 0? MIN_QUARANTINE_MSECS
+                                                        : std::min(node.quarantineMsecs * 2, MAX_QUARANTINE_MSECS);
+        node.quarantinedUntil = QDateTime::currentMSecsSinceEpoch() + node.quarantineMsecs;
+        qInfo() << "NodePool: Quarantining node" << node.url << "for" << node.quarantineMsecs << "ms after"
+                << node.consecutiveFailures << "consecutive failures";
+    }
+}
+
+void NodePool::exclude(const QUrl& url) {
+    auto index = indexOf(url);
+    if (index == -1 || nodes[index].excluded)
+        return;
+    nodes[index].excluded = true;
+    qInfo() << "NodePool: Excluding node" << url << "until the nodes change";
+}
+
+QVariantList NodePool::describe() const {
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    QVariantList result;
+    result.reserve(nodes.size());
+    for (const Node& node : nodes)
+        result.append(QVariantMap{
+            {QStringLiteral("url"), node.url.toString()},
+            {QStringLiteral("latency"), node.latency},
+            {QStringLiteral("errorRate"), node.errorRate},
+            {QStringLiteral("requests"), QVariant::fromValue(node.requests)},
+            {QStringLiteral("failures"), QVariant::fromValue(node.failures)},
+            {QStringLiteral("healthy"), !node.excluded && !node.isQuarantined(now)},
+            {QStringLiteral("excluded"), node.excluded}
+        });
+    return result;
+}
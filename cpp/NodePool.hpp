@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QUrl>
+#include <QList>
+#include <QVariantList>
+
+/*!
+ * \brief Tracks a set of interchangeable API nodes and chooses which one to send each request to
+ *
+ * Every node carries an exponentially weighted moving average of its round trip time and of its error rate. Reads are
+ * routed to the healthy node with the best score, which is its average latency inflated by its error rate. A node
+ * which fails several requests in a row is quarantined for a backoff period which doubles on each repeated failure,
+ * and is only used again once the backoff expires or if no other node is available. A node found to be on another
+ * chain is excluded, and never used again until the node set changes.
+ *
+ * The pool is purely bookkeeping: it never touches the network itself, which is left to BlockchainInterface.
+ */
+class NodePool {
+public:
+    struct Node {
+        QUrl url;
+        //! Moving average of the round trip time, in milliseconds; negative until the first reply is received
+        double latency = -1;
+        //! Moving average of the fraction of requests that failed, in [0, 1]
+        double errorRate = 0;
+        uint32_t consecutiveFailures = 0;
+        uint64_t requests = 0;
+        uint64_t failures = 0;
+        //! Time, in msecs since epoch, before which the node should not be used
+        qint64 quarantinedUntil = 0;
+        qint64 quarantineMsecs = 0;
+        //! Set if the node must not be used at all, as it serves another chain
+        bool excluded = false;
+
+        bool isQuarantined(qint64 now) const { return quarantinedUntil > now; }
+    };
+
+    //! Weight of the newest sample in the latency average
+    constexpr static double LATENCY_ALPHA = .2;
+    //! Weight of the newest sample in the error rate average
+    constexpr static double ERROR_ALPHA = .1;
+    //! Number of consecutive failures after which a node is quarantined
+    constexpr static uint32_t FAILURES_BEFORE_QUARANTINE = 3;
+    constexpr static qint64 MIN_QUARANTINE_MSECS = 5'000;
+    constexpr static qint64 MAX_QUARANTINE_MSECS = 300'000;
+
+    //! Replace the node set. Statistics of URLs which remain in the set are kept, but if the set changes, nodes
+    //! excluded before are given another chance.
+    void setUrls(QList<QUrl> urls);
+    QList<QUrl> urls() const;
+    bool isEmpty() const { return nodes.isEmpty(); }
+    int size() const { return nodes.size(); }
+
+    //! Get the index of the best node to send a read to, or -1 if the pool is empty or every node is excluded
+    int select() const;
+    //! Get the index of the node with the given URL, or -1 if it is not in the pool
+    int indexOf(const QUrl& url) const;
+    const Node& node(int index) const { return nodes[index]; }
+    //! Check whether the node with the given URL is excluded; false if it is not in the pool
+    bool isExcluded(const QUrl& url) const;
+
+    void recordSuccess(const QUrl& url, qint64 rttMsecs);
+    //! Record a failed request. If unreachable is set, the node could not be contacted at all, and is quarantined
+    //! immediately rather than after several failures.
+    void recordFailure(const QUrl& url, bool unreachable = false);
+    //! Never select a node again, until the node set changes
+    void exclude(const QUrl& url);
+
+    //! Get a description of every node, for display or diagnostics
+    QVariantList describe() const;
+
+private:
+    QList<Node> nodes;
+
+    double score(const Node& node) const;
+};
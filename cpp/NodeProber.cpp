@@ -0,0 +1,182 @@
+#include <NodeProber.hpp>
+#include <Strings.hpp>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaEnum>
+#include <QTimeZone>
+#include <QVariantMap>
+#include <QDebug>
+
+NodeProber::NodeProber(QList<QUrl> candidates, QByteArray expectedChainId, uint32_t staleSeconds, Sender send,
+                       QObject* parent)
+    : QObject(parent), expectedChainId(std::move(expectedChainId)), staleSeconds(staleSeconds),
+      send(std::move(send)) {
+    for (const QUrl& url : candidates) {
+        if (url.isEmpty() ||
+                std::any_of(results.begin(), results.end(), [&url](const Result& r) { return r.url == url; }))
+            continue;
+        Result result;
+        result.url = url;
+        results.append(result);
+    }
+    replies.fill(nullptr, results.size());
+
+    timeoutTimer.setSingleShot(true);
+    timeoutTimer.callOnTimeout(this, &NodeProber::finish);
+    graceTimer.setSingleShot(true);
+    graceTimer.callOnTimeout(this, [this] {
+        if (!decidedWinner) {
+            auto best = ranking();
+            decide(best.first().verdict == Verdict::Stale? best.first().url : QUrl());
+        }
+    });
+}
+
+NodeProber::~NodeProber() {
+    for (auto* reply : std::as_const(replies))
+        if (reply != nullptr) {
+            reply->disconnect(this);
+            reply->abort();
+            reply->deleteLater();
+        }
+}
+
+void NodeProber::start(int timeoutMsecs) {
+    clock.start();
+    if (results.isEmpty()) {
+        finish();
+        return;
+    }
+
+    qInfo() << "NodeProber: Probing" << results.size() << "candidate nodes";
+    for (int i = 0; i < results.size(); ++i) {
+        replies[i] = send(results[i].url);
+        connect(replies[i], &QNetworkReply::finished, this, [this, i] { processReply(i); });
+    }
+    timeoutTimer.start(timeoutMsecs);
+}
+
+QList<NodeProber::Result> NodeProber::ranking() const {
+    auto ranked = results;
+    // Usable nodes rank fastest first; the rest keep the order they were given in
+    std::stable_sort(ranked.begin(), ranked.end(), [](const Result& a, const Result& b) {
+        if (a.verdict != b.verdict)
+            return a.verdict < b.verdict;
+        if (a.verdict == Verdict::Fresh || a.verdict == Verdict::Stale)
+            return a.rttMsecs < b.rttMsecs;
+        return false;
+    });
+    return ranked;
+}
+
+QVariantList NodeProber::describeRanking() const {
+    const auto verdicts = QMetaEnum::fromType<Verdict>();
+    QVariantList result;
+    result.reserve(results.size());
+    for (const Result& node : ranking())
+        result.append(QVariantMap{
+            {QStringLiteral("url"), node.url.toString()},
+            {QStringLiteral("verdict"), QString::fromLatin1(verdicts.valueToKey(int(node.verdict)))},
+            {QStringLiteral("rtt"), node.rttMsecs},
+            {QStringLiteral("errorCode"), node.errorCode},
+            {QStringLiteral("chainId"), QString::fromLatin1(node.chainId)},
+            {QStringLiteral("headBlockNumber"), QVariant::fromValue(node.headBlockNumber)},
+            {QStringLiteral("headBlockTime"), node.headBlockTime}
+        });
+    return result;
+}
+
+void NodeProber::processReply(int index) {
+    auto* reply = std::exchange(replies[index], nullptr);
+    reply->deleteLater();
+    Result& result = results[index];
+    if (result.verdict != Verdict::Pending)
+        return;
+    result.rttMsecs = clock.elapsed();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        result.verdict = Verdict::Failed;
+        if (reply->error() == QNetworkReply::ProtocolUnknownError)
+            result.errorCode = -1;
+        else if (reply->error() == QNetworkReply::ConnectionRefusedError)
+            result.errorCode = -2;
+        else
+            result.errorCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        checkDone();
+        return;
+    }
+
+    auto jsonDoc = QJsonDocument::fromJson(reply->readAll());
+    QJsonObject response;
+    if (!jsonDoc.isObject() || !(response = jsonDoc.object()).contains(Strings::HeadBlockId)) {
+        result.verdict = Verdict::Nonsense;
+        checkDone();
+        return;
+    }
+
+    result.chainId = response[Strings::ChainId].toString().toLocal8Bit();
+    result.headBlockNumber = response[Strings::HeadBlockNum].toVariant().toULongLong();
+    result.headBlockTime = QDateTime::fromString(response[Strings::HeadBlockTime].toString(), Qt::ISODate);
+    result.headBlockTime.setTimeZone(QTimeZone::utc());
+    auto age = result.headBlockTime.secsTo(QDateTime::currentDateTimeUtc());
+
+    if (!expectedChainId.isEmpty() && result.chainId != expectedChainId) {
+        qWarning() << "NodeProber: Node" << result.url << "is on chain" << result.chainId << "rather than"
+                   << expectedChainId;
+        result.verdict = Verdict::WrongChain;
+    } else if (!result.headBlockTime.isValid() || age > qint64(staleSeconds)) {
+        result.verdict = Verdict::Stale;
+        if (!decidedWinner && !graceTimer.isActive())
+            graceTimer.start(STALE_GRACE_MSECS);
+    } else {
+        result.verdict = Verdict::Fresh;
+        if (!decidedWinner) {
+            // Later candidates must be on the winner's chain to rank as usable
+            if (expectedChainId.isEmpty())
+                expectedChainId = result.chainId;
+            decide(result.url);
+        }
+    }
+    checkDone();
+}
+
+void NodeProber::decide(QUrl winner) {
+    decidedWinner = true;
+    winningUrl = winner;
+    if (winner.isEmpty())
+        qWarning() << "NodeProber: None of the candidate nodes is usable";
+    else
+        qInfo() << "NodeProber: Chose node" << winner << "after" << clock.elapsed() << "ms";
+    emit decided(winner);
+}
+
+void NodeProber::checkDone() {
+    if (std::none_of(results.begin(), results.end(), [](const Result& r) { return r.verdict == Verdict::Pending; }))
+        finish();
+}
+
+void NodeProber::finish() {
+    if (finishedProbing)
+        return;
+    timeoutTimer.stop();
+    graceTimer.stop();
+
+    for (int i = 0; i < results.size(); ++i) {
+        if (results[i].verdict != Verdict::Pending)
+            continue;
+        results[i].verdict = Verdict::TimedOut;
+        if (auto* reply = std::exchange(replies[i], nullptr)) {
+            reply->disconnect(this);
+            reply->abort();
+            reply->deleteLater();
+        }
+    }
+
+    finishedProbing = true;
+    if (!decidedWinner) {
+        auto best = ranking();
+        decide(!best.isEmpty() && best.first().verdict == Verdict::Stale? best.first().url : QUrl());
+    }
+    emit finished();
+}
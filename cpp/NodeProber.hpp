@@ -0,0 +1,94 @@
+#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QList>
+#include <QNetworkReply>
+#include <QTimer>
+#include <QUrl>
+#include <QVariantList>
+
+#include <functional>
+
+/*!
+ * \brief Races get_info requests to several candidate nodes to find one to connect to
+ *
+ * All candidates are asked for their chain info at once, rather than tried one at a time, so a node that is down or
+ * slow costs no more than the wait for the fastest one that works. The first node to answer with a sensible reply on
+ * the expected chain and with a fresh head block wins immediately. If every node that answers is stale, the fastest of
+ * them wins once the rest have answered, shortly after the first stale answer, or at the timeout, whichever is first.
+ *
+ * Probing continues after a winner is found until every candidate has answered or the timeout passes, so the
+ * ranking of the candidates is complete for choosing fallback nodes.
+ */
+class NodeProber : public QObject {
+    Q_OBJECT
+
+public:
+    //! The outcome of probing a candidate, in order of preference
+    enum class Verdict { Fresh, Stale, Pending, WrongChain, Nonsense, Failed, TimedOut };
+    Q_ENUM(Verdict)
+
+    struct Result {
+        QUrl url;
+        Verdict verdict = Verdict::Pending;
+        qint64 rttMsecs = -1;
+        //! For failed candidates, an HTTP status, or -1 for protocol unknown, -2 for connection refused, 0 otherwise
+        int errorCode = 0;
+        QByteArray chainId;
+        unsigned long headBlockNumber = 0;
+        QDateTime headBlockTime;
+    };
+
+    //! Callback to send a get_info request to the given node
+    using Sender = std::function<QNetworkReply*(const QUrl& node)>;
+
+    //! Time after the first stale answer to wait for a fresh one before settling on a stale node
+    constexpr static int STALE_GRACE_MSECS = 2000;
+
+    /*!
+     * \param candidates The nodes to probe
+     * \param expectedChainId The chain the nodes must be on, or empty to accept the winner's chain
+     * \param staleSeconds Age beyond which a node's head block is considered stale
+     * \param send Callback to send a get_info request
+     */
+    NodeProber(QList<QUrl> candidates, QByteArray expectedChainId, uint32_t staleSeconds, Sender send,
+               QObject* parent = nullptr);
+    virtual ~NodeProber();
+
+    //! Send the probes. The prober gives up on candidates which haven't answered after timeoutMsecs.
+    void start(int timeoutMsecs);
+
+    //! The chosen node, or empty if none has been chosen yet, or none was suitable
+    QUrl winner() const { return winningUrl; }
+    bool isFinished() const { return finishedProbing; }
+    //! Get the results for all candidates, best first
+    QList<Result> ranking() const;
+    //! Get a description of the ranking, for display or diagnostics
+    QVariantList describeRanking() const;
+
+signals:
+    //! Emitted once, when a node is chosen, or when probing finishes without finding a suitable node
+    void decided(QUrl winner);
+    //! Emitted when every candidate has answered or timed out
+    void finished();
+
+private:
+    QList<Result> results;
+    QList<QNetworkReply*> replies;
+    QByteArray expectedChainId;
+    uint32_t staleSeconds;
+    Sender send;
+    QElapsedTimer clock;
+    QTimer timeoutTimer;
+    QTimer graceTimer;
+    QUrl winningUrl;
+    bool decidedWinner = false;
+    bool finishedProbing = false;
+
+    void processReply(int index);
+    void decide(QUrl winner);
+    void checkDone();
+    void finish();
+};
@@ -0,0 +1,671 @@
+#pragma once
+
+#include <Infrastructure/reflectors.hpp>
+#include <EosioName.hpp>
+#include <InternedStrings.hpp>
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*!
+ * \brief A minimal pull parser over a JSON text, reading values in place with no intermediate document
+ *
+ * The cursor walks the text one token at a time; callers ask for the value they expect next, and get back whether it
+ * was there. Any malformed input sets the failed flag, after which all reads fail. Strings are only copied when they
+ * are read into a result; keys are compared in place unless they contain escapes.
+ */
+class JsonCursor {
+    const char* pos;
+    const char* end;
+    bool failed = false;
+    std::string scratch;
+
+    bool fail() { failed = true; pos = end; return false; }
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+    bool readHex4(uint32_t& value) {
+        if (end - pos < 4)
+            return fail();
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            auto digit = hexValue(*pos++);
+            if (digit < 0)
+                return fail();
+            value = (value << 4) | uint32_t(digit);
+        }
+        return true;
+    }
+    void appendUtf8(uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            scratch += char(codePoint);
+        } else if (codePoint < 0x800) {
+            scratch += char(0xC0 | (codePoint >> 6));
+            scratch += char(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            scratch += char(0xE0 | (codePoint >> 12));
+            scratch += char(0x80 | ((codePoint >> 6) & 0x3F));
+            scratch += char(0x80 | (codePoint & 0x3F));
+        } else {
+            scratch += char(0xF0 | (codePoint >> 18));
+            scratch += char(0x80 | ((codePoint >> 12) & 0x3F));
+            scratch += char(0x80 | ((codePoint >> 6) & 0x3F));
+            scratch += char(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    // Read the remainder of a string after an escape was found, unescaping into scratch
+    bool unescapeRest(const char* start) {
+        scratch.assign(start, pos);
+        while (pos < end && *pos != '"') {
+            if (*pos != '\\') {
+                scratch += *pos++;
+                continue;
+            }
+            if (++pos == end)
+                return fail();
+            switch (*pos++) {
+            case '"': scratch += '"'; break;
+            case '\\': scratch += '\\'; break;
+            case '/': scratch += '/'; break;
+            case 'b': scratch += '\b'; break;
+            case 'f': scratch += '\f'; break;
+            case 'n': scratch += '\n'; break;
+            case 'r': scratch += '\r'; break;
+            case 't': scratch += '\t'; break;
+            case 'u': {
+                uint32_t codePoint;
+                if (!readHex4(codePoint))
+                    return false;
+                // Combine surrogate pairs
+                if (codePoint >= 0xD800 && codePoint < 0xDC00 && end - pos >= 6 && pos[0] == '\\' && pos[1] == 'u') {
+                    pos += 2;
+                    uint32_t low;
+                    if (!readHex4(low))
+                        return false;
+                    if (low >= 0xDC00 && low < 0xE000)
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    else
+                        appendUtf8(codePoint), codePoint = low;
+                }
+                appendUtf8(codePoint);
+                break;
+            }
+            default:
+                return fail();
+            }
+        }
+        if (pos == end)
+            return fail();
+        ++pos;
+        return true;
+    }
+
+public:
+    JsonCursor(const char* begin, const char* end) : pos(begin), end(end) {}
+    explicit JsonCursor(const QByteArray& json) : JsonCursor(json.constData(), json.constData() + json.size()) {}
+
+    bool hasFailed() const { return failed; }
+    bool atEnd() { skipWhitespace(); return pos == end; }
+
+    void skipWhitespace() {
+        while (pos < end && (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t'))
+            ++pos;
+    }
+    //! Peek at the next non-whitespace character, or '\0' at the end of the text
+    char peek() {
+        skipWhitespace();
+        return pos < end? *pos : '\0';
+    }
+    //! Consume the next non-whitespace character if it is c; return whether it was
+    bool consume(char c) {
+        if (peek() != c)
+            return false;
+        ++pos;
+        return true;
+    }
+    bool expect(char c) { return consume(c) || fail(); }
+
+    /*!
+     * \brief Read a string's contents, without unescaping it if it has no escapes
+     * \param text Set to the string contents; valid until the next read
+     */
+    bool readStringView(std::string_view& text) {
+        if (!expect('"'))
+            return false;
+        auto start = pos;
+        while (pos < end && *pos != '"' && *pos != '\\')
+            ++pos;
+        if (pos == end)
+            return fail();
+        if (*pos == '"') {
+            text = std::string_view(start, pos++ - start);
+            return true;
+        }
+        if (!unescapeRest(start))
+            return false;
+        text = scratch;
+        return true;
+    }
+    bool readString(QString& result) {
+        std::string_view text;
+        if (!readStringView(text))
+            return false;
+        result = QString::fromUtf8(text.data(), qsizetype(text.size()));
+        return true;
+    }
+
+    //! Read the text of a number token, without interpreting it
+    bool readNumberText(std::string_view& text) {
+        skipWhitespace();
+        auto start = pos;
+        while (pos < end && (std::isdigit(static_cast<unsigned char>(*pos)) || *pos == '-' || *pos == '+' ||
+                             *pos == '.' || *pos == 'e' || *pos == 'E'))
+            ++pos;
+        if (pos == start)
+            return fail();
+        text = std::string_view(start, pos - start);
+        return true;
+    }
+    bool readBool(bool& result) {
+        skipWhitespace();
+        if (end - pos >= 4 && std::string_view(pos, 4) == "true") {
+            pos += 4;
+            return result = true;
+        }
+        if (end - pos >= 5 && std::string_view(pos, 5) == "false") {
+            pos += 5;
+            result = false;
+            return true;
+        }
+        return fail();
+    }
+    bool readNull() {
+        skipWhitespace();
+        if (end - pos >= 4 && std::string_view(pos, 4) == "null") {
+            pos += 4;
+            return true;
+        }
+        return fail();
+    }
+
+    //! Skip over the next value, of whatever type, returning its raw text
+    bool skipValue(std::string_view* raw = nullptr) {
+        auto c = peek();
+        auto start = pos;
+        std::string_view ignored;
+        bool good = true;
+        if (c == '"') {
+            good = readStringView(ignored);
+        } else if (c == '{' || c == '[') {
+            auto close = c == '{'? '}' : ']';
+            ++pos;
+            if (!consume(close)) {
+                do {
+                    if (c == '{' && !(readStringView(ignored) && expect(':')))
+                        return false;
+                    if (!skipValue())
+                        return false;
+                } while (consume(','));
+                good = expect(close);
+            }
+        } else if (c == 't' || c == 'f') {
+            bool b;
+            good = readBool(b);
+        } else if (c == 'n') {
+            good = readNull();
+        } else {
+            good = readNumberText(ignored);
+        }
+        if (good && raw != nullptr)
+            *raw = std::string_view(start, pos - start);
+        return good;
+    }
+};
+
+/*!
+ * \brief Decoders from JSON to field values, one specialization per supported field type
+ *
+ * Each specialization reads exactly one JSON value into the field. Types without a specialization fall back to
+ * parsing the value into a QJsonValue and converting it through QVariant, which matches what Convert<Struct> does.
+ */
+template<typename T, typename = void>
+struct JsonFieldDecoder {
+    static bool decode(JsonCursor& cursor, T& field) {
+        std::string_view raw;
+        if (!cursor.skipValue(&raw))
+            return false;
+        // Wrap the value in an array, as QJsonDocument only parses objects and arrays
+        auto document = QJsonDocument::fromJson(QByteArray("[") + QByteArray(raw.data(), qsizetype(raw.size())) + ']');
+        field = document.array().first().toVariant().template value<T>();
+        return true;
+    }
+};
+template<typename T>
+struct JsonFieldDecoder<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static bool decode(std::string_view text, T& field) {
+        // std::from_chars for floating point is not available everywhere, and numbers are short, so copy to strtod
+        std::string copy(text);
+        char* parsed = nullptr;
+        field = T(std::strtod(copy.c_str(), &parsed));
+        return parsed == copy.c_str() + copy.size();
+    }
+    static bool decode(JsonCursor& cursor, T& field) {
+        std::string_view text;
+        return cursor.readNumberText(text) && decode(text, field);
+    }
+};
+// Integers are accepted either as numbers or as strings, as nodes serialize 64-bit values as strings
+template<typename T>
+struct JsonFieldDecoder<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    static bool decode(JsonCursor& cursor, T& field) {
+        std::string_view text;
+        bool quoted = cursor.peek() == '"';
+        if (!(quoted? cursor.readStringView(text) : cursor.readNumberText(text)))
+            return false;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), field);
+        if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+            // Fractional or exponent notation; go through double as QJsonValue would
+            double value = 0;
+            if (quoted || !JsonFieldDecoder<double>::decode(text, value))
+                return false;
+            field = T(value);
+        }
+        return true;
+    }
+};
+template<>
+struct JsonFieldDecoder<bool> {
+    static bool decode(JsonCursor& cursor, bool& field) { return cursor.readBool(field); }
+};
+template<>
+struct JsonFieldDecoder<QString> {
+    static bool decode(JsonCursor& cursor, QString& field) { return cursor.readString(field); }
+};
+template<typename T>
+struct JsonFieldDecoder<QList<T>> {
+    static bool decode(JsonCursor& cursor, QList<T>& field) {
+        field.clear();
+        if (!cursor.expect('['))
+            return false;
+        if (cursor.consume(']'))
+            return true;
+        do {
+            T element{};
+            if (!JsonFieldDecoder<T>::decode(cursor, element))
+                return false;
+            field.append(std::move(element));
+        } while (cursor.consume(','));
+        return cursor.expect(']');
+    }
+};
+template<>
+struct JsonFieldDecoder<QStringList> : JsonFieldDecoder<QList<QString>> {};
+// Names are encoded straight from the text, without making a QString of them
+template<>
+struct JsonFieldDecoder<EosioName> {
+    static bool decode(JsonCursor& cursor, EosioName& field) {
+        std::string_view text;
+        if (!cursor.readStringView(text))
+            return false;
+        field = EosioName(eosio::string_to_uint64_t(text));
+        return true;
+    }
+};
+template<>
+struct JsonFieldDecoder<InternedStringList> {
+    static bool decode(JsonCursor& cursor, InternedStringList& field) {
+        QStringList strings;
+        if (!JsonFieldDecoder<QStringList>::decode(cursor, strings))
+            return false;
+        field = InternedStringList(strings);
+        return true;
+    }
+};
+
+/*!
+ * \brief A reader over the hex text of a packed (fc::raw / ABI binary) value, decoding bytes as it goes
+ *
+ * Nodes return rows requested with "json": false as hex strings of the rows' packed bytes. The cursor reads those
+ * bytes straight out of the hex text, so no intermediate byte buffer is made.
+ */
+class HexBinaryCursor {
+    const char* pos;
+    const char* end;
+    bool failed = false;
+    std::string scratch;
+
+    bool fail() { failed = true; pos = end; return false; }
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+public:
+    HexBinaryCursor(std::string_view hex) : pos(hex.data()), end(hex.data() + hex.size()) {
+        if (hex.size() % 2)
+            fail();
+    }
+
+    bool hasFailed() const { return failed; }
+    bool atEnd() const { return pos == end; }
+
+    bool readByte(uint8_t& byte) {
+        if (end - pos < 2)
+            return fail();
+        auto high = hexValue(pos[0]), low = hexValue(pos[1]);
+        if (high < 0 || low < 0)
+            return fail();
+        byte = uint8_t((high << 4) | low);
+        pos += 2;
+        return true;
+    }
+    //! Read a fixed-width little endian integer
+    template<typename T>
+    bool readLittleEndian(T& value) {
+        using Unsigned = std::make_unsigned_t<T>;
+        Unsigned result = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            uint8_t byte;
+            if (!readByte(byte))
+                return false;
+            result |= Unsigned(byte) << (8 * i);
+        }
+        value = T(result);
+        return true;
+    }
+    //! Read a LEB128 varuint32, as used for string lengths and container sizes
+    bool readVarUint32(uint32_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t byte;
+            if (!readByte(byte))
+                return false;
+            value |= uint32_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return fail();
+    }
+    bool readBytes(uint32_t length, std::string_view& bytes) {
+        if (uint64_t(end - pos) < uint64_t(length) * 2)
+            return fail();
+        scratch.resize(length);
+        for (uint32_t i = 0; i < length; ++i)
+            if (!readByte(reinterpret_cast<uint8_t&>(scratch[i])))
+                return false;
+        bytes = scratch;
+        return true;
+    }
+};
+
+/*!
+ * \brief Decoders from packed binary to field values, one specialization per supported field type
+ *
+ * The encoding is the contract's: integers are fixed-width little endian, bools are one byte, strings and containers
+ * are prefixed with their size as a varuint32. Only types with a specialization can be decoded; rows with other field
+ * types must not be marked with \ref BinaryRows.
+ */
+template<typename T, typename = void>
+struct BinaryFieldDecoder;
+template<typename T>
+struct BinaryFieldDecoder<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    static bool decode(HexBinaryCursor& cursor, T& field) { return cursor.readLittleEndian(field); }
+};
+template<>
+struct BinaryFieldDecoder<bool> {
+    static bool decode(HexBinaryCursor& cursor, bool& field) {
+        uint8_t byte;
+        if (!cursor.readByte(byte))
+            return false;
+        field = byte != 0;
+        return true;
+    }
+};
+template<typename T>
+struct BinaryFieldDecoder<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static bool decode(HexBinaryCursor& cursor, T& field) {
+        using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+        Bits bits;
+        if (!cursor.readLittleEndian(bits))
+            return false;
+        std::memcpy(&field, &bits, sizeof(T));
+        return true;
+    }
+};
+template<>
+struct BinaryFieldDecoder<QString> {
+    static bool decode(HexBinaryCursor& cursor, QString& field) {
+        uint32_t length;
+        std::string_view bytes;
+        if (!cursor.readVarUint32(length) || !cursor.readBytes(length, bytes))
+            return false;
+        field = QString::fromUtf8(bytes.data(), qsizetype(bytes.size()));
+        return true;
+    }
+};
+template<typename T>
+struct BinaryFieldDecoder<QList<T>> {
+    static bool decode(HexBinaryCursor& cursor, QList<T>& field) {
+        uint32_t count;
+        if (!cursor.readVarUint32(count))
+            return false;
+        field.clear();
+        // Don't trust the count for the reservation beyond what the remaining text could possibly hold
+        field.reserve(qsizetype(std::min<uint32_t>(count, 1024)));
+        for (uint32_t i = 0; i < count; ++i) {
+            T element{};
+            if (!BinaryFieldDecoder<T>::decode(cursor, element))
+                return false;
+            field.append(std::move(element));
+        }
+        return true;
+    }
+};
+template<>
+struct BinaryFieldDecoder<QStringList> : BinaryFieldDecoder<QList<QString>> {};
+template<>
+struct BinaryFieldDecoder<EosioName> {
+    static bool decode(HexBinaryCursor& cursor, EosioName& field) {
+        uint64_t name;
+        if (!cursor.readLittleEndian(name))
+            return false;
+        field = EosioName(name);
+        return true;
+    }
+};
+template<>
+struct BinaryFieldDecoder<InternedStringList> {
+    static bool decode(HexBinaryCursor& cursor, InternedStringList& field) {
+        QStringList strings;
+        if (!BinaryFieldDecoder<QStringList>::decode(cursor, strings))
+            return false;
+        field = InternedStringList(strings);
+        return true;
+    }
+};
+
+/*!
+ * \brief Specialize to std::true_type for rows whose reflected fields match the contract's table layout
+ *
+ * Tables of rows marked this way request their rows in binary ("json": false), which is much smaller on the wire
+ * than the node's JSON rendering. The reflected fields must be exactly the fields of the on-chain row, in order, and
+ * fields the contract stores as names must be declared as \ref EosioName.
+ */
+template<class Row>
+struct BinaryRows : std::false_type {};
+
+/*!
+ * \brief Decoder from get_table_rows responses to rows of a reflected struct
+ *
+ * This decodes the response text directly into the rows, in a single pass with no JSON document or QVariant boxing.
+ * Field names are matched against the reflected member names, which are compile-time constants; as nodes emit fields
+ * in ABI order, which is the struct's declaration order, the decoder tries the member following the previous one
+ * first, so each key costs one comparison. Unknown keys are skipped; missing fields are left value-initialized.
+ *
+ * Rows may also be packed binary, as the node returns them to requests with "json": false. Each row is then decoded
+ * field by field from its hex string according to the contract's layout; see \ref BinaryRows. A binary row must
+ * decode to exactly its full length, so a layout mismatch fails the decode rather than yielding garbage rows.
+ *
+ * Results are identical to parseRows() followed by Convert<Row>::fromJsonArray(), which this replaces on the table
+ * load path.
+ */
+template<class Row>
+class RowDecoder {
+    using Reflector = infra::reflector<Row>;
+    using Members = typename Reflector::members;
+    static_assert(typename Reflector::is_defined(), "Row decoders cannot be used on unreflected types");
+    constexpr static std::size_t MEMBER_COUNT = infra::typelist::length<Members>();
+
+    // Decode the value for the given key into the member of that name, if there is one
+    static bool decodeField(JsonCursor& cursor, std::string_view key, Row& row, std::size_t& nextMember) {
+        bool matched = false;
+        bool good = true;
+        auto tryMember = [&](auto MemberWrapper) {
+            using Member = typename decltype(MemberWrapper)::type;
+            constexpr std::string_view name = infra::member_name_v<Row, Member::index>;
+            if (key != name)
+                return false;
+            good = JsonFieldDecoder<typename Member::type>::decode(cursor, Member::get(row));
+            nextMember = Member::index + 1;
+            return matched = true;
+        };
+
+        // Fast path: the expected member
+        if (nextMember < MEMBER_COUNT)
+            infra::typelist::runtime::any_of(Members(), [&tryMember, nextMember](auto MemberWrapper) {
+                return decltype(MemberWrapper)::type::index == nextMember && tryMember(MemberWrapper);
+            });
+        // Slow path: any member
+        if (!matched)
+            infra::typelist::runtime::any_of(Members(), tryMember);
+        if (!matched)
+            return cursor.skipValue();
+        return good;
+    }
+
+public:
+    //! Decode a single packed row, given as hex, into a row
+    static bool decodeBinaryRow(std::string_view hex, Row& row) {
+        if constexpr (!BinaryRows<Row>::value) {
+            return false;
+        } else {
+            HexBinaryCursor cursor(hex);
+            bool good = infra::typelist::runtime::all_of(Members(), [&cursor, &row](auto MemberWrapper) {
+                using Member = typename decltype(MemberWrapper)::type;
+                return BinaryFieldDecoder<typename Member::type>::decode(cursor, Member::get(row));
+            });
+            return good && cursor.atEnd();
+        }
+    }
+
+    //! Decode a single JSON object into a row
+    static bool decodeRow(JsonCursor& cursor, Row& row) {
+        if (!cursor.expect('{'))
+            return false;
+        if (cursor.consume('}'))
+            return true;
+        std::size_t nextMember = 0;
+        do {
+            std::string_view key;
+            if (!cursor.readStringView(key) || !cursor.expect(':'))
+                return false;
+            // The key may point into the cursor's scratch space, but it is only compared before the value is read
+            if (!decodeField(cursor, key, row, nextMember))
+                return false;
+        } while (cursor.consume(','));
+        return cursor.expect('}');
+    }
+
+    /*!
+     * \brief Decode a full get_table_rows response
+     * \param response The response text from the node
+     * \param rows Decoded rows are appended to this list
+     * \param nextKey Optional. If provided, set to the key to fetch further rows from if the response indicates there
+     * are more rows, or to std::nullopt if there are no more
+     * \return True if the response was sensible; false otherwise
+     */
+    static bool decodeResponse(const QByteArray& response, QList<Row>& rows,
+                               std::optional<QString>* nextKey = nullptr) {
+        JsonCursor cursor(response);
+        bool sawRows = false, more = false;
+        QString next;
+        if (!cursor.expect('{'))
+            return false;
+        if (!cursor.consume('}')) {
+            do {
+                std::string_view key;
+                if (!cursor.readStringView(key) || !cursor.expect(':'))
+                    return false;
+                if (key == "rows") {
+                    sawRows = true;
+                    if (!cursor.expect('['))
+                        return false;
+                    if (cursor.consume(']'))
+                        continue;
+                    do {
+                        Row row{};
+                        std::string_view hex;
+                        if (cursor.peek() == '"') {
+                            if (!cursor.readStringView(hex) || !decodeBinaryRow(hex, row))
+                                return false;
+                        } else if (!decodeRow(cursor, row)) {
+                            return false;
+                        }
+                        rows.append(std::move(row));
+                    } while (cursor.consume(','));
+                    if (!cursor.expect(']'))
+                        return false;
+                } else if (key == "more") {
+                    if (!cursor.readBool(more))
+                        return false;
+                } else if (key == "next_key") {
+                    std::string_view text;
+                    auto c = cursor.peek();
+                    if (c == '"') {
+                        if (!cursor.readString(next))
+                            return false;
+                    } else if (c == 'n') {
+                        if (!cursor.readNull())
+                            return false;
+                    } else if (cursor.readNumberText(text)) {
+                        next = QString::fromLatin1(text.data(), qsizetype(text.size()));
+                    } else {
+                        return false;
+                    }
+                } else if (!cursor.skipValue()) {
+                    return false;
+                }
+            } while (cursor.consume(','));
+            if (!cursor.expect('}'))
+                return false;
+        }
+        if (!sawRows || !cursor.atEnd())
+            return false;
+
+        if (nextKey != nullptr)
+            *nextKey = more? std::optional<QString>(next) : std::nullopt;
+        return true;
+    }
+};
@@ -0,0 +1,402 @@
+#include <SharedTableCache.hpp>
+#include <BlockchainInterface.hpp>
+#include <Strings.hpp>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+
+#include <cstring>
+#include <utility>
+
+namespace {
+constexpr quint32 MAGIC = 0x504c5443; // "PLTC"
+// Bumped whenever the layout of the control segment changes
+constexpr quint32 LAYOUT_VERSION = 1;
+constexpr int MAX_TABLES = 1024;
+constexpr int RING_SIZE = 256;
+constexpr int TABLE_NAME_SIZE = 16;
+// Interval at which the control segment is polled for changes, and the publisher's heartbeat written
+constexpr int POLL_INTERVAL_MS = 100;
+// Time without a heartbeat after which the publisher is presumed gone
+constexpr qint64 PUBLISHER_TIMEOUT_MS = 5000;
+// Delay after a table changes before publishing it, so a burst of changes is published once
+constexpr int PUBLISH_DELAY_MS = 200;
+
+struct TableSlot {
+    char table[TABLE_NAME_SIZE];
+    quint64 scope;
+    // The generation of the segment holding the table's contents, or 0 if they have not been published
+    quint32 generation;
+    // Nonzero if a reader wants the table and the publisher has not yet opened it
+    quint32 requested;
+};
+
+struct RingEntry {
+    quint64 sequence;
+    quint32 slot;
+    quint32 generation;
+};
+
+struct ControlBlock {
+    quint32 magic;
+    quint32 version;
+    qint64 publisherPid;
+    // Time of the publisher's last heartbeat, in milliseconds since the epoch
+    qint64 heartbeat;
+    // The number of change notifications ever written to the ring
+    quint64 sequence;
+    quint32 nextGeneration;
+    quint32 tableCount;
+    TableSlot tables[MAX_TABLES];
+    RingEntry ring[RING_SIZE];
+};
+
+// Each data segment holds its contents' size, then the contents
+using ContentSize = quint64;
+
+class ControlLock {
+    QSharedMemory& memory;
+    bool locked;
+
+public:
+    ControlLock(QSharedMemory& memory) : memory(memory), locked(memory.lock()) {
+        if (!locked)
+            qWarning() << "SharedTableCache: Unable to lock cache:" << memory.errorString();
+    }
+    ~ControlLock() {
+        if (locked)
+            memory.unlock();
+    }
+    ControlBlock* get() const { return static_cast<ControlBlock*>(memory.data()); }
+    ControlBlock* operator->() const { return get(); }
+    explicit operator bool() const { return locked; }
+};
+
+bool slotMatches(const TableSlot& slot, const QByteArray& tableName, quint64 scope) {
+    return slot.scope == scope && std::strncmp(slot.table, tableName.constData(), TABLE_NAME_SIZE) == 0;
+}
+
+int findSlot(ControlBlock* block, const QString& tableName, quint64 scope, bool create) {
+    auto name = tableName.toLatin1();
+    for (quint32 i = 0; i < block->tableCount; ++i)
+        if (slotMatches(block->tables[i], name, scope))
+            return i;
+    if (!create)
+        return -1;
+    if (block->tableCount == MAX_TABLES || name.size() >= TABLE_NAME_SIZE) {
+        qWarning() << "SharedTableCache: No room in cache for table" << tableName << scope;
+        return -1;
+    }
+
+    auto& slot = block->tables[block->tableCount];
+    std::memset(&slot, 0, sizeof(slot));
+    std::memcpy(slot.table, name.constData(), name.size());
+    slot.scope = scope;
+    return block->tableCount++;
+}
+}
+
+SharedTableCache::SharedTableCache(QString name, BlockchainInterface* blockchain)
+    : QObject(blockchain), cacheName(std::move(name)), blockchain(blockchain) {
+    control.setNativeKey(QSharedMemory::legacyNativeKey(QStringLiteral("pollaris.") + cacheName));
+    pollTimer.setInterval(POLL_INTERVAL_MS);
+    pollTimer.callOnTimeout(this, &SharedTableCache::poll);
+    publishTimer.setSingleShot(true);
+    publishTimer.setInterval(PUBLISH_DELAY_MS);
+    publishTimer.callOnTimeout(this, &SharedTableCache::publishPending);
+}
+
+SharedTableCache::~SharedTableCache() {
+    // Let a reader take over at once, rather than after the heartbeat times out
+    if (currentRole == Role::Publisher && control.isAttached()) {
+        ControlLock block(control);
+        if (block && block->publisherPid == QCoreApplication::applicationPid()) {
+            block->publisherPid = 0;
+            block->heartbeat = 0;
+        }
+    }
+}
+
+bool SharedTableCache::open() {
+    if (currentRole != Role::Detached)
+        return true;
+
+    if (!control.create(sizeof(ControlBlock)) &&
+            (control.error() != QSharedMemory::AlreadyExists || !control.attach())) {
+        qWarning() << "SharedTableCache: Unable to open cache" << cacheName << ":" << control.errorString();
+        return false;
+    }
+    {
+        ControlLock block(control);
+        if (!block)
+            return false;
+        // Whoever locks a new segment first sets it up, whether or not it created it
+        if (block->magic == 0) {
+            std::memset(control.data(), 0, sizeof(ControlBlock));
+            block->magic = MAGIC;
+            block->version = LAYOUT_VERSION;
+            block->nextGeneration = 1;
+        } else if (block->magic != MAGIC || block->version != LAYOUT_VERSION) {
+            qWarning() << "SharedTableCache: Cache" << cacheName << "was made by an incompatible version of Pollaris";
+            control.detach();
+            return false;
+        }
+        // Only changes from here on are news to us
+        seenSequence = block->sequence;
+    }
+
+    if (!takeOver())
+        setRole(Role::Reader);
+    pollTimer.start();
+    return true;
+}
+
+void SharedTableCache::addTable(AbstractTableInterface* table) {
+    // Draft scoped tables exist only locally, so there's nothing to share
+    if (table == nullptr || table->scopeValue() >= AbstractTableInterface::BASE_DRAFT_ID || tables.contains(table))
+        return;
+
+    tables.insert(table);
+    connect(table, &QObject::destroyed, this, [this, table] {
+        tables.remove(table);
+        published.remove(table);
+        loadedGenerations.remove(table);
+    });
+    connect(table, &AbstractTableInterface::snapshotPublished, this, [this, table] {
+        auto itr = published.find(table);
+        if (itr == published.end())
+            return;
+        itr->dirty = true;
+        if (!publishTimer.isActive())
+            publishTimer.start();
+    });
+
+    if (currentRole == Role::Publisher) {
+        // Readers may depend on the table even when nothing here uses it, so keep a model open on it, which keeps it
+        // following the journal and out of reach of eviction
+        table->allRows();
+        published[table].dirty = true;
+        publishTimer.start();
+    } else if (currentRole == Role::Reader) {
+        int slot;
+        quint32 generation = 0;
+        {
+            ControlLock block(control);
+            if (!block)
+                return;
+            slot = findSlot(block.get(), table->tableName(), table->scopeValue(), true);
+            if (slot < 0)
+                return;
+            generation = block->tables[slot].generation;
+            if (generation == 0)
+                block->tables[slot].requested = 1;
+        }
+        if (generation != 0)
+            loadTable(table, generation);
+    }
+}
+
+void SharedTableCache::setRole(Role role) {
+    if (role == currentRole)
+        return;
+    qInfo() << "SharedTableCache: Now" << (role == Role::Publisher? "publishing" : "reading") << "cache" << cacheName;
+    currentRole = role;
+
+    // Tables added before the change are handled as though added afresh
+    auto existing = tables;
+    tables.clear();
+    published.clear();
+    loadedGenerations.clear();
+    for (auto* table : existing) {
+        QObject::disconnect(table, nullptr, this, nullptr);
+        addTable(table);
+    }
+    emit roleChanged(role);
+}
+
+bool SharedTableCache::takeOver() {
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    {
+        ControlLock block(control);
+        if (!block)
+            return false;
+        if (block->publisherPid != 0 && now - block->heartbeat < PUBLISHER_TIMEOUT_MS)
+            return false;
+        if (block->publisherPid != 0)
+            qWarning() << "SharedTableCache: Publisher of cache" << cacheName << "stopped responding; taking over";
+        block->publisherPid = QCoreApplication::applicationPid();
+        block->heartbeat = now;
+        // The last publisher's segments went with it, so every table readers have must be published anew
+        for (quint32 i = 0; i < block->tableCount; ++i)
+            block->tables[i].requested = 1;
+    }
+    setRole(Role::Publisher);
+    return true;
+}
+
+void SharedTableCache::poll() {
+    if (currentRole == Role::Publisher) {
+        bool replaced = false;
+        {
+            ControlLock block(control);
+            if (!block)
+                return;
+            // If we stalled long enough that a reader took over, become a reader ourselves
+            replaced = block->publisherPid != QCoreApplication::applicationPid();
+            if (!replaced)
+                block->heartbeat = QDateTime::currentMSecsSinceEpoch();
+        }
+        if (replaced) {
+            qWarning() << "SharedTableCache: Another process took over publishing cache" << cacheName;
+            setRole(Role::Reader);
+        } else {
+            processRequests();
+        }
+    } else if (currentRole == Role::Reader) {
+        bool publisherGone;
+        {
+            ControlLock block(control);
+            if (!block)
+                return;
+            publisherGone = block->publisherPid == 0 ||
+                    QDateTime::currentMSecsSinceEpoch() - block->heartbeat >= PUBLISHER_TIMEOUT_MS;
+        }
+        if (!publisherGone || !takeOver())
+            readChanges();
+    }
+}
+
+void SharedTableCache::processRequests() {
+    QList<QPair<QString, quint64>> requests;
+    {
+        ControlLock block(control);
+        if (!block)
+            return;
+        for (quint32 i = 0; i < block->tableCount; ++i) {
+            auto& slot = block->tables[i];
+            if (slot.requested) {
+                slot.requested = 0;
+                requests.append({QString::fromLatin1(slot.table, qstrnlen(slot.table, TABLE_NAME_SIZE)), slot.scope});
+            }
+        }
+    }
+    // Opening a table adds it, which publishes it once it loads
+    for (const auto& request : requests)
+        if (auto* table = openTable(request.first, request.second))
+            addTable(table);
+}
+
+void SharedTableCache::readChanges() {
+    QHash<AbstractTableInterface*, quint32> updates;
+    {
+        ControlLock block(control);
+        if (!block || block->sequence == seenSequence)
+            return;
+
+        QSet<quint32> changedSlots;
+        bool missed = block->sequence - seenSequence > RING_SIZE;
+        for (auto sequence = seenSequence + 1; !missed && sequence <= block->sequence; ++sequence)
+            changedSlots.insert(block->ring[(sequence - 1) % RING_SIZE].slot);
+        seenSequence = block->sequence;
+
+        // Check each of our tables against the directory, rather than trusting the ring's generations, which may
+        // already be superseded
+        for (auto* table : std::as_const(tables)) {
+            auto slot = findSlot(block.get(), table->tableName(), table->scopeValue(), false);
+            if (slot < 0 || (!missed && !changedSlots.contains(slot)))
+                continue;
+            auto generation = block->tables[slot].generation;
+            if (generation != 0 && generation != loadedGenerations.value(table))
+                updates.insert(table, generation);
+        }
+    }
+    for (auto itr = updates.begin(); itr != updates.end(); ++itr)
+        loadTable(itr.key(), itr.value());
+}
+
+void SharedTableCache::publishPending() {
+    for (auto itr = published.begin(); itr != published.end(); ++itr)
+        if (itr->dirty)
+            publishTable(itr.key(), *itr);
+}
+
+void SharedTableCache::publishTable(AbstractTableInterface* table, Published& entry) {
+    // Tables with rows still loading can't be spilled; they'll be published when they next change
+    auto contents = table->spill();
+    if (contents.isEmpty())
+        return;
+    entry.dirty = false;
+
+    quint32 generation;
+    {
+        ControlLock block(control);
+        if (!block)
+            return;
+        generation = block->nextGeneration++;
+        if (block->nextGeneration == 0)
+            block->nextGeneration = 1;
+    }
+
+    // Fill the new segment before it is listed in the directory, so no reader can see it half written
+    auto segment = std::make_unique<QSharedMemory>();
+    segment->setNativeKey(segmentKey(generation));
+    if (!segment->create(sizeof(ContentSize) + contents.size())) {
+        qWarning() << "SharedTableCache: Unable to publish" << table->tableName() << table->scopeValue() << ":"
+                   << segment->errorString();
+        return;
+    }
+    ContentSize size = contents.size();
+    std::memcpy(segment->data(), &size, sizeof(size));
+    std::memcpy(static_cast<char*>(segment->data()) + sizeof(size), contents.constData(), contents.size());
+
+    {
+        ControlLock block(control);
+        if (!block)
+            return;
+        auto slot = findSlot(block.get(), table->tableName(), table->scopeValue(), true);
+        if (slot < 0)
+            return;
+        block->tables[slot].generation = generation;
+        auto sequence = ++block->sequence;
+        block->ring[(sequence - 1) % RING_SIZE] = RingEntry{sequence, quint32(slot), generation};
+        // Our own notifications are no news to us, should we become a reader
+        seenSequence = sequence;
+    }
+    entry.previous = std::move(entry.current);
+    entry.current = std::move(segment);
+}
+
+void SharedTableCache::loadTable(AbstractTableInterface* table, quint32 generation) {
+    QSharedMemory segment;
+    segment.setNativeKey(segmentKey(generation));
+    // A segment that's already gone was replaced, and the notification of its replacement is on its way
+    if (!segment.attach(QSharedMemory::ReadOnly))
+        return;
+
+    ContentSize size = 0;
+    std::memcpy(&size, segment.constData(), sizeof(size));
+    if (sizeof(size) + size > ContentSize(segment.size())) {
+        qWarning() << "SharedTableCache: Published contents of" << table->tableName() << table->scopeValue()
+                   << "are truncated";
+        return;
+    }
+    QByteArray contents(static_cast<const char*>(segment.constData()) + sizeof(size), qsizetype(size));
+    segment.detach();
+
+    if (table->replaceRows(contents))
+        loadedGenerations[table] = generation;
+}
+
+AbstractTableInterface* SharedTableCache::openTable(const QString& tableName, quint64 scope) {
+    if (tableName == Strings::PollGroups)
+        return blockchain->getPollingGroupTable();
+    if (tableName == Strings::GroupAccts)
+        return blockchain->getGroupMembersTable(scope);
+    qWarning() << "SharedTableCache: Reader requested unknown table" << tableName;
+    return nullptr;
+}
+
+QNativeIpcKey SharedTableCache::segmentKey(quint32 generation) const {
+    return QSharedMemory::legacyNativeKey(QStringLiteral("pollaris.%1.%2").arg(cacheName).arg(generation));
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <AbstractTableInterface.hpp>
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QSharedMemory>
+#include <QTimer>
+
+#include <memory>
+
+class BlockchainInterface;
+
+/*!
+ * \brief Shares table contents between the Pollaris processes on a machine through shared memory
+ *
+ * All processes opening a cache of the same name share it. One of them, the publisher, syncs with the node as usual
+ * and publishes the contents of its tables into shared memory as they change. The others, the readers, fill their
+ * tables from the published contents rather than loading them from the node, and leave following the journal to the
+ * publisher. Several instances, or the GUI alongside the headless tools, thus load each table from the node once.
+ *
+ * The cache is a control segment holding a directory of tables and a ring of change notifications, which readers
+ * poll. Each table's contents, as written by AbstractTableInterface::spill, go in a segment of their own, which is
+ * replaced rather than rewritten when the table changes, so readers never see a partial table. A reader opening a
+ * table the publisher doesn't have requests it in the directory, and the publisher opens and publishes it.
+ *
+ * The first process to open the cache becomes its publisher. If the publisher exits or stops responding, the next
+ * reader to notice takes over, loading its tables from the node and publishing them.
+ */
+class SharedTableCache : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Role { Detached, Publisher, Reader };
+    Q_ENUM(Role)
+
+    SharedTableCache(QString name, BlockchainInterface* blockchain);
+    virtual ~SharedTableCache();
+
+    //! Open the cache, as its publisher if it has none or as a reader otherwise; returns false if it can't be opened
+    bool open();
+
+    QString name() const { return cacheName; }
+    Role role() const { return currentRole; }
+    bool isReader() const { return currentRole == Role::Reader; }
+
+    //! Publish a table, or fill it from the cache if reading. Called for each table as it is created.
+    void addTable(AbstractTableInterface* table);
+
+signals:
+    void roleChanged(SharedTableCache::Role role);
+
+private:
+    struct Published {
+        // The segments holding the two latest generations of the table's contents. The older is kept until replaced,
+        // as a reader may still be copying it.
+        std::unique_ptr<QSharedMemory> current, previous;
+        bool dirty = false;
+    };
+
+    QString cacheName;
+    BlockchainInterface* blockchain;
+    Role currentRole = Role::Detached;
+    QSharedMemory control;
+    QTimer pollTimer;
+    QTimer publishTimer;
+
+    QSet<AbstractTableInterface*> tables;
+    // When publishing, the tables' published contents
+    QHash<AbstractTableInterface*, Published> published;
+    // When reading, the generation of contents each table was last filled with
+    QHash<AbstractTableInterface*, quint32> loadedGenerations;
+    // The last change notification processed
+    quint64 seenSequence = 0;
+
+    void setRole(Role role);
+    bool takeOver();
+    void poll();
+    void processRequests();
+    void readChanges();
+    void publishPending();
+    void publishTable(AbstractTableInterface* table, Published& entry);
+    void loadTable(AbstractTableInterface* table, quint32 generation);
+    AbstractTableInterface* openTable(const QString& tableName, quint64 scope);
+    QNativeIpcKey segmentKey(quint32 generation) const;
+};
@@ -38,6 +38,7 @@ const QString Strings::What = QStringLiteral("what");
 const QString Strings::Processed = QStringLiteral("processed");
 const QString Strings::BlockNum = QStringLiteral("block_num");
 const QString Strings::LastIrreversibleBlockNum = QStringLiteral("last_irreversible_block_num");
+const QString Strings::LastIrreversibleBlockId = QStringLiteral("last_irreversible_block_id");
 const QString Strings::Transactions = QStringLiteral("transactions");
 const QString Strings::Trx = QStringLiteral("trx");
 const QString Strings::DraftId = QStringLiteral("DRAFT_ID");
@@ -130,6 +131,7 @@ const QVariantMap Strings::MapOfAll = {
     {QStringLiteral("Processed"), Processed},
     {QStringLiteral("BlockNum"), BlockNum},
     {QStringLiteral("LastIrreversibleBlockNum"), LastIrreversibleBlockNum},
+    {QStringLiteral("LastIrreversibleBlockId"), LastIrreversibleBlockId},
     {QStringLiteral("Transactions"), Transactions},
     {QStringLiteral("Trx"), Trx},
     {QStringLiteral("DraftId"), DraftId},
@@ -50,6 +50,7 @@ struct Strings {
     const static QString Processed;
     const static QString BlockNum;
     const static QString LastIrreversibleBlockNum;
+    const static QString LastIrreversibleBlockId;
     const static QString Transactions;
     const static QString Trx;
     const static QString DraftId;
@@ -104,19 +105,41 @@ struct Strings {
     const static QVariantMap MapOfAll;
 };
 
-// Helpers to generate the JSON argument strings for get_table_rows calls
-inline QByteArray getTableJson(QString table, QString scope, QString lowerBound, int limit, bool reverse = false) {
-    auto format = QStringLiteral(R"({"code": "fmv", "table": "%1", "scope": "%2", "json": true,
-                                     "lower_bound": %3, "limit": %4, "reverse": %5})");
-    QString rev = reverse? QStringLiteral("true") : QStringLiteral("false");
-    return format.arg(table, scope, lowerBound, QString::number(limit), rev).toLocal8Bit();
+//! The form in which get_table_rows returns rows: rendered to JSON by the node, or packed binary as stored on chain
+enum class RowFormat { Json, Binary };
+
+// Helpers to generate the JSON argument strings for get_table_rows calls. Every table page and poll makes one, so they
+// are appended into a single buffer rather than formatted from a template.
+inline QByteArray getTableJsonStart(const QString& table, const QString& scope, RowFormat rowFormat) {
+    QByteArray json;
+    json.reserve(128);
+    json += R"({"code":"fmv","table":")";
+    json += table.toUtf8();
+    json += R"(","scope":")";
+    json += scope.toUtf8();
+    json += rowFormat == RowFormat::Json? R"(","json":true)" : R"(","json":false)";
+    return json;
+}
+inline QByteArray getTableJson(QString table, QString scope, QString lowerBound, int limit, bool reverse = false,
+                               RowFormat rowFormat = RowFormat::Json) {
+    auto json = getTableJsonStart(table, scope, rowFormat);
+    json += R"(,"lower_bound":)";
+    json += lowerBound.toUtf8();
+    json += R"(,"limit":)";
+    json += QByteArray::number(limit);
+    json += reverse? R"(,"reverse":true})" : R"(,"reverse":false})";
+    return json;
 }
-inline QByteArray getTableJson(QString table, QString scope, QString lowerBound) {
-    auto format = QStringLiteral(R"({"code": "fmv", "table": "%1", "scope": "%2",
-                                     "limit": 100, "json": true, "lower_bound": %3})");
-    return format.arg(table, scope, lowerBound).toLocal8Bit();
+inline QByteArray getTableJson(QString table, QString scope, QString lowerBound,
+                               RowFormat rowFormat = RowFormat::Json) {
+    auto json = getTableJsonStart(table, scope, rowFormat);
+    json += R"(,"limit":100,"lower_bound":)";
+    json += lowerBound.toUtf8();
+    json += '}';
+    return json;
 }
-inline QByteArray getTableJson(QString table, QString scope) {
-    auto format = QStringLiteral(R"({"code": "fmv", "table": "%1", "scope": "%2", "limit": 100, "json": true})");
-    return format.arg(table, scope).toLocal8Bit();
+inline QByteArray getTableJson(QString table, QString scope, RowFormat rowFormat = RowFormat::Json) {
+    auto json = getTableJsonStart(table, scope, rowFormat);
+    json += R"(,"limit":100})";
+    return json;
 }
@@ -0,0 +1,509 @@
+#include <TableEditController.hpp>
+#include <Action.hpp>
+#include <BlockchainInterface.hpp>
+#include <Strings.hpp>
+#include <Tables.hpp>
+
+#include <QJsonDocument>
+#include <QDebug>
+
+namespace {
+// Time to let the tables settle after a draft edit is overwritten, before making the edits afresh
+constexpr int REAPPLY_DELAY_MS = 200;
+
+QString describeTable(const AbstractTableInterface* table) {
+    if (table == nullptr)
+        return QStringLiteral("(destroyed table)");
+    return table->tableName() + '[' + table->tableScope().toString() + ']';
+}
+QString describeFields(const QVariantMap& fields) {
+    return QString::fromUtf8(QJsonDocument(QJsonObject::fromVariantMap(fields)).toJson(QJsonDocument::Compact));
+}
+
+PollingGroupsTable* groupsTable(BlockchainInterface* blockchain) {
+    return dynamic_cast<PollingGroupsTable*>(blockchain->getPollingGroupTable());
+}
+GroupMembersTable* membersTable(BlockchainInterface* blockchain, quint64 groupId) {
+    return dynamic_cast<GroupMembersTable*>(blockchain->getGroupMembersTable(groupId));
+}
+}
+
+TableEditController::TableEditController(QObject* parent) : QObject(parent) {
+    reapplyTimer.setSingleShot(true);
+    reapplyTimer.setInterval(REAPPLY_DELAY_MS);
+    reapplyTimer.callOnTimeout(this, [this] {
+        resetEdits();
+        applyActions();
+    });
+}
+
+const QHash<QString, TableEditController::Rule>& TableEditController::rules() {
+    static const QHash<QString, Rule> rules{
+        {Strings::VoterAdd, &TableEditController::predictVoterAdd},
+        {Strings::VoterRemove, &TableEditController::predictVoterRemove},
+        {Strings::GroupRename, &TableEditController::predictGroupRename},
+        {Strings::GroupCopy, &TableEditController::predictGroupCopy}
+    };
+    return rules;
+}
+
+TableEditController::EditKey TableEditController::fieldsKey(const AbstractTableInterface* table,
+                                                             const QVariantMap& fields) {
+    // JSON objects sort their keys, so equal fields make equal keys
+    return {table, describeFields(fields)};
+}
+
+void TableEditController::setBlockchain(BlockchainInterface* blockchain) {
+    if (m_blockchain == blockchain)
+        return;
+
+    resetEdits();
+    emit blockchainChanged(m_blockchain = blockchain);
+    applyActions();
+}
+
+void TableEditController::setActions(QList<QObject*> actions) {
+    // The transaction's actions are set anew whenever they change, so make the edits afresh every time
+    emit actionsChanged(m_actions = actions);
+    qInfo() << "TableEditController: Making local edits for" << m_actions.size() << "actions";
+    resetEdits();
+    applyActions();
+}
+
+void TableEditController::applyActions() {
+    reapplyTimer.stop();
+    if (m_blockchain == nullptr || m_actions.isEmpty())
+        return;
+
+    // Index the polling groups by name once, rather than searching the table for each action
+    groupIds.clear();
+    if (auto* groups = groupsTable(m_blockchain); groups != nullptr)
+        groups->forEachRow([this](const PollingGroup& group, LoadState state) {
+            if (state != LoadState::Loading && !groupIds.contains(group.name))
+                groupIds.insert(group.name, group.id);
+        });
+
+    for (auto* object : std::as_const(m_actions)) {
+        editLists.append({});
+        auto* action = qobject_cast<Action*>(object);
+        if (action == nullptr)
+            continue;
+        auto rule = rules().value(action->actionName());
+        if (rule != nullptr && !(this->*rule)(action->arguments()))
+            qInfo() << "TableEditController: Predicted that action" << action->actionName() << "will fail";
+    }
+
+    qInfo().noquote() << "TableEditController: Edits:\n" + describeEdits();
+    notifyEditsChanged();
+}
+
+std::optional<quint64> TableEditController::findGroup(const QString& name) const {
+    auto itr = groupIds.constFind(name);
+    if (itr == groupIds.constEnd())
+        return {};
+    return *itr;
+}
+
+bool TableEditController::predictVoterAdd(const QJsonObject& arguments) {
+    auto groupName = arguments[Strings::GroupName].toString();
+    auto voter = arguments[Strings::Voter].toString();
+    auto weight = arguments[Strings::Weight].toVariant();
+
+    // Find the polling group, creating it if necessary
+    auto groupId = findGroup(groupName);
+    if (!groupId.has_value()) {
+        auto* groups = groupsTable(m_blockchain);
+        auto ids = groups == nullptr? QVariantList() : addRows(groups, {QVariantMap{{Strings::Name, groupName}}});
+        if (ids.isEmpty()) {
+            qCritical() << "TableEditController: [voter.add] Unable to create draft polling group" << groupName;
+            return false;
+        }
+        groupId = ids.first().toULongLong();
+        groupIds.insert(groupName, *groupId);
+        qInfo() << "TableEditController: [voter.add] Draft added polling group" << groupName << "with ID" << *groupId;
+    }
+
+    auto* members = membersTable(m_blockchain, *groupId);
+    if (members == nullptr)
+        return false;
+    if (const auto* member = members->getRow(EosioName(voter)); member != nullptr) {
+        // The voter exists already; if the weight doesn't change, the action will fail
+        if (member->weight == weight.toUInt())
+            return false;
+        editRow(members, voter, {{Strings::Weight, weight}});
+        qInfo() << "TableEditController: [voter.add] Draft edited voter" << voter << "in group" << groupName;
+    } else {
+        addRows(members, {QVariantMap{{Strings::Account, voter}, {Strings::Weight, weight}}});
+        qInfo() << "TableEditController: [voter.add] Draft added voter" << voter << "to group" << groupName;
+    }
+    return true;
+}
+
+bool TableEditController::predictVoterRemove(const QJsonObject& arguments) {
+    auto groupName = arguments[Strings::GroupName].toString();
+    auto voter = arguments[Strings::Voter].toString();
+
+    auto groupId = findGroup(groupName);
+    if (!groupId.has_value()) {
+        qCritical() << "TableEditController: [voter.remove] Could not find polling group" << groupName
+                    << "to remove voter from";
+        return false;
+    }
+    auto* members = membersTable(m_blockchain, *groupId);
+    if (members == nullptr || members->getRow(EosioName(voter)) == nullptr) {
+        qCritical() << "TableEditController: [voter.remove] Could not find voter" << voter << "to remove from group"
+                    << groupName;
+        return false;
+    }
+
+    deleteRow(members, voter);
+    return true;
+}
+
+bool TableEditController::predictGroupRename(const QJsonObject& arguments) {
+    auto groupName = arguments[Strings::GroupName].toString();
+    auto newName = arguments[Strings::NewName].toString();
+    if (groupName == newName)
+        return false;
+
+    auto groupId = findGroup(groupName);
+    if (!groupId.has_value()) {
+        qCritical() << "TableEditController: [group.rename] Could not find polling group" << groupName << "to rename";
+        return false;
+    }
+    if (findGroup(newName).has_value()) {
+        qCritical() << "TableEditController: [group.rename] New name" << newName << "is already taken";
+        return false;
+    }
+
+    editRow(groupsTable(m_blockchain), QVariant::fromValue(*groupId), {{Strings::Name, newName}});
+    groupIds.remove(groupName);
+    groupIds.insert(newName, *groupId);
+    return true;
+}
+
+bool TableEditController::predictGroupCopy(const QJsonObject& arguments) {
+    auto groupName = arguments[Strings::GroupName].toString();
+    auto newName = arguments[Strings::NewName].toString();
+    if (groupName == newName)
+        return false;
+
+    auto groupId = findGroup(groupName);
+    if (!groupId.has_value()) {
+        qCritical() << "TableEditController: [group.copy] Could not find polling group" << groupName << "to copy";
+        return false;
+    }
+    if (findGroup(newName).has_value()) {
+        qCritical() << "TableEditController: [group.copy] New name" << newName << "is already taken";
+        return false;
+    }
+
+    // Create the new group
+    auto ids = addRows(groupsTable(m_blockchain), {QVariantMap{{Strings::Name, newName}}});
+    if (ids.isEmpty()) {
+        qCritical() << "TableEditController: [group.copy] Unable to create new polling group" << newName;
+        return false;
+    }
+    auto newGroupId = ids.first().toULongLong();
+    groupIds.insert(newName, newGroupId);
+
+    // Add all locally known members of the first group to the second
+    auto* source = membersTable(m_blockchain, *groupId);
+    auto* target = membersTable(m_blockchain, newGroupId);
+    if (source == nullptr || target == nullptr)
+        return false;
+    QVariantList members;
+    source->forEachRow([&members](const GroupMember& member, LoadState) {
+        members.append(Convert<GroupMember>::toVariantMap(member));
+    });
+    addRows(target, std::move(members));
+    return true;
+}
+
+template<class Table>
+QVariantList TableEditController::addRows(Table* table, QVariantList fieldMaps) {
+    QVariantList ids;
+    if (table == nullptr || fieldMaps.isEmpty())
+        return ids;
+
+    // Add all of the rows in one call, so the table places them and notifies its models only once
+    auto draftIds = table->addDraftRows(fieldMaps);
+    for (int i = 0; i < draftIds.size(); ++i) {
+        if (draftIds[i] == typename decltype(draftIds)::value_type())
+            // The table refused this row
+            continue;
+        ids.append(toQml(draftIds[i]));
+        recordEdit({AddRow, table, ids.last(), fieldMaps[i].toMap()});
+    }
+    tableEdited(table);
+    return ids;
+}
+
+void TableEditController::editRow(AbstractTableInterface* table, QVariant id, QVariantMap fields) {
+    auto position = nextPosition();
+    auto key = rowKey(table, id);
+
+    // If the row was added earlier in this transaction, apply the fields to the edits which added and edited it, so
+    // they still match the row from the backend
+    if (addsByRow.contains(key)) {
+        for (auto earlier : addsByRow.value(key) + editsByRow.value(key)) {
+            auto& edit = editAt(earlier);
+            if (edit.type == DeleteRow)
+                continue;
+            unindexEdit(earlier);
+            edit.originalFields.append(qMakePair(edit.fields, position));
+            edit.fields.insert(fields);
+            indexEdit(earlier);
+        }
+    }
+
+    table->draftEditRow(id, fields);
+    tableEdited(table);
+    recordEdit({EditRow, table, id, fields});
+}
+
+void TableEditController::deleteRow(AbstractTableInterface* table, QVariant id) {
+    auto position = nextPosition();
+    auto key = rowKey(table, id);
+    Edit deletion{DeleteRow, table, id};
+
+    // If the row was added earlier in this transaction, it never reaches the backend, so the edits adding, editing
+    // and deleting it are settled already
+    if (addsByRow.contains(key)) {
+        deletion.settled = true;
+        for (auto earlier : addsByRow.value(key) + editsByRow.value(key)) {
+            markSettled(earlier);
+            editAt(earlier).settledBy = position;
+        }
+    }
+
+    table->draftDeleteRow(id);
+    tableEdited(table);
+    recordEdit(std::move(deletion));
+}
+
+void TableEditController::recordEdit(Edit edit) {
+    auto position = nextPosition();
+    bool settled = edit.settled;
+    editLists.last().append(std::move(edit));
+    if (!settled) {
+        ++unsettledEdits;
+        indexEdit(position);
+    }
+}
+
+void TableEditController::indexEdit(Position position) {
+    const auto& edit = editAt(position);
+    if (edit.type == AddRow) {
+        addsByRow[rowKey(edit.table, edit.id)].append(position);
+        addsByFields[fieldsKey(edit.table, edit.fields)].append(position);
+    } else {
+        editsByRow[rowKey(edit.table, edit.id)].append(position);
+    }
+}
+
+void TableEditController::unindexEdit(Position position) {
+    auto remove = [position](QHash<EditKey, QList<Position>>& index, const EditKey& key) {
+        auto itr = index.find(key);
+        if (itr == index.end())
+            return;
+        itr->removeOne(position);
+        if (itr->isEmpty())
+            index.erase(itr);
+    };
+
+    const auto& edit = editAt(position);
+    if (edit.type == AddRow) {
+        remove(addsByRow, rowKey(edit.table, edit.id));
+        remove(addsByFields, fieldsKey(edit.table, edit.fields));
+    } else {
+        remove(editsByRow, rowKey(edit.table, edit.id));
+    }
+}
+
+void TableEditController::markSettled(Position position) {
+    auto& edit = editAt(position);
+    if (edit.settled)
+        return;
+    unindexEdit(position);
+    edit.settled = true;
+    --unsettledEdits;
+}
+
+void TableEditController::tableEdited(AbstractTableInterface* table) {
+    if (editedTables.contains(table))
+        return;
+
+    editedTables.insert(table, {
+        connect(table, &AbstractTableInterface::draftEditInvalidated, this,
+                [this, table](QVariant id) { editInvalidated(table, id); }),
+        connect(table, &AbstractTableInterface::pendingEditSettled, this,
+                [this, table](QVariantMap from, QVariantMap to) { settleEdit(table, from, to); }),
+        connect(table, &AbstractTableInterface::hasPendingEditsChanged, this, [this, table](bool hasPendingEdits) {
+            if (!hasPendingEdits) {
+                qInfo() << "TableEditController: Table" << describeTable(table)
+                        << "no longer pending; removing from edited tables";
+                tableSettled(table);
+            }
+            updateChangesPending();
+        }),
+        connect(table, &QObject::destroyed, this, [this, table] { tableSettled(table); })
+    });
+    qInfo() << "TableEditController: Edited tables:" << editedTables.size();
+}
+
+void TableEditController::tableSettled(AbstractTableInterface* table) {
+    for (const auto& connection : editedTables.take(table))
+        disconnect(connection);
+    updateChangesPending();
+}
+
+void TableEditController::editInvalidated(AbstractTableInterface* table, QVariant id) {
+    if (m_changesPending)
+        return;
+
+    // The backend changed a row under a draft edit, so the drafted actions are predicted afresh against the tables as
+    // they now are, without asking the user. The timer waits for a burst of invalidations to end before doing so.
+    qInfo() << "TableEditController: A draft edit was invalidated in table" << describeTable(table) << "with ID"
+            << id << "-- resetting edits";
+    reapplyTimer.start();
+}
+
+void TableEditController::settleEdit(AbstractTableInterface* table, QVariantMap from, QVariantMap to) {
+    bool deleted = to.value(Strings::Deleted).toBool();
+    auto idField = table->tableName() == Strings::GroupAccts? Strings::Account : Strings::Id;
+
+    // An added row matches the edit which added it by its fields; an edited or deleted row matches by its ID
+    auto candidates = addsByFields.value(fieldsKey(table, from)) + editsByRow.value(rowKey(table, from.value(idField)));
+    bool found = false;
+    for (auto position : candidates) {
+        auto& edit = editAt(position);
+        if (edit.type == DeleteRow && !deleted)
+            continue;
+
+        markSettled(position);
+        found = true;
+        qInfo() << "TableEditController: Matched edit" << position.edit + 1 << "of action" << position.action + 1
+                << "with a settled edit";
+        if (edit.type == DeleteRow)
+            continue;
+        for (auto itr = from.constBegin(); itr != from.constEnd(); ++itr)
+            if (to.value(itr.key()) != itr.value())
+                edit.unexpectedValues.insert(itr.key(), to.value(itr.key()));
+        if (!edit.unexpectedValues.isEmpty())
+            qWarning() << "TableEditController: Unexpected values in edit:" << edit.unexpectedValues.keys();
+    }
+
+    if (!found)
+        qWarning() << "TableEditController: Could not find matching edit for change" << from << "=>" << to;
+    notifyEditsChanged();
+}
+
+void TableEditController::updateChangesPending() {
+    bool pending = std::any_of(editedTables.keyBegin(), editedTables.keyEnd(),
+                               [](AbstractTableInterface* table) { return table->hasPendingEdits(); });
+    if (pending != m_changesPending) {
+        qInfo() << "TableEditController: Changes pending:" << pending;
+        emit changesPendingChanged(m_changesPending = pending);
+    }
+}
+
+void TableEditController::notifyEditsChanged() {
+    emit editsChanged();
+    if ((unsettledEdits == 0) != m_editsSettled) {
+        qInfo() << "TableEditController: Edits settled:" << (unsettledEdits == 0);
+        emit editsSettledChanged(m_editsSettled = (unsettledEdits == 0));
+    }
+}
+
+void TableEditController::resetEdits() {
+    reapplyTimer.stop();
+    editLists.clear();
+    editsByRow.clear();
+    addsByRow.clear();
+    addsByFields.clear();
+    unsettledEdits = 0;
+    for (auto* table : editedTables.keys()) {
+        table->resetEdits();
+        tableSettled(table);
+    }
+    notifyEditsChanged();
+}
+
+void TableEditController::transactionSubmitted() {
+    for (auto* table : editedTables.keys())
+        table->markEditsPending();
+}
+
+QVariantMap TableEditController::toVariant(const Position& position) {
+    return {{QStringLiteral("action"), position.action}, {QStringLiteral("edit"), position.edit}};
+}
+
+QVariantList TableEditController::edits() const {
+    QVariantList result;
+    result.reserve(editLists.size());
+    for (const auto& editList : editLists) {
+        QVariantList actionEdits;
+        for (const auto& edit : editList) {
+            QVariantMap map{{QStringLiteral("type"), int(edit.type)},
+                            {QStringLiteral("table"), QVariant::fromValue(edit.table.data())},
+                            {QStringLiteral("id"), edit.id},
+                            {QStringLiteral("settled"), edit.settled}};
+            if (edit.type != DeleteRow)
+                map[QStringLiteral("fields")] = edit.fields;
+            if (!edit.unexpectedValues.isEmpty())
+                map[QStringLiteral("unexpectedValues")] = edit.unexpectedValues;
+            if (!edit.originalFields.isEmpty()) {
+                QVariantList originalFields;
+                for (const auto& [values, until] : edit.originalFields)
+                    originalFields.append(QVariantMap{{QStringLiteral("values"), values},
+                                                      {QStringLiteral("until"), toVariant(until)}});
+                map[QStringLiteral("originalFields")] = originalFields;
+            }
+            if (edit.settledBy.has_value())
+                map[QStringLiteral("settledBy")] = toVariant(*edit.settledBy);
+            actionEdits.append(map);
+        }
+        result.append(QVariant(actionEdits));
+    }
+    return result;
+}
+
+QString TableEditController::describeEdits() const {
+    QString result;
+    auto describe = [](const Edit& edit) {
+        // If the fields were changed by a later edit, show them as they were at the time of this one
+        const auto& original = edit.originalFields;
+        auto description = describeFields(original.isEmpty()? edit.fields : original.first().first);
+        QString parenthetical;
+        if (!original.isEmpty())
+            parenthetical = QStringLiteral("Later edited in Action %1, edit %2")
+                    .arg(original.first().second.action + 1).arg(original.first().second.edit + 1);
+        if (edit.settledBy.has_value())
+            parenthetical += (parenthetical.isEmpty()? QStringLiteral("Settled ") : QStringLiteral(", and settled "))
+                    + QStringLiteral("in Action %1, edit %2").arg(edit.settledBy->action + 1)
+                                                             .arg(edit.settledBy->edit + 1);
+        return parenthetical.isEmpty()? description : QStringLiteral("%1 (%2)").arg(description, parenthetical);
+    };
+
+    for (int action = 0; action < editLists.size(); ++action) {
+        result += QStringLiteral(" => Action %1:\n").arg(action + 1);
+        for (const auto& edit : editLists[action]) {
+            result += QStringLiteral(" ==> %1 <%2> ").arg(edit.settled? QStringLiteral("[X]") : QStringLiteral("[ ]"),
+                                                                describeTable(edit.table));
+            switch (edit.type) {
+            case AddRow:
+                result += "Add " + describe(edit);
+                break;
+            case EditRow:
+                result += QStringLiteral("Edit ID: %1 -> %2").arg(edit.id.toString(), describe(edit));
+                break;
+            case DeleteRow:
+                result += QStringLiteral("Delete ID: %1").arg(edit.id.toString());
+                break;
+            }
+            result += '\n';
+        }
+    }
+    return result;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+#include <QVariant>
+#include <QJsonObject>
+
+#include <optional>
+
+class AbstractTableInterface;
+class BlockchainInterface;
+
+/*!
+ * \brief Predicts the effects of a transaction's actions on the tables, and follows the predictions as they settle
+ *
+ * For each of the \ref actions, the controller makes draft edits to the tables showing the effect the action is
+ * expected to have, by the rule for the action's name. When the transaction is submitted, the edits become pending,
+ * and as the rows the transaction changed arrive from the backend, the controller matches them to the edits it
+ * predicted and marks those edits settled.
+ *
+ * If a change in the backend overwrites one of the draft edits, the edits are made afresh from the actions.
+ */
+class TableEditController : public QObject {
+    Q_OBJECT
+
+public:
+    enum EditType {
+        AddRow,
+        EditRow,
+        DeleteRow
+    };
+    Q_ENUM(EditType)
+
+private:
+    Q_PROPERTY(BlockchainInterface* blockchain READ blockchain WRITE setBlockchain NOTIFY blockchainChanged)
+    BlockchainInterface* m_blockchain = nullptr;
+    Q_PROPERTY(QList<QObject*> actions READ actions WRITE setActions NOTIFY actionsChanged)
+    QList<QObject*> m_actions;
+    /*!
+     * \property edits The edits made for each action, as a list parallel to actions of lists of edits
+     *
+     * Each edit is a map with its "type", "table", "id" (the ID of the row edited or deleted, or the draft ID of the
+     * row added), "fields" (for AddRow and EditRow) and "settled". Once settled, an edit also has "unexpectedValues"
+     * if the values from the backend were not as predicted.
+     *
+     * If later edits in the transaction change the row an AddRow or EditRow edit made, its "fields" are updated to
+     * the final values, and it has "originalFields": a list with one {"values": fields, "until": {"action": Number,
+     * "edit": Number}} per such edit, holding the fields from before that edit and that edit's position in edits.
+     * If a later edit deletes the row an AddRow or EditRow edit made, the edit settles before the transaction runs
+     * and has "settledBy": {"action": Number, "edit": Number}, the position of the DeleteRow edit.
+     */
+    Q_PROPERTY(QVariantList edits READ edits NOTIFY editsChanged)
+    //! \property changesPending True while any edited table has pending edits
+    Q_PROPERTY(bool changesPending READ changesPending NOTIFY changesPendingChanged)
+    bool m_changesPending = false;
+    //! \property editsSettled True once every edit has settled
+    Q_PROPERTY(bool editsSettled READ editsSettled NOTIFY editsSettledChanged)
+    bool m_editsSettled = true;
+    int unsettledEdits = 0;
+
+    // The location of an edit: the index of its action, and its index in that action's edits
+    struct Position {
+        int action;
+        int edit;
+
+        bool operator==(const Position& other) const { return action == other.action && edit == other.edit; }
+    };
+    struct Edit {
+        EditType type;
+        QPointer<AbstractTableInterface> table;
+        QVariant id;
+        QVariantMap fields;
+        bool settled = false;
+        // Once settled, the fields whose values from the backend were not as predicted, with those values
+        QVariantMap unexpectedValues;
+        // For each later edit in the transaction which changed this edit's row, the fields before it did, and where
+        // it is. The fields are updated to the final values, to match the row from the backend.
+        QList<QPair<QVariantMap, Position>> originalFields;
+        // If a later edit in the transaction deleted the row this edit added, the deleting edit, which settled this
+        std::optional<Position> settledBy;
+    };
+    QList<QList<Edit>> editLists;
+    static QVariantMap toVariant(const Position& position);
+
+    // Indexes of the unsettled edits, to match them to changes without searching all of the edits. Each is keyed by
+    // table and a string: the row ID for editsByRow and addsByRow, and the added fields, as JSON, for addsByFields.
+    using EditKey = std::pair<const AbstractTableInterface*, QString>;
+    QHash<EditKey, QList<Position>> editsByRow;
+    QHash<EditKey, QList<Position>> addsByRow;
+    QHash<EditKey, QList<Position>> addsByFields;
+    static EditKey rowKey(const AbstractTableInterface* table, const QVariant& id) { return {table, id.toString()}; }
+    static EditKey fieldsKey(const AbstractTableInterface* table, const QVariantMap& fields);
+
+    // Polling group IDs by name, as the edits so far leave them; built when the edits are made
+    QHash<QString, quint64> groupIds;
+
+    // The tables with edits, and the connections to their signals
+    QHash<AbstractTableInterface*, QList<QMetaObject::Connection>> editedTables;
+    // Delays making the edits afresh after a draft edit is overwritten, to let the tables settle first
+    QTimer reapplyTimer;
+
+    // A rule predicting the edits for an action; returns false if the action is expected to fail
+    using Rule = bool (TableEditController::*)(const QJsonObject& arguments);
+    static const QHash<QString, Rule>& rules();
+    bool predictVoterAdd(const QJsonObject& arguments);
+    bool predictVoterRemove(const QJsonObject& arguments);
+    bool predictGroupRename(const QJsonObject& arguments);
+    bool predictGroupCopy(const QJsonObject& arguments);
+
+    void applyActions();
+    std::optional<quint64> findGroup(const QString& name) const;
+
+    Edit& editAt(Position position) { return editLists[position.action][position.edit]; }
+    Position nextPosition() const { return {int(editLists.size()) - 1, int(editLists.last().size())}; }
+    template<class Table>
+    QVariantList addRows(Table* table, QVariantList fieldMaps);
+    void editRow(AbstractTableInterface* table, QVariant id, QVariantMap fields);
+    void deleteRow(AbstractTableInterface* table, QVariant id);
+    void recordEdit(Edit edit);
+    void indexEdit(Position position);
+    void unindexEdit(Position position);
+    void markSettled(Position position);
+
+    void tableEdited(AbstractTableInterface* table);
+    void tableSettled(AbstractTableInterface* table);
+    void editInvalidated(AbstractTableInterface* table, QVariant id);
+    void settleEdit(AbstractTableInterface* table, QVariantMap from, QVariantMap to);
+    void updateChangesPending();
+    void notifyEditsChanged();
+
+public:
+    explicit TableEditController(QObject* parent = nullptr);
+
+    BlockchainInterface* blockchain() const { return m_blockchain; }
+    QList<QObject*> actions() const { return m_actions; }
+    QVariantList edits() const;
+    bool changesPending() const { return m_changesPending; }
+    bool editsSettled() const { return m_editsSettled; }
+
+    Q_INVOKABLE QString describeEdits() const;
+
+public slots:
+    void setBlockchain(BlockchainInterface* blockchain);
+    void setActions(QList<QObject*> actions);
+
+    //! \brief Revert the edits in all edited tables, and forget them
+    void resetEdits();
+    //! \brief Mark the edits pending, as the transaction making them was submitted
+    void transactionSubmitted();
+
+signals:
+    void blockchainChanged(BlockchainInterface* blockchain);
+    void actionsChanged(QList<QObject*> actions);
+    void editsChanged();
+    void changesPendingChanged(bool changesPending);
+    void editsSettledChanged(bool editsSettled);
+};
@@ -0,0 +1,145 @@
+#include <TableRegistry.hpp>
+
+#include <QFile>
+#include <QDebug>
+
+#include <algorithm>
+
+namespace {
+// How often to check the budget, as tables grow while they load
+constexpr int ENFORCE_INTERVAL_MS = 5000;
+}
+
+TableRegistry::TableRegistry(QObject* parent) : QObject(parent) {
+    enforceTimer.setInterval(ENFORCE_INTERVAL_MS);
+    connect(&enforceTimer, &QTimer::timeout, this, &TableRegistry::enforceBudget);
+    enforceTimer.start();
+}
+
+TableRegistry::~TableRegistry() {}
+
+void TableRegistry::addTable(AbstractTableInterface* table) {
+    if (table == nullptr || lastUse.contains(table))
+        return;
+
+    lastUse.insert(table, ++useCounter);
+    // By the time destroyed is emitted, the table is no longer an AbstractTableInterface, so only use the pointer
+    connect(table, &QObject::destroyed, this, [this, table] { lastUse.remove(table); });
+    // Check the budget once the caller is done setting the table up
+    QTimer::singleShot(0, this, &TableRegistry::enforceBudget);
+}
+
+void TableRegistry::touch(AbstractTableInterface* table) {
+    auto itr = lastUse.find(table);
+    if (itr != lastUse.end())
+        *itr = ++useCounter;
+}
+
+QByteArray TableRegistry::takeSpilled(const QString& tableName, quint64 scope) {
+    auto fileName = spilledFiles.take(Key(tableName, scope));
+    if (fileName.isEmpty())
+        return {};
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "TableRegistry: Failed to read spilled table" << tableName << scope << file.errorString();
+        return {};
+    }
+    auto spilled = file.readAll();
+    file.close();
+    file.remove();
+    return spilled;
+}
+
+void TableRegistry::setBudget(qint64 bytes) {
+    if (memoryBudget == bytes)
+        return;
+    memoryBudget = bytes;
+    enforceBudget();
+}
+
+qint64 TableRegistry::usage() const {
+    qint64 total = 0;
+    for (auto itr = lastUse.begin(); itr != lastUse.end(); ++itr)
+        total += itr.key()->approximateBytes();
+    return total;
+}
+
+void TableRegistry::enforceBudget() {
+    // Measure each table once, and find which can be evicted
+    qint64 total = 0;
+    QList<QPair<quint64, AbstractTableInterface*>> candidates;
+    QHash<AbstractTableInterface*, qint64> sizes;
+    for (auto itr = lastUse.begin(); itr != lastUse.end(); ++itr) {
+        auto* table = itr.key();
+        auto size = table->approximateBytes();
+        total += size;
+        // Tables awaiting rows are kept, as well as those in use, until the rows arrive
+        if (table->modelCount() == 0 && !table->hasLocalEdits() && !table->hasPendingEdits() && !table->isLoading()) {
+            candidates.append(qMakePair(itr.value(), table));
+            sizes.insert(table, size);
+        }
+    }
+    if (total <= memoryBudget)
+        return;
+
+    // Evict the least recently used first
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    int evicted = 0;
+    for (const auto& candidate : candidates) {
+        if (total <= memoryBudget)
+            break;
+        auto* table = candidate.second;
+        if (spill)
+            spillTable(table);
+        total -= sizes[table];
+        lastUse.remove(table);
+        emit tableEvicted(table);
+        table->deleteLater();
+        ++evicted;
+    }
+
+    qInfo() << "TableRegistry: Evicted" << evicted << "tables; now using approximately" << total << "of"
+            << memoryBudget << "bytes";
+    if (total > memoryBudget)
+        qWarning() << "TableRegistry: Tables in use exceed the memory budget";
+}
+
+void TableRegistry::processJournal(QList<JournalEntry> entries) {
+    if (spilledFiles.isEmpty())
+        return;
+    for (const auto& entry : entries) {
+        auto fileName = spilledFiles.take(Key(entry.table, entry.scope));
+        if (!fileName.isEmpty())
+            QFile::remove(fileName);
+    }
+}
+
+void TableRegistry::discardSpilled() {
+    for (const auto& fileName : spilledFiles)
+        QFile::remove(fileName);
+    spilledFiles.clear();
+}
+
+void TableRegistry::spillTable(AbstractTableInterface* table) {
+    if (!spillDir) {
+        spillDir = std::make_unique<QTemporaryDir>();
+        if (!spillDir->isValid()) {
+            qWarning() << "TableRegistry: Unable to create directory to spill tables to:" << spillDir->errorString();
+            spill = false;
+            return;
+        }
+    }
+
+    auto spilled = table->spill();
+    if (spilled.isEmpty())
+        return;
+    Key key(table->tableName(), table->scopeValue());
+    auto fileName = spillDir->filePath(QStringLiteral("%1-%2").arg(key.first, QString::number(key.second)));
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(spilled) != spilled.size()) {
+        qWarning() << "TableRegistry: Failed to spill table" << key.first << key.second << file.errorString();
+        return;
+    }
+    spilledFiles.insert(key, fileName);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <AbstractTableInterface.hpp>
+
+#include <QObject>
+#include <QHash>
+#include <QPair>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include <memory>
+
+/*!
+ * \brief Keeps the memory used by open tables within a budget
+ *
+ * Tables register with the registry, which tracks when each was last used and how much memory each approximately
+ * occupies. When the tables' total exceeds the budget, the least recently used tables are evicted until the total
+ * fits, though only tables with no models, no draft or pending edits and no loads in flight can be evicted.
+ * Optionally, evicted tables are spilled to a compact form on disk, so that reopening them shows their rows
+ * immediately while they refresh.
+ *
+ * The budget is checked whenever a table is added, and periodically thereafter, as tables grow while they load.
+ * Spilled rows are only kept while nothing in the journal touches them, so a restored table never shows rows that
+ * changed while it was evicted.
+ */
+class TableRegistry : public QObject {
+    Q_OBJECT
+
+public:
+    constexpr static qint64 DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+    explicit TableRegistry(QObject* parent = nullptr);
+    virtual ~TableRegistry();
+
+    void addTable(AbstractTableInterface* table);
+    //! Note that a table was used, making it the last to be evicted
+    void touch(AbstractTableInterface* table);
+    /*!
+     * \brief Take the spilled rows of an evicted table, if it was spilled
+     * \return The spilled rows, to pass to AbstractTableInterface::restore, or an empty array if there are none
+     */
+    QByteArray takeSpilled(const QString& tableName, quint64 scope);
+
+    qint64 budget() const { return memoryBudget; }
+    void setBudget(qint64 bytes);
+    bool spillEnabled() const { return spill; }
+    void setSpillEnabled(bool enabled) { spill = enabled; }
+
+    //! The approximate number of bytes used by the registered tables
+    qint64 usage() const;
+    int tableCount() const { return lastUse.size(); }
+
+public slots:
+    //! Evict tables until usage is within budget, if possible
+    void enforceBudget();
+    //! Discard the spilled rows of any table the journal entries change
+    void processJournal(QList<JournalEntry> entries);
+    //! Discard all spilled rows, as when the tables are all being reloaded
+    void discardSpilled();
+
+signals:
+    //! Emitted when a table is evicted, just before it is deleted
+    void tableEvicted(AbstractTableInterface* table);
+
+private:
+    using Key = QPair<QString, quint64>;
+
+    qint64 memoryBudget = DEFAULT_BUDGET;
+    bool spill = true;
+    quint64 useCounter = 0;
+    QHash<AbstractTableInterface*, quint64> lastUse;
+    QHash<Key, QString> spilledFiles;
+    std::unique_ptr<QTemporaryDir> spillDir;
+    QTimer enforceTimer;
+
+    void spillTable(AbstractTableInterface* table);
+};
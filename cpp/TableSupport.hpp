@@ -4,11 +4,19 @@
 
 #include <Strings.hpp>
 #include <Enums.hpp>
+#include <EosioName.hpp>
+#include <InternedStrings.hpp>
 
+#include <QDataStream>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QVariant>
+#include <QHash>
+
+#include <map>
+#include <memory>
+#include <numeric>
 
 class BlockchainInterface;
 
@@ -35,6 +43,54 @@ inline std::optional<QJsonArray> parseRows(QJsonDocument getTableRowsResponse, Q
     return rows.toArray();
 }
 
+/*!
+ * \brief Convert a field value to the form QML sees it in
+ *
+ * Most types are handed over as they are, but compact field types are converted: names to their strings, and
+ * interned string lists to plain string lists.
+ */
+template<typename T>
+QVariant toQml(const T& value) { return QVariant::fromValue(value); }
+inline QVariant toQml(EosioName name) { return name.toString(); }
+inline QVariant toQml(const InternedStringList& list) { return list.toStringList(); }
+
+//! \brief Convert a value from QML, or one produced by \ref toQml, to a field value
+template<typename T>
+T fromQml(const QVariant& value) {
+    if constexpr (std::is_same_v<T, EosioName>) {
+        if (value.metaType() == QMetaType::fromType<EosioName>())
+            return value.value<EosioName>();
+        return EosioName(value.toString());
+    } else if constexpr (std::is_same_v<T, InternedStringList>) {
+        if (value.metaType() == QMetaType::fromType<InternedStringList>())
+            return value.value<InternedStringList>();
+        return InternedStringList(value.toStringList());
+    } else {
+        return value.value<T>();
+    }
+}
+
+//! \brief Format a row ID as a bound for a get_table_rows request
+template<typename Id>
+QString tableKey(const Id& id) {
+    if constexpr (std::is_same_v<Id, QString>)
+        return '"' + id + '"';
+    else if constexpr (std::is_same_v<Id, EosioName>)
+        return '"' + id.toString() + '"';
+    else
+        return QString::number(id);
+}
+//! \brief Get the row ID referred to by the key of a journal entry
+template<typename Id>
+Id rowIdFromKey(uint64_t key) {
+    if constexpr (std::is_same_v<Id, QString>)
+        return eosio::name_to_string(key);
+    else if constexpr (std::is_same_v<Id, EosioName>)
+        return EosioName(key);
+    else
+        return key;
+}
+
 //! \brief Template to convert a reflected struct to/from Qt types
 template<class Struct>
 struct Convert {
@@ -47,7 +103,7 @@ struct Convert {
         Struct result;
         typelist::runtime::for_each(Members(), [&result, &object] (auto MemberWrapper) {
             using Member = typename decltype(MemberWrapper)::type;
-            Member::get(result) = object[QString(Member::get_name())].toVariant().value<typename Member::type>();
+            Member::get(result) = fromQml<typename Member::type>(object[QString(Member::get_name())].toVariant());
         });
         return result;
     }
@@ -56,7 +112,7 @@ struct Convert {
         QJsonObject result;
         typelist::runtime::for_each(Members(), [&result, &record] (auto MemberWrapper) {
             using Member = typename decltype(MemberWrapper)::type;
-            result[QString(Member::get_name())] = QJsonValue::fromVariant(QVariant::fromValue(Member::get(record)));
+            result[QString(Member::get_name())] = QJsonValue::fromVariant(toQml(Member::get(record)));
         });
         return result;
     }
@@ -73,7 +129,7 @@ struct Convert {
         QVariantMap result;
         infra::typelist::runtime::for_each(Members(), [&record, &result](auto Descriptor) {
             using descriptor = typename decltype(Descriptor)::type;
-            result[descriptor::get_name()] = QVariant::fromValue(descriptor::get(record));
+            result[descriptor::get_name()] = toQml(descriptor::get(record));
         });
         return result;
     }
@@ -84,7 +140,7 @@ struct Convert {
             using descriptor = typename decltype (Descriptor)::type;
             auto updateItr = map.find(descriptor::get_name());
             if (updateItr != map.end()) {
-                descriptor::get(result) = updateItr->template value<typename descriptor::type>();
+                descriptor::get(result) = fromQml<typename descriptor::type>(*updateItr);
                 map.erase(updateItr);
             }
         });
@@ -197,6 +253,39 @@ public:
         }
     }
 
+    //! Save backups of many rows at once, in a single pass. Like save(), rows already backed up are not saved again.
+    void saveAll(const QList<Row>& newRows, const QList<LoadState>& newStates) {
+        QList<int> order(newRows.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&newRows](int a, int b) {
+            return newRows[a].getId() < newRows[b].getId();
+        });
+
+        QList<Row> mergedRows;
+        QList<LoadState> mergedStates;
+        mergedRows.reserve(rows.size() + newRows.size());
+        mergedStates.reserve(rows.size() + newRows.size());
+        int i = 0;
+        for (int n : order) {
+            const Row& row = newRows[n];
+            for (; i < rows.size() && rows[i].getId() < row.getId(); ++i) {
+                mergedRows.append(std::move(rows[i]));
+                mergedStates.append(states[i]);
+            }
+            if ((i < rows.size() && rows[i].getId() == row.getId()) ||
+                    (!mergedRows.isEmpty() && mergedRows.last().getId() == row.getId()))
+                continue;
+            mergedRows.append(row);
+            mergedStates.append(newStates[n]);
+        }
+        for (; i < rows.size(); ++i) {
+            mergedRows.append(std::move(rows[i]));
+            mergedStates.append(states[i]);
+        }
+        rows = std::move(mergedRows);
+        states = std::move(mergedStates);
+    }
+
     template<typename Callable, typename Ret = ReturnType<Callable, Row>>
     auto forEach(Callable&& c) const { return std::for_each(rows.begin(), rows.end(), std::forward<Callable>(c)); }
     template<typename Callable, typename Ret = ReturnType<Callable, Row, LoadState, std::function<void()>>>
@@ -208,3 +297,355 @@ public:
         return c;
     }
 };
+
+/*!
+ * \brief The changes to a table's rows made in blocks which are not yet irreversible
+ *
+ * The table holds its rows as of the head block. For each row changed since the irreversible block, the delta holds
+ * the row as it was before the change, or notes that it didn't exist, along with the latest block the row was changed
+ * in. Reading the delta's rows in place of the table's gives the irreversible state of the table.
+ *
+ * As the irreversible block advances, the changes it covers are settled and dropped. If a fork reverts blocks, the
+ * changes from those blocks are taken out to be undone. Either way, only the changed rows are touched.
+ */
+template<class Row>
+class ForkDelta {
+public:
+    struct Change {
+        //! The latest block the row may have been changed in
+        uint64_t block = 0;
+        //! The row as of the irreversible block, or empty if it did not exist then
+        std::optional<Row> base;
+        LoadState baseState = LoadState::Loaded;
+    };
+    using Changes = std::map<RowId<Row>, Change>;
+
+private:
+    Changes changes;
+
+public:
+    bool isEmpty() const { return changes.empty(); }
+    int size() const { return int(changes.size()); }
+    const Changes& getChanges() const { return changes; }
+    void clear() { changes.clear(); }
+
+    const Change* find(RowId<Row> id) const {
+        auto itr = changes.find(id);
+        return itr == changes.end()? nullptr : &itr->second;
+    }
+    bool contains(RowId<Row> id) const { return changes.count(id) > 0; }
+
+    //! Note that a row changed in a block. The base is only recorded for the row's first change, as the row may have
+    //! already changed since the irreversible block.
+    void record(RowId<Row> id, uint64_t block, std::optional<Row> base, LoadState baseState) {
+        auto [itr, inserted] = changes.try_emplace(id);
+        if (inserted) {
+            itr->second.base = std::move(base);
+            itr->second.baseState = baseState;
+        }
+        itr->second.block = std::max(itr->second.block, block);
+    }
+
+    //! Drop the changes made in the irreversible block or before, returning the IDs of the rows they changed
+    QList<RowId<Row>> settle(uint64_t irreversibleBlock) {
+        QList<RowId<Row>> settled;
+        for (auto itr = changes.begin(); itr != changes.end();) {
+            if (itr->second.block <= irreversibleBlock) {
+                settled.append(itr->first);
+                itr = changes.erase(itr);
+            } else {
+                ++itr;
+            }
+        }
+        return settled;
+    }
+
+    //! Take out the changes which may have been made in the first reverted block or after
+    Changes takeReverted(uint64_t firstRevertedBlock) {
+        Changes reverted;
+        for (auto itr = changes.begin(); itr != changes.end();) {
+            if (itr->second.block >= firstRevertedBlock)
+                reverted.insert(changes.extract(itr++));
+            else
+                ++itr;
+        }
+        return reverted;
+    }
+};
+
+/*!
+ * \brief An immutable copy of a table's rows at some point in time
+ *
+ * Snapshots are published by the table on its own thread, and may be read from any thread.
+ */
+template<class Row>
+struct TableSnapshot {
+    //! Incremented with each snapshot a table publishes; 0 for the empty snapshot before the first
+    quint64 version = 0;
+    uint64_t scope = 0;
+    //! The rows as of the head block, sorted by ID
+    QList<Row> rows;
+    //! The load state of each row, parallel to rows
+    QVector<LoadState> states;
+    //! The changes to the rows since the irreversible block, if any
+    std::shared_ptr<const ForkDelta<Row>> delta;
+
+    const Row* getRow(RowId<Row> id, LoadState* rowState = nullptr) const {
+        auto pos = std::lower_bound(rows.begin(), rows.end(), id, CompareId<Row>());
+        if (pos != rows.end() && pos->getId() == id) {
+            if (rowState != nullptr)
+                *rowState = states[pos - rows.begin()];
+            return &*pos;
+        }
+        return nullptr;
+    }
+    //! Get a row as of the irreversible block, or null if it did not exist then
+    const Row* getIrreversibleRow(RowId<Row> id, LoadState* rowState = nullptr) const {
+        if (const auto* change = delta? delta->find(id) : nullptr) {
+            if (change->base.has_value() && rowState != nullptr)
+                *rowState = change->baseState;
+            return change->base.has_value()? &*change->base : nullptr;
+        }
+        return getRow(id, rowState);
+    }
+};
+
+//! Approximate overhead of a node in a std::map or QMap, beyond its key and value, for memory accounting
+constexpr qint64 MAP_NODE_BYTES = 48;
+
+//! \brief Approximate the memory used by a value, including any it holds on the heap, for memory accounting
+template<typename T>
+qint64 approximateValueBytes(const T&) { return sizeof(T); }
+inline qint64 approximateValueBytes(const QString& string) {
+    if (string.capacity() == 0)
+        return sizeof(QString);
+    return sizeof(QString) + sizeof(QArrayData) + string.capacity() * sizeof(QChar);
+}
+template<typename T>
+qint64 approximateValueBytes(const QList<T>& list) {
+    if (list.capacity() == 0)
+        return sizeof(QList<T>);
+    qint64 total = sizeof(QList<T>) + sizeof(QArrayData) + (list.capacity() - list.size()) * sizeof(T);
+    for (const T& item : list)
+        total += approximateValueBytes(item);
+    return total;
+}
+// The strings are shared by all lists, so only the list's own IDs are counted
+inline qint64 approximateValueBytes(const InternedStringList& list) { return approximateValueBytes(list.idList()); }
+
+//! \brief Approximate the memory used by a row, including the heap memory of its fields
+template<class Row>
+qint64 approximateRowBytes(const Row& row) {
+    qint64 total = sizeof(Row);
+    infra::typelist::runtime::for_each(typename infra::reflector<Row>::members(), [&row, &total](auto Descriptor) {
+        using descriptor = typename decltype(Descriptor)::type;
+        total += approximateValueBytes(descriptor::get(row)) - qint64(sizeof(typename descriptor::type));
+    });
+    return total;
+}
+
+/*!
+ * \brief Approximate the memory used by a list of rows
+ *
+ * Long lists are estimated from an even sample of their rows rather than measured in full, as the registry measures
+ * every table periodically, and some tables have millions of rows.
+ */
+template<class Row>
+qint64 approximateRowListBytes(const QList<Row>& rows) {
+    constexpr qsizetype SAMPLE_SIZE = 256;
+    qint64 total = sizeof(QList<Row>);
+    if (rows.capacity() == 0)
+        return total;
+    total += sizeof(QArrayData) + (rows.capacity() - rows.size()) * sizeof(Row);
+
+    if (rows.size() <= SAMPLE_SIZE) {
+        for (const Row& row : rows)
+            total += approximateRowBytes(row);
+        return total;
+    }
+    qint64 sampled = 0;
+    const qsizetype step = rows.size() / SAMPLE_SIZE;
+    for (qsizetype i = 0; i < SAMPLE_SIZE; ++i)
+        sampled += approximateRowBytes(rows[i * step]);
+    return total + sampled * rows.size() / SAMPLE_SIZE;
+}
+
+//! \brief Write a row field to a QDataStream, widening integers so that every integer type has an operator
+template<typename T>
+void writeField(QDataStream& stream, const T& value) {
+    if constexpr (std::is_integral_v<T>)
+        stream << std::conditional_t<std::is_signed_v<T>, qint64, quint64>(value);
+    else
+        stream << value;
+}
+//! \brief Read a row field written by \ref writeField
+template<typename T>
+void readField(QDataStream& stream, T& value) {
+    if constexpr (std::is_integral_v<T>) {
+        std::conditional_t<std::is_signed_v<T>, qint64, quint64> wide = 0;
+        stream >> wide;
+        value = T(wide);
+    } else {
+        stream >> value;
+    }
+}
+
+//! Whether a field type can be hashed with qHash
+template<typename T, typename = void>
+struct IsQHashable : std::false_type {};
+template<typename T>
+struct IsQHashable<T, std::void_t<decltype(qHash(std::declval<const T&>(), size_t()))>> : std::true_type {};
+
+/*!
+ * \brief This template tracks the locally added rows awaiting their arrival from the backend
+ *
+ * Each pending insertion is a QVariantMap of the fields the insertion specified. A row from the backend matches a
+ * pending insertion if every field specified in the insertion equals the row's value for that field. To find
+ * matches without comparing every incoming row against every pending insertion, insertions are indexed by a hash of
+ * their specified fields, grouped by which fields are specified. Candidates are then verified exactly.
+ */
+template<class Row>
+class PendingInsertions {
+    using Fields = typename infra::reflector<Row>::members;
+    static_assert(infra::typelist::length<Fields>() <= 64, "Specified fields are stored as a 64-bit mask");
+    using Id = RowId<Row>;
+
+    struct Insertion {
+        QVariantMap fields;
+        uint64_t fieldMask;
+        size_t hash;
+        // Insertions are matched in the order they were added
+        quint64 order;
+    };
+    QHash<Id, Insertion> insertions;
+    // Draft IDs of the insertions, by the mask of their specified fields, then by their hash
+    QHash<uint64_t, QMultiHash<size_t, Id>> index;
+    quint64 nextOrder = 0;
+
+    template<typename T>
+    static size_t hashField(const T& value) {
+        // Fields we can't hash are left out of the hash, and only checked when verifying a candidate
+        if constexpr (IsQHashable<T>::value)
+            return qHash(value, size_t(0));
+        else
+            return 0;
+    }
+    static size_t combine(size_t seed, size_t hash) {
+        return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    }
+
+    // Hash the specified fields of an insertion, and find which fields those are
+    static size_t hashFields(const QVariantMap& fields, uint64_t& fieldMask) {
+        size_t seed = 0;
+        fieldMask = 0;
+        int i = 0;
+        infra::typelist::runtime::for_each(Fields(), [&fields, &fieldMask, &seed, &i](auto Descriptor) {
+            using descriptor = typename decltype(Descriptor)::type;
+            auto itr = fields.find(QString(descriptor::get_name()));
+            if (itr != fields.end()) {
+                fieldMask |= uint64_t(1) << i;
+                seed = combine(seed, hashField(fromQml<typename descriptor::type>(*itr)));
+            }
+            ++i;
+        });
+        return seed;
+    }
+    // Hash the fields of a row which are in the mask
+    static size_t hashRow(const Row& row, uint64_t fieldMask) {
+        size_t seed = 0;
+        int i = 0;
+        infra::typelist::runtime::for_each(Fields(), [&row, fieldMask, &seed, &i](auto Descriptor) {
+            using descriptor = typename decltype(Descriptor)::type;
+            if (fieldMask & (uint64_t(1) << i))
+                seed = combine(seed, hashField(descriptor::get(row)));
+            ++i;
+        });
+        return seed;
+    }
+    static bool matches(const QVariantMap& fields, const Row& row) {
+        return infra::typelist::runtime::all_of(Fields(), [&row, &fields] (auto Descriptor) {
+            using descriptor = typename decltype(Descriptor)::type;
+            auto itr = fields.find(QString(descriptor::get_name()));
+            if (itr != fields.end())
+                return fromQml<typename descriptor::type>(*itr) == descriptor::get(row);
+            return true;
+        });
+    }
+
+    void unindex(Id draftId, const Insertion& insertion) {
+        auto bucket = index.find(insertion.fieldMask);
+        if (bucket == index.end())
+            return;
+        bucket->remove(insertion.hash, draftId);
+        if (bucket->isEmpty())
+            index.erase(bucket);
+    }
+    void reindex(Id draftId, Insertion& insertion) {
+        insertion.hash = hashFields(insertion.fields, insertion.fieldMask);
+        index[insertion.fieldMask].insert(insertion.hash, draftId);
+    }
+
+public:
+    bool isEmpty() const { return insertions.isEmpty(); }
+    int size() const { return insertions.size(); }
+    void clear() { insertions.clear(); index.clear(); }
+
+    //! Add a pending insertion with the given draft ID, specifying the given fields
+    void add(Id draftId, QVariantMap fields) {
+        remove(draftId);
+        Insertion& insertion = insertions[draftId] = Insertion{std::move(fields), 0, 0, nextOrder++};
+        reindex(draftId, insertion);
+    }
+    //! Update the values of the fields an insertion specifies, from the changes. Unspecified fields stay unspecified.
+    void update(Id draftId, const QVariantMap& changes) {
+        auto itr = insertions.find(draftId);
+        if (itr == insertions.end())
+            return;
+        unindex(draftId, *itr);
+        for (auto change = changes.begin(); change != changes.end(); ++change) {
+            auto field = itr->fields.find(change.key());
+            if (field != itr->fields.end())
+                *field = change.value();
+        }
+        reindex(draftId, *itr);
+    }
+    bool remove(Id draftId) {
+        auto itr = insertions.find(draftId);
+        if (itr == insertions.end())
+            return false;
+        unindex(draftId, *itr);
+        insertions.erase(itr);
+        return true;
+    }
+
+    /*!
+     * \brief Find the earliest added insertion which the row matches, and remove it
+     * \param row The row to match
+     * \param otherMatches Optional parameter. If provided, set to the number of other insertions the row matched
+     * \return The fields of the matching insertion, if any
+     */
+    std::optional<QVariantMap> takeMatch(const Row& row, int* otherMatches = nullptr) {
+        std::optional<Id> best;
+        int matchCount = 0;
+        for (auto bucket = index.begin(); bucket != index.end(); ++bucket) {
+            auto hash = hashRow(row, bucket.key());
+            for (auto candidate = bucket->find(hash); candidate != bucket->end() && candidate.key() == hash;
+                 ++candidate) {
+                auto insertion = insertions.constFind(candidate.value());
+                if (insertion == insertions.cend() || !matches(insertion->fields, row))
+                    continue;
+                ++matchCount;
+                if (!best || insertion->order < insertions.value(*best).order)
+                    best = candidate.value();
+            }
+        }
+        if (otherMatches != nullptr)
+            *otherMatches = std::max(0, matchCount - 1);
+        if (!best)
+            return {};
+
+        auto fields = insertions[*best].fields;
+        remove(*best);
+        return fields;
+    }
+};
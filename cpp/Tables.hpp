@@ -11,12 +11,12 @@ class BlockchainInterface;
 
 //! \brief A row in the backend's group.accts table
 struct GroupMember {
-    QString account;
+    EosioName account;
     uint32_t weight;
-    QStringList tags;
+    InternedStringList tags;
 
-    QString getId() const { return account; }
-    void setId(QString id) { account = id; }
+    EosioName getId() const { return account; }
+    void setId(EosioName id) { account = id; }
 
     bool operator==(const GroupMember& b) const {
         return std::tie(account, weight, tags) == std::tie(b.account, b.weight, b.tags);
@@ -29,7 +29,7 @@ REFLECT_STRUCT(GroupMember, (account)(weight)(tags))
 struct PollingGroup {
     uint64_t id;
     QString name;
-    QStringList tags;
+    InternedStringList tags;
 
     uint64_t getId() const { return id; }
     void setId(uint64_t id) { this->id = id; }
@@ -61,6 +61,12 @@ template<> struct TableName<GroupMember> {
     static const bool defined = true;
     constexpr static const QString* name = &Strings::GroupAccts;
 };
+// On chain, a group.accts row is {name account; uint32 weight; vector<string> tags}
+template<> struct BinaryRows<GroupMember> : std::true_type {};
+template<> struct RowTags<GroupMember> {
+    static const bool defined = true;
+    static const InternedStringList& get(const GroupMember& row) { return row.tags; }
+};
 using GroupMembersTable = AbstractTable<GroupMember>;
 
 /*!
@@ -70,6 +76,56 @@ class PollingGroupSizeField : public VirtualFieldInterface<PollingGroupSizeField
     using Base = VirtualFieldInterface<PollingGroupSizeField, QVariant, PollingGroup>;
 
     int64_t value = -1;
+    quint64 groupId = 0;
+
+    // Follow the size of the group's members table. No model is opened on the table, so the table registry may
+    // evict it; the last size is kept, and the table opened again, once the journal changes the group's members.
+    void followTable(std::function<void()> signal) {
+        auto table = blockchain->getGroupMembersTable(groupId);
+        if (table == nullptr) {
+            qCritical("PollingGroupSizeField: Failed to get group members table");
+            return;
+        }
+        // The context of the connections to the table, so they're broken if this field goes first
+        auto context = new QObject;
+        addChild(context);
+
+        // When the table changes, recount it and cache the count before emitting the signal
+        auto onChanged = [this, table, signal] {
+            // A table still loading its first rows has no size yet
+            if (table->isLoading() && table->countRows() == 0)
+                return;
+            value = table->countRows();
+            signal();
+        };
+        QObject::connect(table, &AbstractTableInterface::snapshotPublished, context, onChanged);
+        // A pending group's table is rescoped to the group's real ID once the group is added
+        QObject::connect(table, &AbstractTableInterface::scopeChanged, context,
+                         [this, table] { groupId = table->scopeValue(); });
+        QObject::connect(table, &QObject::destroyed, context, [this, context, signal] {
+            followJournal(signal);
+            context->deleteLater();
+        });
+
+        if (table->countRows() == 0 && !table->isLoading())
+            table->fullRefresh();
+        onChanged();
+    }
+    // Wait for the journal to change the members of the group whose table was evicted, then follow the table again
+    void followJournal(std::function<void()> signal) {
+        auto context = new QObject;
+        addChild(context);
+        QObject::connect(blockchain, &BlockchainInterface::newJournalEntries, context,
+                         [this, context, signal](QList<JournalEntry> entries) {
+            if (std::none_of(entries.begin(), entries.end(), [this](const JournalEntry& entry) {
+                    return entry.table == Strings::GroupAccts && entry.scope == groupId;
+                }))
+                return;
+            QObject::disconnect(blockchain, nullptr, context, nullptr);
+            context->deleteLater();
+            followTable(signal);
+        });
+    }
 
 public:
     using Type = QVariant;
@@ -85,32 +141,12 @@ public:
         // If row is not yet loaded, the ID might not be valid yet. Wait until we're called again when it's loaded
         if (groupState == LoadState::Loading) return;
 
-        // Get the group members table for this polling group ID
-        auto table = dynamic_cast<GroupMembersTable*>(blockchain->getGroupMembersTable(group.id));
-        if (table == nullptr) {
-            qCritical("Failed to cast AbstractTableInterface to GroupMembersTable");
-            return;
-        }
-        // Get a model for all rows in the table
-        auto model = table->allRows();
-
-        // When the value changes, recalculate it and cache it before emitting the signal
-        auto onChanged = [this, signal=std::move(signal), model] {
-            value = model->rowCount(QModelIndex());
-            signal();
-        };
-        // If rows are inserted or removed from the model, that changes the polling group size
-        QObject::connect(model, &QAbstractListModel::rowsInserted, onChanged);
-        QObject::connect(model, &QAbstractListModel::rowsRemoved, onChanged);
-        // Save the model. When this field is destroyed, model will be too.
-        addChild(model);
-
-        // Update the cached value now
-        onChanged();
+        groupId = group.id;
+        followTable(std::forward<ChangedSignal>(signal));
     }
 
     QPair<Type, LoadState> get(const PollingGroup&, LoadState groupState) {
-        if (groupState == LoadState::Loading || children.isEmpty())
+        if (groupState == LoadState::Loading || value < 0)
             return qMakePair(QVariant(), LoadState::Loading);
 
         return qMakePair(QVariant::fromValue(value), groupState);
@@ -132,6 +168,12 @@ template<> struct TableName<PollingGroup> {
     static const bool defined = true;
     constexpr static const QString* name = &Strings::PollGroups;
 };
+// On chain, a poll.groups row is {uint64 id; string name; vector<string> tags}
+template<> struct BinaryRows<PollingGroup> : std::true_type {};
+template<> struct RowTags<PollingGroup> {
+    static const bool defined = true;
+    static const InternedStringList& get(const PollingGroup& row) { return row.tags; }
+};
 template<>
 struct VirtualFields<PollingGroup> { using type = infra::typelist::list<PollingGroupSizeField>; };
 using PollingGroupsTable = AbstractTable<PollingGroup>;
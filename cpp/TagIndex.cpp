@@ -0,0 +1,479 @@
+#include <TagIndex.hpp>
+
+#include <QDebug>
+
+#include <iterator>
+
+// ---------------------------------------------------------------------------------------------------------------------
+// RoaringBitmap
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool RoaringBitmap::Container::contains(quint16 value) const {
+    if (isBitmap())
+        return (words[value >> 6] >> (value & 63)) & 1;
+    return std::binary_search(array.begin(), array.end(), value);
+}
+
+void RoaringBitmap::Container::add(quint16 value) {
+    if (isBitmap()) {
+        auto& word = words[value >> 6];
+        auto bit = quint64(1) << (value & 63);
+        if (!(word & bit)) {
+            word |= bit;
+            ++cardinality;
+        }
+        return;
+    }
+    auto pos = std::lower_bound(array.begin(), array.end(), value);
+    if (pos != array.end() && *pos == value)
+        return;
+    array.insert(pos, value);
+    ++cardinality;
+    normalize();
+}
+
+void RoaringBitmap::Container::remove(quint16 value) {
+    if (isBitmap()) {
+        auto& word = words[value >> 6];
+        auto bit = quint64(1) << (value & 63);
+        if (word & bit) {
+            word &= ~bit;
+            --cardinality;
+            normalize();
+        }
+        return;
+    }
+    auto pos = std::lower_bound(array.begin(), array.end(), value);
+    if (pos != array.end() && *pos == value) {
+        array.erase(pos);
+        --cardinality;
+    }
+}
+
+void RoaringBitmap::Container::normalize() {
+    if (isBitmap() && cardinality <= ARRAY_MAX)
+        toArray();
+    else if (!isBitmap() && cardinality > ARRAY_MAX)
+        toBitmap();
+}
+
+void RoaringBitmap::Container::toBitmap() {
+    words.assign(WORDS, 0);
+    for (auto value : array)
+        words[value >> 6] |= quint64(1) << (value & 63);
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::toArray() {
+    array.clear();
+    array.reserve(cardinality);
+    for (int i = 0; i < WORDS; ++i)
+        for (quint64 word = words[i]; word != 0; word &= word - 1)
+            array.push_back(quint16(i * 64 + qCountTrailingZeroBits(word)));
+    words.clear();
+    words.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::recount() {
+    cardinality = 0;
+    for (auto word : words)
+        cardinality += qPopulationCount(word);
+}
+
+RoaringBitmap::Container RoaringBitmap::Container::intersect(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+        result.words.resize(WORDS);
+        for (int i = 0; i < WORDS; ++i)
+            result.words[i] = a.words[i] & b.words[i];
+        result.recount();
+        result.normalize();
+    } else if (a.isBitmap() || b.isBitmap()) {
+        const auto& sparse = a.isBitmap()? b : a;
+        const auto& dense = a.isBitmap()? a : b;
+        result.array.reserve(sparse.cardinality);
+        for (auto value : sparse.array)
+            if (dense.contains(value))
+                result.array.push_back(value);
+        result.cardinality = result.array.size();
+    } else {
+        result.array.reserve(std::min(a.cardinality, b.cardinality));
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(result.array));
+        result.cardinality = result.array.size();
+    }
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::Container::unite(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() || b.isBitmap()) {
+        const auto& dense = a.isBitmap()? a : b;
+        const auto& other = a.isBitmap()? b : a;
+        result.words = dense.words;
+        if (other.isBitmap()) {
+            for (int i = 0; i < WORDS; ++i)
+                result.words[i] |= other.words[i];
+        } else {
+            for (auto value : other.array)
+                result.words[value >> 6] |= quint64(1) << (value & 63);
+        }
+        result.recount();
+    } else {
+        result.array.reserve(a.cardinality + b.cardinality);
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                       std::back_inserter(result.array));
+        result.cardinality = result.array.size();
+        result.normalize();
+    }
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::Container::subtract(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap()) {
+        result.words = a.words;
+        if (b.isBitmap()) {
+            for (int i = 0; i < WORDS; ++i)
+                result.words[i] &= ~b.words[i];
+        } else {
+            for (auto value : b.array)
+                result.words[value >> 6] &= ~(quint64(1) << (value & 63));
+        }
+        result.recount();
+        result.normalize();
+    } else {
+        result.array.reserve(a.cardinality);
+        for (auto value : a.array)
+            if (!b.contains(value))
+                result.array.push_back(value);
+        result.cardinality = result.array.size();
+    }
+    return result;
+}
+
+std::vector<RoaringBitmap::Container>::iterator RoaringBitmap::find(quint16 key) {
+    return std::lower_bound(containers.begin(), containers.end(), key,
+                            [](const Container& c, quint16 key) { return c.key < key; });
+}
+
+std::vector<RoaringBitmap::Container>::const_iterator RoaringBitmap::find(quint16 key) const {
+    return std::lower_bound(containers.begin(), containers.end(), key,
+                            [](const Container& c, quint16 key) { return c.key < key; });
+}
+
+void RoaringBitmap::add(quint32 value) {
+    quint16 key = value >> 16;
+    auto pos = find(key);
+    if (pos == containers.end() || pos->key != key) {
+        pos = containers.emplace(pos);
+        pos->key = key;
+    }
+    pos->add(quint16(value));
+}
+
+void RoaringBitmap::remove(quint32 value) {
+    quint16 key = value >> 16;
+    auto pos = find(key);
+    if (pos == containers.end() || pos->key != key)
+        return;
+    pos->remove(quint16(value));
+    if (pos->cardinality == 0)
+        containers.erase(pos);
+}
+
+bool RoaringBitmap::contains(quint32 value) const {
+    quint16 key = value >> 16;
+    auto pos = find(key);
+    return pos != containers.end() && pos->key == key && pos->contains(quint16(value));
+}
+
+quint64 RoaringBitmap::count() const {
+    quint64 total = 0;
+    for (const auto& container : containers)
+        total += container.cardinality;
+    return total;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+    std::vector<Container> result;
+    auto a = containers.begin();
+    auto b = other.containers.begin();
+    while (a != containers.end() && b != other.containers.end()) {
+        if (a->key < b->key) {
+            ++a;
+        } else if (b->key < a->key) {
+            ++b;
+        } else {
+            auto both = Container::intersect(*a, *b);
+            if (both.cardinality > 0)
+                result.push_back(std::move(both));
+            ++a, ++b;
+        }
+    }
+    containers = std::move(result);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+    std::vector<Container> result;
+    result.reserve(containers.size() + other.containers.size());
+    auto a = containers.begin();
+    auto b = other.containers.begin();
+    while (a != containers.end() || b != other.containers.end()) {
+        if (b == other.containers.end() || (a != containers.end() && a->key < b->key)) {
+            result.push_back(std::move(*a++));
+        } else if (a == containers.end() || b->key < a->key) {
+            result.push_back(*b++);
+        } else {
+            result.push_back(Container::unite(*a, *b));
+            ++a, ++b;
+        }
+    }
+    containers = std::move(result);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator-=(const RoaringBitmap& other) {
+    std::vector<Container> result;
+    result.reserve(containers.size());
+    auto b = other.containers.begin();
+    for (auto& container : containers) {
+        while (b != other.containers.end() && b->key < container.key)
+            ++b;
+        if (b == other.containers.end() || b->key != container.key) {
+            result.push_back(std::move(container));
+            continue;
+        }
+        auto rest = Container::subtract(container, *b);
+        if (rest.cardinality > 0)
+            result.push_back(std::move(rest));
+    }
+    containers = std::move(result);
+    return *this;
+}
+
+QList<quint32> RoaringBitmap::toList() const {
+    QList<quint32> result;
+    result.reserve(count());
+    forEach([&result](quint32 value) { result.append(value); });
+    return result;
+}
+
+qint64 RoaringBitmap::approximateBytes() const {
+    qint64 total = sizeof(*this) + qint64(containers.capacity()) * sizeof(Container);
+    for (const auto& container : containers)
+        total += qint64(container.array.capacity()) * sizeof(quint16)
+                + qint64(container.words.capacity()) * sizeof(quint64);
+    return total;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// TagExpression
+// ---------------------------------------------------------------------------------------------------------------------
+
+// A recursive descent parser for tag expressions:
+//   or    := and ('|' and)*
+//   and   := unary ('&' unary)*
+//   unary := '!' unary | '(' or ')' | tag
+class TagExpressionParser {
+    const QString& text;
+    int pos = 0;
+    TagExpression& expression;
+    QString error;
+
+    static bool isTagChar(QChar c) {
+        return !c.isSpace() && c != '&' && c != '|' && c != '!' && c != '(' && c != ')' && c != '"';
+    }
+    void skipSpace() {
+        while (pos < text.size() && text[pos].isSpace())
+            ++pos;
+    }
+    bool accept(QChar c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+    int fail(QString message) {
+        if (error.isEmpty())
+            error = QStringLiteral("%1 at position %2").arg(message).arg(pos);
+        return -1;
+    }
+    int addNode(TagExpression::Node::Type type, std::vector<int> children = {}, QString tag = {}) {
+        expression.nodes.push_back(TagExpression::Node{type, std::move(children), std::move(tag), {}});
+        return int(expression.nodes.size()) - 1;
+    }
+
+    int parseOr() {
+        std::vector<int> terms;
+        do {
+            auto term = parseAnd();
+            if (term < 0)
+                return -1;
+            terms.push_back(term);
+        } while (accept('|'));
+        return terms.size() == 1? terms.front() : addNode(TagExpression::Node::Or, std::move(terms));
+    }
+    int parseAnd() {
+        std::vector<int> terms;
+        do {
+            auto term = parseUnary();
+            if (term < 0)
+                return -1;
+            terms.push_back(term);
+        } while (accept('&'));
+        return terms.size() == 1? terms.front() : addNode(TagExpression::Node::And, std::move(terms));
+    }
+    int parseUnary() {
+        if (accept('!')) {
+            auto operand = parseUnary();
+            if (operand < 0)
+                return -1;
+            return addNode(TagExpression::Node::Not, {operand});
+        }
+        if (accept('(')) {
+            auto inner = parseOr();
+            if (inner < 0)
+                return -1;
+            if (!accept(')'))
+                return fail(QStringLiteral("Expected )"));
+            return inner;
+        }
+        return parseTag();
+    }
+    int parseTag() {
+        skipSpace();
+        QString tag;
+        if (accept('"')) {
+            auto end = text.indexOf('"', pos);
+            if (end < 0)
+                return fail(QStringLiteral("Unterminated quoted tag"));
+            tag = text.mid(pos, end - pos);
+            pos = end + 1;
+        } else {
+            auto start = pos;
+            while (pos < text.size() && isTagChar(text[pos]))
+                ++pos;
+            if (pos == start)
+                return fail(pos < text.size()? QStringLiteral("Unexpected %1").arg(text[pos])
+                                             : QStringLiteral("Expected a tag"));
+            tag = text.mid(start, pos - start);
+        }
+        // Keep the tag as text rather than interning it, so typing filters doesn't fill the intern table. It's looked
+        // up when the expression is evaluated, so a live filter matches rows which gain the tag later.
+        return addNode(TagExpression::Node::Tag, {}, std::move(tag));
+    }
+
+public:
+    TagExpressionParser(const QString& text, TagExpression& expression) : text(text), expression(expression) {}
+
+    QString parse() {
+        auto root = parseOr();
+        skipSpace();
+        if (root >= 0 && pos < text.size())
+            root = fail(QStringLiteral("Unexpected %1").arg(text[pos]));
+        expression.root = root;
+        if (root < 0)
+            expression.nodes.clear();
+        return error;
+    }
+};
+
+TagExpression TagExpression::parse(const QString& text, QString* error) {
+    TagExpression expression;
+    auto message = TagExpressionParser(text, expression).parse();
+    if (error != nullptr)
+        *error = message;
+    return expression;
+}
+
+bool TagExpression::matches(const InternedStringList& tags) const {
+    if (!isValid())
+        return false;
+    return matches(root, tags.idList());
+}
+
+std::optional<quint32> TagExpression::resolveTag(const Node& node) const {
+    if (!node.tagId.has_value())
+        node.tagId = InternedStringList::find(node.tag);
+    return node.tagId;
+}
+
+bool TagExpression::matches(int node, const QList<quint32>& tags) const {
+    const auto& n = nodes[node];
+    switch (n.type) {
+    case Node::Tag: {
+        auto id = resolveTag(n);
+        return id.has_value() && tags.contains(*id);
+    }
+    case Node::Not:
+        return !matches(n.children.front(), tags);
+    case Node::And:
+        return std::all_of(n.children.begin(), n.children.end(), [this, &tags](int c) { return matches(c, tags); });
+    case Node::Or:
+        return std::any_of(n.children.begin(), n.children.end(), [this, &tags](int c) { return matches(c, tags); });
+    }
+    return false;
+}
+
+RoaringBitmap TagExpression::evaluate(const std::function<const RoaringBitmap*(quint32)>& tagRows,
+                                      const RoaringBitmap& allRows) const {
+    if (!isValid())
+        return {};
+    return evaluate(root, tagRows, allRows);
+}
+
+RoaringBitmap TagExpression::evaluate(int node, const std::function<const RoaringBitmap*(quint32)>& tagRows,
+                                      const RoaringBitmap& allRows) const {
+    const auto& n = nodes[node];
+    switch (n.type) {
+    case Node::Tag: {
+        auto id = resolveTag(n);
+        if (!id.has_value())
+            return {};
+        auto rows = tagRows(*id);
+        return rows == nullptr? RoaringBitmap() : *rows;
+    }
+    case Node::Not: {
+        auto result = allRows;
+        result -= evaluate(n.children.front(), tagRows, allRows);
+        return result;
+    }
+    case Node::And: {
+        // Intersect the positive terms, smallest first so the working set shrinks fast, then subtract the negated
+        // terms directly rather than complementing them against all rows
+        std::vector<RoaringBitmap> positive, negative;
+        for (int child : n.children) {
+            if (nodes[child].type == Node::Not)
+                negative.push_back(evaluate(nodes[child].children.front(), tagRows, allRows));
+            else
+                positive.push_back(evaluate(child, tagRows, allRows));
+        }
+        std::sort(positive.begin(), positive.end(),
+                  [](const RoaringBitmap& a, const RoaringBitmap& b) { return a.count() < b.count(); });
+        RoaringBitmap result = positive.empty()? allRows : std::move(positive.front());
+        for (size_t i = 1; i < positive.size() && !result.isEmpty(); ++i)
+            result &= positive[i];
+        for (const auto& excluded : negative) {
+            if (result.isEmpty())
+                break;
+            result -= excluded;
+        }
+        return result;
+    }
+    case Node::Or: {
+        RoaringBitmap result;
+        for (int child : n.children)
+            result |= evaluate(child, tagRows, allRows);
+        return result;
+    }
+    }
+    return {};
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <InternedStrings.hpp>
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <vector>
+
+/*!
+ * \brief A compressed set of 32-bit integers, in the style of a roaring bitmap
+ *
+ * Values are grouped into chunks of 65536 by their high 16 bits, and each chunk present is stored in a container
+ * suited to its density. A sparse chunk is a sorted array of the values' low 16 bits; once it holds more than 4096
+ * values, it becomes a bitmap of 1024 64-bit words, which is no larger than the array would be by then. Set operations
+ * between bitmap containers work a word at a time.
+ */
+class RoaringBitmap {
+public:
+    void add(quint32 value);
+    void remove(quint32 value);
+    bool contains(quint32 value) const;
+    quint64 count() const;
+    bool isEmpty() const { return containers.empty(); }
+    void clear() { containers.clear(); }
+
+    //! Keep only the values also in other
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    //! Add the values in other
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+    //! Remove the values in other
+    RoaringBitmap& operator-=(const RoaringBitmap& other);
+
+    //! Call f with each value, in ascending order
+    template<typename Callback>
+    void forEach(Callback&& f) const;
+    QList<quint32> toList() const;
+
+    qint64 approximateBytes() const;
+
+private:
+    constexpr static quint32 ARRAY_MAX = 4096;
+    constexpr static int WORDS = 1024;
+
+    struct Container {
+        quint16 key = 0;
+        quint32 cardinality = 0;
+        // The values, if the container is an array
+        std::vector<quint16> array;
+        // The bits of the values, if the container is a bitmap
+        std::vector<quint64> words;
+
+        bool isBitmap() const { return !words.empty(); }
+        bool contains(quint16 value) const;
+        void add(quint16 value);
+        void remove(quint16 value);
+        // Switch to whichever representation suits the cardinality
+        void normalize();
+        void toBitmap();
+        void toArray();
+        void recount();
+
+        static Container intersect(const Container& a, const Container& b);
+        static Container unite(const Container& a, const Container& b);
+        static Container subtract(const Container& a, const Container& b);
+    };
+    // Sorted by key
+    std::vector<Container> containers;
+
+    std::vector<Container>::iterator find(quint16 key);
+    std::vector<Container>::const_iterator find(quint16 key) const;
+};
+
+template<typename Callback>
+void RoaringBitmap::forEach(Callback&& f) const {
+    for (const auto& container : containers) {
+        quint32 base = quint32(container.key) << 16;
+        if (container.isBitmap()) {
+            for (int i = 0; i < WORDS; ++i)
+                for (quint64 word = container.words[i]; word != 0; word &= word - 1)
+                    f(base | quint32(i * 64 + qCountTrailingZeroBits(word)));
+        } else {
+            for (auto value : container.array)
+                f(base | value);
+        }
+    }
+}
+
+/*!
+ * \brief A boolean expression of tags, such as `board & !observer | staff`
+ *
+ * Tags are combined with & (and), | (or) and ! (not), which bind in the usual order: ! tightest, then &, then |.
+ * Parentheses group subexpressions. Tags containing spaces or operator characters may be quoted with double quotes.
+ */
+class TagExpression {
+public:
+    //! Parse an expression. If it is not valid, the result is invalid and error, if provided, explains why.
+    static TagExpression parse(const QString& text, QString* error = nullptr);
+
+    bool isValid() const { return root >= 0; }
+    //! Check whether a single row's tags match the expression
+    bool matches(const InternedStringList& tags) const;
+    /*!
+     * \brief Evaluate the expression over an index of tags
+     * \param tagRows Gets the set of rows having a tag, given its interned ID, or null if no rows have it
+     * \param allRows The set of all rows, which negations are taken against
+     */
+    RoaringBitmap evaluate(const std::function<const RoaringBitmap*(quint32)>& tagRows,
+                           const RoaringBitmap& allRows) const;
+
+private:
+    struct Node {
+        enum Type { Tag, Not, And, Or } type;
+        std::vector<int> children;
+        //! The tag a Tag node names
+        QString tag;
+        //! The interned ID of the tag, once some row has had it. Interned IDs never change, so once found, it's kept.
+        mutable std::optional<quint32> tagId;
+    };
+    std::vector<Node> nodes;
+    int root = -1;
+
+    //! Get the interned ID of a Tag node's tag, or nothing if no row has had the tag yet, and so no row has it now
+    std::optional<quint32> resolveTag(const Node& node) const;
+
+    bool matches(int node, const QList<quint32>& tags) const;
+    RoaringBitmap evaluate(int node, const std::function<const RoaringBitmap*(quint32)>& tagRows,
+                           const RoaringBitmap& allRows) const;
+
+    friend class TagExpressionParser;
+};
+
+/*!
+ * \brief An inverted index of a table's rows by tag
+ *
+ * Each row is given a small, stable slot number, reused after the row is removed, and each tag maps to the set of
+ * slots of the rows having it. Rows are updated in the index one at a time as they change, so the index never needs
+ * rebuilding; queries combine the sets of the tags they name.
+ */
+template<typename Id>
+class TagIndex {
+    QHash<Id, quint32> slots;
+    std::vector<Id> slotIds;
+    // The tags of the row in each slot, to know which sets to take a row out of when its tags change
+    std::vector<QList<quint32>> slotTags;
+    std::vector<quint32> freeSlots;
+    RoaringBitmap liveSlots;
+    QHash<quint32, RoaringBitmap> tagSlots;
+
+    void removeFromTag(quint32 tag, quint32 slot) {
+        auto itr = tagSlots.find(tag);
+        if (itr == tagSlots.end())
+            return;
+        itr->remove(slot);
+        if (itr->isEmpty())
+            tagSlots.erase(itr);
+    }
+
+    RoaringBitmap evaluate(const TagExpression& expression) const {
+        return expression.evaluate([this](quint32 tag) -> const RoaringBitmap* {
+            auto itr = tagSlots.constFind(tag);
+            return itr == tagSlots.constEnd()? nullptr : &*itr;
+        }, liveSlots);
+    }
+
+public:
+    //! Add a row to the index, or update its tags if it is already there
+    void setRow(const Id& id, const InternedStringList& tags) {
+        quint32 slot;
+        auto itr = slots.constFind(id);
+        if (itr == slots.constEnd()) {
+            if (freeSlots.empty()) {
+                slot = quint32(slotIds.size());
+                slotIds.push_back(id);
+                slotTags.emplace_back();
+            } else {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+                slotIds[slot] = id;
+            }
+            slots.insert(id, slot);
+            liveSlots.add(slot);
+        } else {
+            slot = *itr;
+        }
+
+        auto& current = slotTags[slot];
+        const auto& next = tags.idList();
+        if (current == next)
+            return;
+        for (auto tag : current)
+            if (!next.contains(tag))
+                removeFromTag(tag, slot);
+        for (auto tag : next)
+            if (!current.contains(tag))
+                tagSlots[tag].add(slot);
+        current = next;
+    }
+    void removeRow(const Id& id) {
+        auto itr = slots.find(id);
+        if (itr == slots.end())
+            return;
+        auto slot = *itr;
+        slots.erase(itr);
+        for (auto tag : slotTags[slot])
+            removeFromTag(tag, slot);
+        slotTags[slot].clear();
+        liveSlots.remove(slot);
+        freeSlots.push_back(slot);
+    }
+    void clear() {
+        slots.clear();
+        slotIds.clear();
+        slotTags.clear();
+        freeSlots.clear();
+        liveSlots.clear();
+        tagSlots.clear();
+    }
+
+    //! The IDs of the rows whose tags match an expression, sorted
+    QList<Id> find(const TagExpression& expression) const {
+        auto rows = evaluate(expression);
+        QList<Id> result;
+        result.reserve(rows.count());
+        rows.forEach([this, &result](quint32 slot) { result.append(slotIds[slot]); });
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+    //! The number of rows whose tags match an expression
+    quint64 count(const TagExpression& expression) const { return evaluate(expression).count(); }
+
+    qint64 approximateBytes() const {
+        qint64 total = sizeof(*this) + liveSlots.approximateBytes()
+                + slots.capacity() * qint64(sizeof(Id) + sizeof(quint32) + sizeof(void*))
+                + qint64(slotIds.capacity()) * (sizeof(Id) + sizeof(QList<quint32>))
+                + qint64(freeSlots.capacity()) * sizeof(quint32);
+        for (const auto& tags : slotTags)
+            total += tags.capacity() * qint64(sizeof(quint32));
+        for (const auto& rows : tagSlots)
+            total += sizeof(quint32) + rows.approximateBytes();
+        return total;
+    }
+};
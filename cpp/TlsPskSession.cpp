@@ -1,11 +1,129 @@
 #include "TlsPskSession.hpp"
 
+#include <QDateTime>
+#include <QHash>
+#include <QSslConfiguration>
+#include <QtEndian>
 #include <QUrl>
 #include <QDebug>
 
+namespace {
+// Size of the length prefix on each frame in LengthPrefixed framing
+constexpr qsizetype FRAME_HEADER_SIZE = sizeof(quint32);
+// Pending writes beyond this are flushed immediately rather than waiting for the event loop
+constexpr qsizetype WRITE_COALESCE_LIMIT = 64 * 1024;
+
+struct CachedTicket {
+    QByteArray ticket;
+    QDateTime expires;
+};
+// TLS session tickets from earlier connections, keyed by host and key pair
+QHash<QString, CachedTicket> sessionTickets;
+// Shared secrets already derived for each key pair, keyed by host key and our key
+QHash<QString, QByteArray> sharedSecrets;
+
+QString keyPairId(const QString& hostKey, const QString& myKey) {
+    return hostKey + QLatin1Char('/') + myKey;
+}
+}
+
 void TlsPskSession::dataReceived() {
-    if (socketPtr->canReadLine())
-        emit lineReady();
+    if (framingMode == Lines) {
+        if (socketPtr->canReadLine())
+            emit lineReady();
+        return;
+    }
+
+    auto framesBefore = frames.size();
+    splitFrames(socketPtr->readAll());
+    if (frames.size() > framesBefore)
+        emit frameReady();
+}
+
+void TlsPskSession::splitFrames(const QByteArray& chunk) {
+    auto checkLength = [this](quint32 length) {
+        if (length <= MAX_FRAME_SIZE)
+            return true;
+        qWarning() << "TlsPskSession: Received frame of" << length << "bytes exceeds limit; closing connection";
+        partialFrame.clear();
+        socketPtr->abort();
+        return false;
+    };
+
+    qsizetype position = 0;
+    if (!partialFrame.isEmpty()) {
+        // Finish the frame begun in an earlier read. It spans two buffers, so it must be copied into one.
+        if (partialFrame.size() < FRAME_HEADER_SIZE) {
+            auto take = std::min(FRAME_HEADER_SIZE - partialFrame.size(), chunk.size());
+            partialFrame.append(chunk.constData(), take);
+            position = take;
+            if (partialFrame.size() < FRAME_HEADER_SIZE)
+                return;
+        }
+        auto length = qFromBigEndian<quint32>(partialFrame.constData());
+        if (!checkLength(length))
+            return;
+        auto take = std::min(FRAME_HEADER_SIZE + qsizetype(length) - partialFrame.size(), chunk.size() - position);
+        partialFrame.append(chunk.constData() + position, take);
+        position += take;
+        if (partialFrame.size() < FRAME_HEADER_SIZE + qsizetype(length))
+            return;
+        frames.enqueue(TlsFrame(std::exchange(partialFrame, {}), FRAME_HEADER_SIZE, length));
+    }
+
+    // Frames wholly within this read are views of it, not copies
+    while (chunk.size() - position >= FRAME_HEADER_SIZE) {
+        auto length = qFromBigEndian<quint32>(chunk.constData() + position);
+        if (!checkLength(length))
+            return;
+        if (chunk.size() - position - FRAME_HEADER_SIZE < qsizetype(length))
+            break;
+        frames.enqueue(TlsFrame(chunk, position + FRAME_HEADER_SIZE, length));
+        position += FRAME_HEADER_SIZE + length;
+    }
+    if (position < chunk.size()) {
+        partialFrame = chunk.sliced(position);
+        // Reserve room for the rest of the frame up front, so finishing it doesn't reallocate repeatedly
+        if (partialFrame.size() >= FRAME_HEADER_SIZE)
+            partialFrame.reserve(FRAME_HEADER_SIZE + qFromBigEndian<quint32>(partialFrame.constData()));
+    }
+}
+
+void TlsPskSession::queueWrite(QByteArrayView data) {
+    pendingWrites.append(data);
+    if (pendingWrites.size() >= WRITE_COALESCE_LIMIT) {
+        flushWrites();
+    } else if (!flushQueued) {
+        flushQueued = true;
+        QMetaObject::invokeMethod(this, &TlsPskSession::flushWrites, Qt::QueuedConnection);
+    }
+    updateCongestion();
+}
+
+void TlsPskSession::flushWrites() {
+    flushQueued = false;
+    if (pendingWrites.isEmpty())
+        return;
+    if (socketPtr->write(pendingWrites) != pendingWrites.size())
+        qWarning() << "TlsPskSession: Failed to write to socket:" << socketPtr->errorString();
+    pendingWrites.clear();
+    updateCongestion();
+}
+
+void TlsPskSession::updateCongestion() {
+    auto buffered = pendingWrites.size() + socketPtr->bytesToWrite() + socketPtr->encryptedBytesToWrite();
+    bool congested = congestedFlag? buffered > LOW_WATER_BYTES : buffered > HIGH_WATER_BYTES;
+    if (congested == congestedFlag)
+        return;
+    congestedFlag = congested;
+    emit congestedChanged(congested);
+}
+
+void TlsPskSession::resetBuffers() {
+    frames.clear();
+    partialFrame.clear();
+    pendingWrites.clear();
+    updateCongestion();
 }
 
 void TlsPskSession::socketStateDidChange(QAbstractSocket::SocketState newState) {
@@ -19,12 +137,28 @@ TlsPskSession::TlsPskSession(QObject *parent)
       socketPtr(new QSslSocket(this)) {
     connect(socketPtr, &QSslSocket::readyRead, this, &TlsPskSession::dataReceived);
     connect(socketPtr, &QSslSocket::stateChanged, this, &TlsPskSession::socketStateDidChange);
-    connect(socketPtr, &QSslSocket::errorOccurred, this, [](QAbstractSocket::SocketError e) { qDebug() << e; });
+    connect(socketPtr, &QSslSocket::bytesWritten, this, &TlsPskSession::updateCongestion);
+    connect(socketPtr, &QSslSocket::encryptedBytesWritten, this, &TlsPskSession::updateCongestion);
+    connect(socketPtr, &QSslSocket::errorOccurred, this, [this](QAbstractSocket::SocketError e) {
+        qDebug() << e;
+        // If the failure was resuming a cached session, make the next attempt a full handshake
+        if (!sessionKey.isEmpty() && !socketPtr->isEncrypted())
+            sessionTickets.remove(sessionKey);
+    });
     connect(socketPtr, &QSslSocket::sslErrors, this, [](QList<QSslError> errors) { qDebug() << errors; });
     connect(socketPtr, &QSslSocket::encrypted, this, [this] {
         qDebug() << "Handshake completed";
         emit handshakeCompleted();
     });
+    connect(socketPtr, &QSslSocket::newSessionTicketReceived, this, [this] {
+        auto configuration = socketPtr->sslConfiguration();
+        auto ticket = configuration.sessionTicket();
+        if (sessionKey.isEmpty() || ticket.isEmpty())
+            return;
+        auto lifetime = configuration.sessionTicketLifeTimeHint();
+        auto expires = QDateTime::currentDateTimeUtc().addSecs(lifetime > 0? lifetime : 60 * 60);
+        sessionTickets.insert(sessionKey, {ticket, expires});
+    });
 }
 
 void TlsPskSession::connectToServer(QString host, QString hostKey, QString myKey) {
@@ -39,7 +173,27 @@ void TlsPskSession::connectToServer(QString host, QString hostKey, QString myKey
 
     QUrl url = QUrl::fromUserInput(host);
     qInfo() << "Connecting to host" << url.host() << ":" << url.port() << "[" << hostKey << "] with my key " << myKey;
+    resetBuffers();
     socketPtr->setPeerVerifyMode(QSslSocket::VerifyNone);
+
+    // Offer the ticket from the last session with this host and key pair, if it hasn't expired, to resume that
+    // session instead of doing a full handshake
+    sessionKey = url.host() + QLatin1Char(':') + QString::number(url.port()) + QLatin1Char('/') +
+                 keyPairId(hostKey, myKey);
+    auto configuration = socketPtr->sslConfiguration();
+    configuration.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    configuration.setSessionTicket({});
+    auto cached = sessionTickets.find(sessionKey);
+    if (cached != sessionTickets.end()) {
+        if (cached->expires > QDateTime::currentDateTimeUtc()) {
+            qDebug() << "Offering cached TLS session ticket";
+            configuration.setSessionTicket(cached->ticket);
+        } else {
+            sessionTickets.erase(cached);
+        }
+    }
+    socketPtr->setSslConfiguration(configuration);
+
     socketPtr->connectToHostEncrypted(url.host(), url.port());
     QObject::disconnect(authConnection);
     authConnection = connect(socketPtr, &QSslSocket::preSharedKeyAuthenticationRequired, this,
@@ -48,15 +202,25 @@ void TlsPskSession::connectToServer(QString host, QString hostKey, QString myKey
                                  if (hostKey == "hint")
                                      hostKey = QString::fromUtf8(authenticator->identityHint());
 
+                                 // Deriving the secret is expensive, so reuse it for later connections
+                                 auto& secret = sharedSecrets[keyPairId(hostKey, myKey)];
+                                 if (secret.isEmpty())
+                                     secret = keyManager()->getSharedSecret(hostKey, myKey);
                                  authenticator->setIdentity(myKey.toUtf8());
-                                 authenticator->setPreSharedKey(keyManager()->getSharedSecret(hostKey, myKey));
+                                 authenticator->setPreSharedKey(secret);
     });
 }
 
 void TlsPskSession::closeConnection() {
+    flushWrites();
     socketPtr->close();
 }
 
+void TlsPskSession::clearSessionCache() {
+    sessionTickets.clear();
+    sharedSecrets.clear();
+}
+
 KeyManager* TlsPskSession::keyManager() const {
     return keyManagerPtr;
 }
@@ -65,14 +229,50 @@ void TlsPskSession::setKeyManager(KeyManager* newKeyManager) {
     if (keyManagerPtr == newKeyManager)
         return;
     keyManagerPtr = newKeyManager;
+    // Secrets were derived by the old KeyManager's keys, which the new one may not hold
+    sharedSecrets.clear();
     emit keyManagerChanged();
 }
 
+void TlsPskSession::setFraming(Framing framing) {
+    if (framingMode == framing)
+        return;
+    framingMode = framing;
+    frames.clear();
+    partialFrame.clear();
+    emit framingChanged();
+}
+
 void TlsPskSession::sendMessage(QString message) {
-    socketPtr->write(message.toUtf8());
+    if (framingMode == LengthPrefixed)
+        sendFrame(message.toUtf8());
+    else
+        queueWrite(message.toUtf8());
+}
+
+bool TlsPskSession::sendFrame(QByteArray frame) {
+    if (framingMode != LengthPrefixed) {
+        qWarning() << "TlsPskSession: Cannot send frame: session is not using LengthPrefixed framing";
+        return false;
+    }
+    if (quint64(frame.size()) > MAX_FRAME_SIZE) {
+        qWarning() << "TlsPskSession: Cannot send frame of" << frame.size() << "bytes: exceeds limit";
+        return false;
+    }
+
+    char header[FRAME_HEADER_SIZE];
+    qToBigEndian<quint32>(frame.size(), header);
+    pendingWrites.reserve(pendingWrites.size() + FRAME_HEADER_SIZE + frame.size());
+    pendingWrites.append(header, FRAME_HEADER_SIZE);
+    queueWrite(frame);
+    return !congestedFlag;
 }
 
 QString TlsPskSession::readLine() {
+    if (framingMode != Lines) {
+        qWarning() << "Unable to read line from TLS socket: session is using LengthPrefixed framing";
+        return {};
+    }
     if (!socketPtr->canReadLine()) {
         qWarning() << "Unable to read line from TLS socket: a line is not yet available";
         return {};
@@ -80,3 +280,14 @@ QString TlsPskSession::readLine() {
 
     return QString::fromUtf8(socketPtr->readLine());
 }
+
+QByteArray TlsPskSession::readFrame() {
+    auto frame = takeFrame();
+    return frame? frame->toByteArray() : QByteArray();
+}
+
+std::optional<TlsFrame> TlsPskSession::takeFrame() {
+    if (frames.isEmpty())
+        return {};
+    return frames.dequeue();
+}
@@ -3,22 +3,92 @@
 #include "KeyManager.hpp"
 
 #include <QObject>
+#include <QQueue>
 #include <QSslSocket>
 #include <QQmlEngine>
 
+#include <optional>
+
+/**
+ * @brief A frame received by a TlsPskSession in LengthPrefixed framing
+ *
+ * Frames which arrive whole in one read from the socket share that read's buffer rather than each being copied out of
+ * it, so holding any frame keeps the whole buffer alive. Use toByteArray() to keep a frame independently.
+ */
+class TlsFrame {
+    QByteArray buffer;
+    qsizetype offset = 0;
+    qsizetype length = 0;
+
+public:
+    TlsFrame() = default;
+    TlsFrame(QByteArray buffer, qsizetype offset, qsizetype length)
+        : buffer(std::move(buffer)), offset(offset), length(length) {}
+
+    QByteArrayView view() const { return QByteArrayView(buffer.constData() + offset, length); }
+    const char* data() const { return buffer.constData() + offset; }
+    qsizetype size() const { return length; }
+    bool isEmpty() const { return length == 0; }
+    /// @brief Get the frame as a QByteArray; this copies it unless it spans the whole buffer
+    QByteArray toByteArray() const {
+        return offset == 0 && length == buffer.size()? buffer : QByteArray(data(), length);
+    }
+};
+
 class TlsPskSession : public QObject {
     Q_OBJECT
     QML_ELEMENT
 
+public:
+    /// @brief How messages are delimited on the connection
+    enum Framing {
+        /// Newline-delimited text, read with readLine()
+        Lines,
+        /// Binary frames, each preceded by its length as a 32-bit big-endian integer, read with readFrame()
+        LengthPrefixed
+    };
+    Q_ENUM(Framing)
+
+    /// Frames longer than this are taken to be a protocol error, and end the session
+    static constexpr quint32 MAX_FRAME_SIZE = 16 * 1024 * 1024;
+    /// Buffered outgoing bytes above which the session reports itself congested
+    static constexpr qint64 HIGH_WATER_BYTES = 1024 * 1024;
+    /// Buffered outgoing bytes below which a congested session reports itself clear again
+    static constexpr qint64 LOW_WATER_BYTES = 256 * 1024;
+
+private:
     QSslSocket* socketPtr;
     Q_PROPERTY(QSslSocket* socket READ socket CONSTANT)
-    KeyManager* keyManagerPtr;
+    KeyManager* keyManagerPtr = nullptr;
     Q_PROPERTY(KeyManager* keyManager READ keyManager WRITE setKeyManager NOTIFY keyManagerChanged)
+    Q_PROPERTY(Framing framing READ framing WRITE setFraming NOTIFY framingChanged)
+    /// True while more than HIGH_WATER_BYTES are waiting to be sent, until they drain below LOW_WATER_BYTES
+    Q_PROPERTY(bool congested READ congested NOTIFY congestedChanged)
 
     QMetaObject::Connection authConnection;
 
+    Framing framingMode = Lines;
+    // Frames received and not yet read
+    QQueue<TlsFrame> frames;
+    // The start of a frame whose end hasn't arrived yet
+    QByteArray partialFrame;
+
+    // Outgoing data written during this pass of the event loop, sent together when control returns to it
+    QByteArray pendingWrites;
+    bool flushQueued = false;
+    bool congestedFlag = false;
+
+    // Identifies the session cached for the current connection's host and key pair
+    QString sessionKey;
+
+    void splitFrames(const QByteArray& chunk);
+    void queueWrite(QByteArrayView data);
+    void flushWrites();
+    void updateCongestion();
+    void resetBuffers();
+
 private slots:
-    /// @brief Process data received on the socket, and perhaps emit lineReady()
+    /// @brief Process data received on the socket, and perhaps emit lineReady() or frameReady()
     void dataReceived();
     /// @brief Process a change in the socket's state
     void socketStateDidChange(QSslSocket::SocketState newState);
@@ -31,13 +101,35 @@ public:
     KeyManager* keyManager() const;
     void setKeyManager(KeyManager* newKeyManager);
 
+    Framing framing() const { return framingMode; }
+    void setFraming(Framing framing);
+    bool congested() const { return congestedFlag; }
+
     /**
      * @brief Send a message to the server
-     * @param message The message to send
+     * @param message The message to send. In LengthPrefixed framing, it is sent as a frame of UTF-8 text.
      */
     Q_INVOKABLE void sendMessage(QString message);
+    /**
+     * @brief Send a frame to the server, in LengthPrefixed framing
+     * @param frame The contents of the frame
+     * @return False if the frame was not sent, or if the session is now congested and the caller should wait for
+     * congestedChanged() before sending more
+     *
+     * Frames sent in one pass of the event loop are written to the socket together, so they share TLS records.
+     */
+    Q_INVOKABLE bool sendFrame(QByteArray frame);
 
     Q_INVOKABLE QString readLine();
+    /// @brief Check whether a frame is available to read, in LengthPrefixed framing
+    Q_INVOKABLE bool hasFrame() const { return !frames.isEmpty(); }
+    /// @brief Read the next frame, in LengthPrefixed framing; returns an empty array if none is available
+    Q_INVOKABLE QByteArray readFrame();
+    /// @brief Take the next frame without copying it, in LengthPrefixed framing
+    std::optional<TlsFrame> takeFrame();
+
+    /// @brief Forget all cached TLS sessions and pre-shared keys, so the next connections do full handshakes
+    static void clearSessionCache();
 
 public slots:
     /**
@@ -46,6 +138,9 @@ public slots:
      * @param hostKey The host's public key, base58 encoded, or "hint" to expect the host's key in the identity hint
      * @param myKey Our public key, base58 encoded. KeyManager must have corresponding private key.
      * @pre KeyManager must be set
+     *
+     * The shared secret and the TLS session are cached for the host and key pair, so reconnecting resumes the session
+     * where the server allows it, skipping both the key derivation and the full handshake.
      */
     void connectToServer(QString host, QString hostKey, QString myKey);
 
@@ -56,11 +151,15 @@ public slots:
 
 signals:
     void keyManagerChanged();
+    void framingChanged();
+    /// @brief Emitted when the session becomes congested, and again when it drains
+    void congestedChanged(bool congested);
     /// @brief Emitted when an ASCII line is available to read
     void lineReady();
+    /// @brief Emitted when one or more frames are available to read
+    void frameReady();
     /// @brief Emitted when the TLS handshake completes
     void handshakeCompleted();
     /// @brief Emitted when the session ends, either normally or due to error
     void sessionEnded();
 };
-
@@ -0,0 +1,147 @@
+#include <TrafficLog.hpp>
+#include <CannedReply.hpp>
+
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+QDataStream& operator<<(QDataStream& stream, const TrafficRecord& record) {
+    return stream << record.sentMsecs << record.durationMsecs << record.httpStatus << record.apiPath
+                  << record.node.toString() << qCompress(record.request) << qCompress(record.response);
+}
+QDataStream& operator>>(QDataStream& stream, TrafficRecord& record) {
+    QString node;
+    QByteArray request, response;
+    stream >> record.sentMsecs >> record.durationMsecs >> record.httpStatus >> record.apiPath >> node >> request
+           >> response;
+    record.node = QUrl(node);
+    record.request = qUncompress(request);
+    record.response = qUncompress(response);
+    return stream;
+}
+}
+
+TrafficRecorder::TrafficRecorder(QString path, QObject* parent) : QObject(parent), file(path) {}
+
+TrafficRecorder::~TrafficRecorder() {
+    if (file.isOpen())
+        qInfo() << "TrafficRecorder: Recorded" << records << "requests to" << file.fileName();
+}
+
+bool TrafficRecorder::open() {
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "TrafficRecorder: Unable to open" << file.fileName() << "for writing:" << file.errorString();
+        return false;
+    }
+    stream.setDevice(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << MAGIC << VERSION << QDateTime::currentMSecsSinceEpoch();
+    file.flush();
+    clock.start();
+    return true;
+}
+
+void TrafficRecorder::record(const QString& apiPath, const QUrl& node, const QByteArray& request,
+                             QNetworkReply* reply, qint64 sentMsecs) {
+    if (!file.isOpen())
+        return;
+
+    TrafficRecord record;
+    record.sentMsecs = sentMsecs;
+    record.durationMsecs = qint32(clock.elapsed() - sentMsecs);
+    auto httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    record.httpStatus = httpStatus.isValid()? httpStatus.toInt() : 0;
+    record.apiPath = apiPath;
+    record.node = node;
+    record.request = request;
+    record.response = reply->peek(reply->bytesAvailable());
+
+    stream << record;
+    file.flush();
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "TrafficRecorder: Unable to write to" << file.fileName() << ":" << file.errorString()
+                   << "-- recording stopped";
+        file.close();
+        return;
+    }
+    ++records;
+}
+
+TrafficReplayer::TrafficReplayer(QObject* parent) : QObject(parent) {}
+
+TrafficReplayer::~TrafficReplayer() {}
+
+bool TrafficReplayer::load(QString path, QString* error) {
+    auto fail = [error](QString message) {
+        qWarning() << "TrafficReplayer:" << message;
+        if (error != nullptr)
+            *error = message;
+        return false;
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(QStringLiteral("Unable to open %1: %2").arg(path, file.errorString()));
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0, version = 0;
+    qint64 startedAt = 0;
+    stream >> magic >> version >> startedAt;
+    if (magic != TrafficRecorder::MAGIC || version != TrafficRecorder::VERSION)
+        return fail(QStringLiteral("%1 is not a traffic log this version can read").arg(path));
+
+    records.clear();
+    recordsByRequest.clear();
+    while (!stream.atEnd()) {
+        TrafficRecord record;
+        stream >> record;
+        if (stream.status() != QDataStream::Ok) {
+            // The recording was cut short; keep what was written whole
+            qWarning() << "TrafficReplayer: Log" << path << "is truncated after" << records.size() << "records";
+            break;
+        }
+        recordsByRequest[qMakePair(record.apiPath, record.request)].append(records.size());
+        records.append(std::move(record));
+    }
+    qInfo() << "TrafficReplayer: Loaded" << records.size() << "records from" << path << "recorded at"
+            << QDateTime::fromMSecsSinceEpoch(startedAt);
+    restart();
+    return true;
+}
+
+QStringList TrafficReplayer::nodes() const {
+    QStringList result;
+    for (const auto& record : records)
+        if (!record.node.isEmpty() && !result.contains(record.node.toString()))
+            result.append(record.node.toString());
+    return result;
+}
+
+void TrafficReplayer::restart() {
+    nextRecord.clear();
+    servedCount = missCount = 0;
+    clock.start();
+}
+
+ApiCallback TrafficReplayer::caller() {
+    return [this](QString apiPath, QByteArray json) -> QNetworkReply* {
+        auto key = qMakePair(apiPath, json);
+        auto itr = recordsByRequest.constFind(key);
+        if (itr == recordsByRequest.constEnd()) {
+            ++missCount;
+            qWarning() << "TrafficReplayer: No recorded response to" << apiPath << json;
+            return new CannedReply({}, 0, this);
+        }
+
+        // Serve the records for this request in turn, repeating the last once they run out
+        auto& next = nextRecord[key];
+        const auto& record = records[itr->at(std::min(next, int(itr->size()) - 1))];
+        ++next;
+        ++servedCount;
+
+        // Wait out the response's duration, and beyond that, until the response arrived in the recording
+        auto delay = std::max(record.durationMsecs * scale,
+                              (record.sentMsecs + record.durationMsecs) * scale - clock.elapsed());
+        return new CannedReply(record.response, record.httpStatus, this, int(delay));
+    };
+}
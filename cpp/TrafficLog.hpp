@@ -0,0 +1,120 @@
+#pragma once
+
+#include <AbstractTableInterface.hpp>
+
+#include <QObject>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QUrl>
+
+/*!
+ * \brief One request to the node API and its response, as recorded by \ref TrafficRecorder
+ */
+struct TrafficRecord {
+    //! Time the request was sent, in milliseconds since the recording started
+    qint64 sentMsecs = 0;
+    //! Time the response took, in milliseconds
+    qint32 durationMsecs = 0;
+    //! HTTP status of the response, or 0 if the node never responded
+    qint32 httpStatus = 0;
+    QString apiPath;
+    QUrl node;
+    QByteArray request;
+    QByteArray response;
+};
+
+/*!
+ * \brief Records the requests made to the node API and their responses, with their timing, to a file
+ *
+ * The log starts with a header of the magic number "PLRT", the format version, and the time the recording started in
+ * milliseconds since the epoch, followed by the records in the order the responses arrived. Each record holds the
+ * fields of \ref TrafficRecord, with the request and response compressed, written with QDataStream. Records are
+ * flushed as they are written, so a log cut short by a crash is still readable up to its last record.
+ *
+ * Set \ref BlockchainInterface::trafficLogPath to record a session; replay it with \ref TrafficReplayer.
+ */
+class TrafficRecorder : public QObject {
+    Q_OBJECT
+
+    QFile file;
+    QDataStream stream;
+    QElapsedTimer clock;
+    quint64 records = 0;
+
+public:
+    constexpr static quint32 MAGIC = 0x504c5254; // "PLRT"
+    constexpr static quint32 VERSION = 1;
+
+    explicit TrafficRecorder(QString path, QObject* parent = nullptr);
+    virtual ~TrafficRecorder();
+
+    //! \brief Create the log file, replacing any file already there; returns false if it can't be written
+    bool open();
+    QString path() const { return file.fileName(); }
+    QString errorString() const { return file.errorString(); }
+    quint64 recordCount() const { return records; }
+
+    //! \brief Milliseconds since the recording started, for timing requests against
+    qint64 elapsed() const { return clock.elapsed(); }
+    /*!
+     * \brief Record a finished request
+     * \param sentMsecs The time the request was sent, from \ref elapsed
+     *
+     * The response is peeked rather than read, so the reply's other readers still find all of it. Call this from the
+     * first slot connected to the reply's finished signal.
+     */
+    void record(const QString& apiPath, const QUrl& node, const QByteArray& request, QNetworkReply* reply,
+                qint64 sentMsecs);
+};
+
+/*!
+ * \brief Serves the node API from a log written by \ref TrafficRecorder, to replay a recorded session
+ *
+ * Requests are matched to records by API path and request body. Requests with the same path and body get the records
+ * for them in the order they were recorded, so repeated polls, such as for chain info and the journal, see the chain
+ * progress as it did in the recording; once those records run out, the last of them is served again. Requests which
+ * were never recorded fail as though the node refused the connection.
+ *
+ * Each response is held back until both its recorded duration has passed since the request, and the time it arrived
+ * in the recording has passed since the replay started, each multiplied by the time scale. A time scale of 1 replays
+ * the session at its original pace, and 0 serves every response as soon as it is asked for.
+ */
+class TrafficReplayer : public QObject {
+    Q_OBJECT
+
+    QList<TrafficRecord> records;
+    // Indexes into records of the records for each path and request, in order, and the next to serve
+    QHash<QPair<QString, QByteArray>, QList<int>> recordsByRequest;
+    QHash<QPair<QString, QByteArray>, int> nextRecord;
+    QElapsedTimer clock;
+    double scale = 1;
+    quint64 servedCount = 0;
+    quint64 missCount = 0;
+
+public:
+    explicit TrafficReplayer(QObject* parent = nullptr);
+    virtual ~TrafficReplayer();
+
+    /*!
+     * \brief Load a log, replacing any loaded before
+     * \param error Set to a description of the problem if the log can't be read
+     * \return False if the log can't be read; records read before a truncated end are kept
+     */
+    bool load(QString path, QString* error = nullptr);
+    int recordCount() const { return records.size(); }
+    //! \brief The nodes the recorded requests were sent to, in the order they were first used
+    QStringList nodes() const;
+
+    double timeScale() const { return scale; }
+    void setTimeScale(double timeScale) { scale = std::max(0., timeScale); }
+
+    //! \brief Start the replay over from the first records, with the replay clock starting now
+    void restart();
+    //! \brief Get a transport serving the recorded responses, for \ref BlockchainInterface::setTransport
+    ApiCallback caller();
+
+    quint64 served() const { return servedCount; }
+    quint64 misses() const { return missCount; }
+};
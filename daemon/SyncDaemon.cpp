@@ -0,0 +1,282 @@
+#include "SyncDaemon.hpp"
+
+#include <BlockchainInterface.hpp>
+#include <KeyManager.hpp>
+#include <SharedTableCache.hpp>
+#include <Strings.hpp>
+#include <TrafficLog.hpp>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QMetaEnum>
+#include <QSaveFile>
+#include <QSettings>
+#include <QTimer>
+#include <QDebug>
+
+#include <cstdio>
+
+Q_LOGGING_CATEGORY(syncd, "pollaris.syncd")
+
+namespace {
+// Interval at which to check whether the initial sync has completed
+constexpr int SYNC_WATCH_INTERVAL_MS = 100;
+// Number of consecutive checks with no requests in flight before the initial sync is considered complete
+constexpr uint32_t SYNC_QUIET_TICKS = 3;
+// Time after which a benchmark gives up waiting for the initial sync
+constexpr qint64 INITIAL_SYNC_TIMEOUT_MS = 10 * 60 * 1000;
+}
+
+std::optional<SyncDaemon::Config> SyncDaemon::Config::load(QString path) {
+    if (!QFileInfo(path).isReadable()) {
+        qCritical() << "SyncDaemon: Cannot read configuration file" << path;
+        return {};
+    }
+
+    QSettings settings(path, QSettings::IniFormat);
+    Config config;
+    config.nodeUrls = settings.value(QStringLiteral("node/urls")).toStringList();
+    config.syncInterval = settings.value(QStringLiteral("node/syncInterval"), config.syncInterval).toUInt();
+    config.syncStaleSeconds = settings.value(QStringLiteral("node/syncStaleSeconds"),
+                                             config.syncStaleSeconds).toUInt();
+    for (const auto& group : settings.value(QStringLiteral("tables/groups")).toStringList()) {
+        bool ok = false;
+        auto id = group.trimmed().toULongLong(&ok);
+        if (ok)
+            config.groups.append(id);
+        else if (group.trimmed() != QStringLiteral("all"))
+            qWarning() << "SyncDaemon: Ignoring invalid group ID in configuration:" << group;
+    }
+    config.sharedCache = settings.value(QStringLiteral("tables/sharedCache")).toString();
+    config.recordTraffic = settings.value(QStringLiteral("node/recordTraffic")).toString();
+    config.replayTraffic = settings.value(QStringLiteral("replay/file")).toString();
+    config.replayTimeScale = settings.value(QStringLiteral("replay/timeScale"), config.replayTimeScale).toDouble();
+    config.exportDirectory = settings.value(QStringLiteral("export/directory")).toString();
+    config.exportInterval = settings.value(QStringLiteral("export/interval"), config.exportInterval).toUInt();
+    config.metricsFile = settings.value(QStringLiteral("export/metricsFile")).toString();
+    config.metricsPort = settings.value(QStringLiteral("export/metricsPort"), 0).toUInt();
+    config.benchmarkSeconds = settings.value(QStringLiteral("benchmark/seconds"), 0).toUInt();
+    config.reportFile = settings.value(QStringLiteral("benchmark/reportFile")).toString();
+    return config;
+}
+
+SyncDaemon::SyncDaemon(Config config, QObject* parent)
+    : QObject(parent), config(std::move(config)), blockchain(new BlockchainInterface(this)),
+      keyManager(new KeyManager(this)), exportTimer(new QTimer(this)), syncWatchTimer(new QTimer(this)) {
+    keyManager->setBlockchain(blockchain);
+    blockchain->setSyncInterval(this->config.syncInterval);
+    blockchain->setSyncStaleSeconds(this->config.syncStaleSeconds);
+
+    connect(blockchain, &BlockchainInterface::newJournalEntries, this,
+            [this](QList<JournalEntry> entries) { journalEntries += entries.size(); });
+
+    exportTimer->setInterval(std::max(1u, this->config.exportInterval) * 1000);
+    exportTimer->callOnTimeout(this, &SyncDaemon::exportSnapshots);
+    syncWatchTimer->setInterval(SYNC_WATCH_INTERVAL_MS);
+    syncWatchTimer->callOnTimeout(this, &SyncDaemon::checkInitialSync);
+}
+
+SyncDaemon::~SyncDaemon() {}
+
+void SyncDaemon::start() {
+    if (config.metricsPort != 0)
+        blockchain->metrics()->serveHttp(config.metricsPort);
+
+    auto nodeUrls = config.nodeUrls;
+    if (!config.replayTraffic.isEmpty()) {
+        replayer = new TrafficReplayer(this);
+        if (!replayer->load(config.replayTraffic)) {
+            // The application isn't running its event loop yet, so it can't exit until it is
+            QMetaObject::invokeMethod(this, [this] { emit finished(1); }, Qt::QueuedConnection);
+            return;
+        }
+        replayer->setTimeScale(config.replayTimeScale);
+        blockchain->setTransport(replayer->caller());
+        // Requests are served from the log whatever node they're for, but name the recorded nodes unless told others
+        if (nodeUrls.isEmpty())
+            nodeUrls = replayer->nodes();
+    }
+    if (!config.recordTraffic.isEmpty())
+        blockchain->setTrafficLogPath(config.recordTraffic);
+
+    clock.start();
+    if (replayer != nullptr)
+        replayer->restart();
+    if (!config.sharedCache.isEmpty())
+        blockchain->setSharedCacheName(config.sharedCache);
+    blockchain->setNodeUrls(nodeUrls);
+    mirrorTables();
+    syncWatchTimer->start();
+}
+
+void SyncDaemon::mirrorTables() {
+    // Take a model of each mirrored table, so it loads and follows the journal. With no group filter, the polling
+    // groups model's group size field loads and follows every group's members as groups appear, but holds no models
+    // on them, so the table registry may evict those tables; they are opened again, from their spilled rows, to export.
+    blockchain->getPollingGroupTable()->allRows();
+    for (auto group : config.groups)
+        blockchain->getGroupMembersTable(group)->allRows();
+}
+
+QList<AbstractTableInterface*> SyncDaemon::mirroredTables() {
+    auto groupsTable = blockchain->getPollingGroupTable();
+    QList<AbstractTableInterface*> tables{groupsTable};
+
+    auto groups = config.groups;
+    if (groups.isEmpty()) {
+        for (const auto& row : groupsTable->localRows()) {
+            auto group = row.toMap();
+            auto id = group[Strings::Id].toULongLong();
+            if (group[AbstractTableInterface::LOAD_STATE_ROLE_NAME].value<LoadState>() != LoadState::Loading &&
+                    id < AbstractTableInterface::BASE_DRAFT_ID)
+                groups.append(id);
+        }
+    }
+    for (auto group : groups)
+        tables.append(blockchain->getGroupMembersTable(group));
+    return tables;
+}
+
+bool SyncDaemon::exportSnapshots() {
+    bool success = true;
+
+    if (!config.exportDirectory.isEmpty()) {
+        QDir directory(config.exportDirectory);
+        if (!directory.mkpath(QStringLiteral("."))) {
+            qCritical() << "SyncDaemon: Unable to create export directory" << config.exportDirectory;
+            return false;
+        }
+
+        const auto loadStates = QMetaEnum::fromType<LoadState>();
+        for (auto* table : mirroredTables()) {
+            // A table just opened again after eviction may still be loading; keep its last snapshot until it's done
+            if (table->isLoading() && table->countRows() == 0)
+                continue;
+            QJsonArray rows;
+            for (const auto& row : table->localRows()) {
+                auto fields = row.toMap();
+                auto state = fields.take(AbstractTableInterface::LOAD_STATE_ROLE_NAME).value<LoadState>();
+                if (state == LoadState::Loading)
+                    continue;
+                auto json = QJsonObject::fromVariantMap(fields);
+                json[AbstractTableInterface::LOAD_STATE_ROLE_NAME] = loadStates.valueToKey(int(state));
+                rows.append(json);
+            }
+
+            QJsonObject snapshot{
+                {Strings::Table, table->tableName()},
+                {Strings::Scope, table->tableScope().toString()},
+                {QStringLiteral("headBlockNumber"), qint64(blockchain->headBlockNumber())},
+                {QStringLiteral("exportedAt"), QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs)},
+                {Strings::Rows, rows}
+            };
+
+            QSaveFile file(directory.filePath(table->tableName() + '.' + table->tableScope().toString() + ".json"));
+            if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(snapshot).toJson()) == -1 ||
+                    !file.commit()) {
+                qCritical() << "SyncDaemon: Unable to write snapshot" << file.fileName() << ":" << file.errorString();
+                success = false;
+            }
+        }
+    }
+
+    if (!config.metricsFile.isEmpty())
+        success = blockchain->metrics()->dumpToFile(config.metricsFile) && success;
+    return success;
+}
+
+void SyncDaemon::checkInitialSync() {
+    if (config.benchmarkSeconds > 0 && clock.elapsed() > INITIAL_SYNC_TIMEOUT_MS) {
+        qCritical() << "SyncDaemon: Initial sync did not complete within" << INITIAL_SYNC_TIMEOUT_MS / 1000
+                    << "seconds";
+        syncWatchTimer->stop();
+        emit finished(1);
+        return;
+    }
+
+    // The initial sync is done once the groups table has been requested and no requests remain outstanding. Tables
+    // filled from a shared cache are never requested from the node, though.
+    auto metrics = blockchain->metrics();
+    bool reading = blockchain->sharedCache() != nullptr && blockchain->sharedCache()->isReader();
+    if (blockchain->syncStatus() < BlockchainInterface::SyncStatus::Connected || metrics->inFlight() > 0 ||
+            (!reading &&
+             metrics->getEndpoint(Strings::GetTableRows.section('/', -1) + '/' + Strings::PollGroups) == nullptr)) {
+        quietTicks = 0;
+        return;
+    }
+    if (++quietTicks < SYNC_QUIET_TICKS)
+        return;
+
+    syncWatchTimer->stop();
+    initialSyncMsecs = clock.elapsed();
+    journalEntriesAtSync = journalEntries;
+    qCInfo(syncd) << "SyncDaemon: Initial sync of" << rowCount() << "rows completed in" << initialSyncMsecs << "ms";
+
+    if (config.benchmarkSeconds > 0) {
+        QTimer::singleShot(config.benchmarkSeconds * 1000, this, &SyncDaemon::finishBenchmark);
+    } else {
+        exportSnapshots();
+        exportTimer->start();
+    }
+}
+
+void SyncDaemon::finishBenchmark() {
+    auto metrics = blockchain->metrics();
+    auto followed = journalEntries - journalEntriesAtSync;
+    uint64_t requests = 0, bytesReceived = 0, wireBytesReceived = 0;
+    for (const auto& endpoint : metrics->endpoints()) {
+        requests += endpoint.toMap()[QStringLiteral("requests")].toULongLong();
+        bytesReceived += endpoint.toMap()[QStringLiteral("bytesReceived")].toULongLong();
+        wireBytesReceived += endpoint.toMap()[QStringLiteral("wireBytesReceived")].toULongLong();
+    }
+
+    QJsonObject report{
+        {QStringLiteral("nodeUrls"), QJsonArray::fromStringList(blockchain->nodeUrls())},
+        {QStringLiteral("replayed"), config.replayTraffic},
+        {QStringLiteral("initialSyncMs"), initialSyncMsecs},
+        {QStringLiteral("tables"), mirroredTables().size()},
+        {QStringLiteral("rows"), qint64(rowCount())},
+        {QStringLiteral("followSeconds"), qint64(config.benchmarkSeconds)},
+        {QStringLiteral("journalEntries"), qint64(followed)},
+        {QStringLiteral("journalEntriesPerSecond"), double(followed) / config.benchmarkSeconds},
+        {QStringLiteral("requests"), qint64(requests)},
+        {QStringLiteral("bytesReceived"), qint64(bytesReceived)},
+        {QStringLiteral("wireBytesReceived"), qint64(wireBytesReceived)},
+        {QStringLiteral("endpoints"), QJsonObject::fromVariantMap(metrics->endpoints())},
+        {QStringLiteral("nodeErrors"), QJsonObject::fromVariantMap(metrics->nodeErrors())}
+    };
+    if (replayer != nullptr) {
+        // Requests the log had no response for mean the replay strayed from the recording
+        report[QStringLiteral("replayServed")] = qint64(replayer->served());
+        report[QStringLiteral("replayMisses")] = qint64(replayer->misses());
+    }
+    auto json = QJsonDocument(report).toJson();
+
+    if (config.reportFile.isEmpty()) {
+        std::fwrite(json.constData(), 1, json.size(), stdout);
+        std::fflush(stdout);
+    } else {
+        QSaveFile file(config.reportFile);
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) == -1 || !file.commit()) {
+            qCritical() << "SyncDaemon: Unable to write benchmark report" << config.reportFile << ":"
+                        << file.errorString();
+            emit finished(1);
+            return;
+        }
+    }
+
+    exportSnapshots();
+    emit finished(0);
+}
+
+uint64_t SyncDaemon::rowCount() {
+    uint64_t rows = 0;
+    for (auto* table : mirroredTables())
+        rows += table->localRows().size();
+    return rows;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include <optional>
+
+class AbstractTableInterface;
+class BlockchainInterface;
+class KeyManager;
+class TrafficReplayer;
+class QTimer;
+
+/*!
+ * \brief Runs the blockchain interface and table caches without a GUI, mirroring the contract tables to disk
+ *
+ * The daemon connects to the configured nodes, keeps the poll.groups table and the group.accts tables of the
+ * configured groups (or of all groups) synchronized with the chain, and periodically exports a JSON snapshot of each
+ * table, along with the request metrics in Prometheus format.
+ *
+ * In benchmark mode, the daemon instead measures how long the initial synchronization takes and how quickly the
+ * journal is followed over a fixed period, then writes a JSON report and exits.
+ */
+class SyncDaemon : public QObject {
+    Q_OBJECT
+
+public:
+    struct Config {
+        QStringList nodeUrls;
+        uint32_t syncInterval = 2500;
+        uint32_t syncStaleSeconds = 10;
+        //! IDs of the groups whose members to mirror; if empty, all groups are mirrored
+        QList<quint64> groups;
+        //! Name of a cache to share the tables through with other Pollaris processes; if empty, none is used
+        QString sharedCache;
+        //! File to record the node API traffic to; if empty, none is recorded
+        QString recordTraffic;
+        //! Traffic log to serve the node API from instead of the nodes; if empty, the nodes are used
+        QString replayTraffic;
+        //! Factor to scale the recorded response times by in replay; 0 serves responses immediately
+        double replayTimeScale = 1;
+
+        //! Directory to write table snapshots to; if empty, no snapshots are written
+        QString exportDirectory;
+        //! Seconds between snapshots
+        uint32_t exportInterval = 60;
+        //! File to write metrics to in Prometheus format, at every snapshot
+        QString metricsFile;
+        //! Port on 127.0.0.1 to serve metrics over HTTP at; 0 to disable
+        quint16 metricsPort = 0;
+
+        //! If nonzero, run in benchmark mode, following the journal for this many seconds after the initial sync
+        uint32_t benchmarkSeconds = 0;
+        //! File to write the benchmark report to; if empty, it is written to standard output
+        QString reportFile;
+
+        /*!
+         * \brief Load the configuration from an INI file
+         *
+         * The file has the sections [node] (urls, syncInterval, syncStaleSeconds, recordTraffic), [tables] (groups,
+         * sharedCache), [export] (directory, interval, metricsFile, metricsPort), [benchmark] (seconds, reportFile)
+         * and [replay] (file, timeScale). Returns nothing if the file cannot be read.
+         */
+        static std::optional<Config> load(QString path);
+    };
+
+    explicit SyncDaemon(Config config, QObject* parent = nullptr);
+    virtual ~SyncDaemon();
+
+    //! Connect to the nodes and begin mirroring
+    void start();
+
+    //! Write a snapshot of every mirrored table to the export directory; returns false if any write failed
+    bool exportSnapshots();
+    //! Get the tables currently being mirrored
+    QList<AbstractTableInterface*> mirroredTables();
+
+signals:
+    //! Emitted when the daemon has finished its work and the application should exit with the given code
+    void finished(int exitCode);
+
+private:
+    Config config;
+    BlockchainInterface* blockchain;
+    KeyManager* keyManager;
+    TrafficReplayer* replayer = nullptr;
+    QTimer* exportTimer;
+    QTimer* syncWatchTimer;
+
+    QElapsedTimer clock;
+    qint64 initialSyncMsecs = -1;
+    uint32_t quietTicks = 0;
+    uint64_t journalEntries = 0;
+    uint64_t journalEntriesAtSync = 0;
+
+    void mirrorTables();
+    void checkInitialSync();
+    void finishBenchmark();
+    uint64_t rowCount();
+};
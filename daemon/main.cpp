@@ -0,0 +1,70 @@
+#include "SyncDaemon.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QSettings>
+#include <QSet>
+#include <QSysInfo>
+#include <QDebug>
+
+int main(int argc, char *argv[]) {
+    // Use the same persistence as the GUI, so the daemon shares its wallet
+    if (QSet<QString>{QStringLiteral("winrt"), QStringLiteral("windows")}.contains(QSysInfo::productType()))
+        QSettings::setDefaultFormat(QSettings::IniFormat);
+
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QObject::tr("Pollaris"));
+    app.setApplicationVersion("Alpha");
+    app.setOrganizationName(QObject::tr("Follow My Vote"));
+    app.setOrganizationDomain(QStringLiteral("https://followmyvote.com"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless Pollaris table mirror and sync benchmark");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption configOption({"c", "config"}, "Configuration file (INI format)", "file");
+    QCommandLineOption benchmarkOption("benchmark", "Run in benchmark mode, following the journal for the given "
+                                                    "number of seconds after the initial sync", "seconds");
+    QCommandLineOption reportOption("report", "Write the benchmark report to this file rather than stdout", "file");
+    QCommandLineOption recordOption("record", "Record the node API traffic to this file", "file");
+    QCommandLineOption replayOption("replay", "Serve the node API from this traffic log instead of the nodes", "file");
+    QCommandLineOption timeScaleOption("time-scale", "Scale the replayed response times by this factor; 0 serves "
+                                                     "responses immediately", "factor");
+    QCommandLineOption verboseOption({"v", "verbose"}, "Log informational messages, including every row update");
+    parser.addOptions({configOption, benchmarkOption, reportOption, recordOption, replayOption, timeScaleOption,
+                       verboseOption});
+    parser.process(app);
+
+    if (!parser.isSet(configOption)) {
+        qCritical() << "A configuration file must be specified with --config";
+        return 1;
+    }
+    auto config = SyncDaemon::Config::load(parser.value(configOption));
+    if (!config.has_value())
+        return 1;
+    if (parser.isSet(benchmarkOption))
+        config->benchmarkSeconds = parser.value(benchmarkOption).toUInt();
+    if (parser.isSet(reportOption))
+        config->reportFile = parser.value(reportOption);
+    if (parser.isSet(recordOption))
+        config->recordTraffic = parser.value(recordOption);
+    if (parser.isSet(replayOption))
+        config->replayTraffic = parser.value(replayOption);
+    if (parser.isSet(timeScaleOption))
+        config->replayTimeScale = parser.value(timeScaleOption).toDouble();
+    if (config->nodeUrls.isEmpty() && config->replayTraffic.isEmpty()) {
+        qCritical() << "No nodes to sync from: the configuration sets neither node/urls nor replay/file";
+        return 1;
+    }
+
+    // The tables log every row they touch, which is far too much for a server mirroring large tables
+    if (!parser.isSet(verboseOption))
+        QLoggingCategory::setFilterRules(QStringLiteral("default.info=false"));
+
+    SyncDaemon daemon(config.value());
+    QObject::connect(&daemon, &SyncDaemon::finished, &app, &QCoreApplication::exit);
+    daemon.start();
+
+    return app.exec();
+}
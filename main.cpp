@@ -9,6 +9,7 @@
 #include <BroadcastableTransaction.hpp>
 #include <KeyManager.hpp>
 #include <Action.hpp>
+#include <TableEditController.hpp>
 #include <Enums.hpp>
 #include <TlsPskSession.hpp>
 
@@ -48,6 +49,8 @@ int main(int argc, char *argv[]) {
     qmlRegisterUncreatableType<Task>(POLLARIS_1_0, "Task",
                                      QStringLiteral("Tasks can only be created by the Assistant"));
     qmlRegisterType<BlockchainInterface>(POLLARIS_1_0, "BlockchainInterface");
+    qmlRegisterUncreatableType<MetricsRegistry>(POLLARIS_1_0, "MetricsRegistry",
+                                    QStringLiteral("MetricsRegistry is only available from BlockchainInterface"));
     qmlRegisterType<KeyManager>(POLLARIS_1_0, "KeyManager");
     qmlRegisterType<TlsPskSession>(POLLARIS_1_0, "TlsPskSession");
     qmlRegisterUncreatableType<AbstractTableInterface>(POLLARIS_1_0, "TableInterface",
@@ -61,6 +64,7 @@ int main(int argc, char *argv[]) {
     qmlRegisterUncreatableType<BroadcastableTransaction>(POLLARIS_1_0, "PackedTransaction",
                                             QStringLiteral("PackedTransactions can only be created by KeyManager"));
     qmlRegisterType<Action>(POLLARIS_1_0, "Action");
+    qmlRegisterType<TableEditController>(POLLARIS_1_0, "TableEditController");
 
     ComponentManager* componentManager = new ComponentManager(&engine, &app);
     auto componentMgrName = QStringLiteral("componentManager");
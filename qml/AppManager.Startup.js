@@ -38,8 +38,8 @@ var dialog = {
         "input": null // Input is set by processBlockchainNodeError()
     },
     "timeoutUrl": {
-        "text": qsTr("Well, this is taking forever... The server hasn't sent a response yet. If it ever does, " +
-                                     "I'll let you know, but in the meantime, feel free to try a different address:"),
+        "text": qsTr("Well, this is taking forever... The server hasn't sent a response, so I've given up on " +
+                                     "it. Please check the address, or try a different one:"),
         "next": tryServer,
         "prev": () => displayDialog("introduction"),
         "input": null // Input is set by blockchainNodeTimeout()
@@ -367,9 +367,9 @@ function blockchainStatusChanged() {
 }
 
 function tryServer(url) {
-    let urlInput = Qt.resolvedUrl(currentDialog.input.text)
+    let urlInput = currentDialog.input.text.trim()
     console.info("User gave node URL:", urlInput)
-    if (!urlInput.toString()) {
+    if (!urlInput) {
         if (!dialog.badUrl.input)
             // Just use the same input method for badUrl as for getUrl
             dialog.badUrl.input = dialog.getUrl.input
@@ -379,11 +379,33 @@ function tryServer(url) {
     }
 
     displayDialog("tryingUrl")
+    probeServer(candidateNodeUrls(urlInput))
+}
+
+// Get the URLs a server address might refer to. An address without a scheme might be served over HTTPS or HTTP.
+function candidateNodeUrls(address) {
+    if (address.indexOf("://") !== -1)
+        return [address]
+    return ["https://" + address, "http://" + address]
+}
+
+// Connect to whichever of the candidate URLs answers first, or explain why none did
+function probeServer(candidates) {
     Utils.connectUntil(blockchain.syncStatusChanged, blockchainStatusChanged)
-    blockchain.nodeUrl = urlInput
-    if (typeof timeoutCanceler === "function")
-        timeoutCanceler()
-    timeoutCanceler = Utils.setTimeout(10000, blockchainNodeTimeout)
+    Utils.connectOnce(blockchain.nodeProbeFinished, (nodeUrl) => {
+                          if (!!nodeUrl)
+                              return
+
+                          // Report the most promising candidate's failure
+                          let best = blockchain.nodeRanking[0]
+                          if (!best || best.verdict === "TimedOut")
+                              blockchainNodeTimeout()
+                          else if (best.verdict === "Failed")
+                              processBlockchainNodeError(best.errorCode)
+                          else
+                              blockchainNodeNonsense()
+                      })
+    blockchain.probeNodes(candidates)
 }
 
 /**
@@ -482,8 +504,7 @@ function deploymentServerOnResponse() {
         deploymentServerOnResponse.linesProcessed = 2
 
         displayDialog("deploymentServerSuccess")
-        Utils.connectUntil(blockchain.syncStatusChanged, blockchainStatusChanged)
-        blockchain.nodeUrl = lineIn
+        probeServer(candidateNodeUrls(lineIn))
     }
 }
 
@@ -575,14 +596,6 @@ function processBlockchainNodeError(errorCode) {
 
     console.warn(`Blockchain node URL seems invalid based on error ${errorCode} from BlockchainInterface`)
     blockchain.disconnect()
-
-    if (!blockchain.nodeUrl.toString().startsWith("http")) {
-        let nextTry = "http://" + blockchain.nodeUrl.toString()
-        console.info(`Automatically trying node ${nextTry} before reporting error`)
-        blockchain.nodeUrl = nextTry
-        return
-    }
-
     blockchain.nodeUrl = ""
 
     if (!dialog.failedUrl.input)
@@ -659,6 +672,22 @@ function blockchainNodeTimeout() {
     }
 }
 
+// Connect to the server that worked before, retrying until it answers
+function probeSavedServer() {
+    Utils.connectOnce(blockchain.nodeProbeFinished, (nodeUrl) => {
+                          if (!!nodeUrl)
+                              return
+
+                          let best = blockchain.nodeRanking[0]
+                          if (!best || best.verdict === "TimedOut")
+                              displayDialog("normalStartTimeout")
+                          else
+                              normalStartupBlockchainError()
+                          timeoutCanceler = Utils.setTimeout(10000, probeSavedServer)
+                      })
+    blockchain.probeNodes(candidateNodeUrls(assistantSettings.blockchainNodeUrl.toString()))
+}
+
 function loadBlockhainInterface() {
     let loaded = (blockchain) => {
         if (!blockchain) {
@@ -679,26 +708,13 @@ function loadBlockhainInterface() {
             blockchain.nodeError.connect(normalStartupBlockchainError)
             blockchain.nodeResponseNonsense.connect(normalStartupBlockchainError)
             Utils.connectUntil(blockchain.syncStatusChanged, blockchainStatusChanged)
-
-            // Set a timeout timer so we can display a message if the server is connecting too slowly
-            if (typeof timeoutCanceler === "function")
-            timeoutCanceler()
-            timeoutCanceler = Utils.setTimeout(10000, () => {
-                                                   displayDialog("normalStartTimeout")
-                                                   // Try disconnecting and reconnecting...
-                                                   blockchain.disconnect()
-                                                   blockchain.nodeUrl = ""
-                                                   blockchain.nodeUrl = assistantSettings.blockchainNodeUrl
-                                               })
+            probeSavedServer()
         }
     }
 
-    // Do we have a node URL stored? If so, load BlockchainInterface with it
+    // Do we have a node URL stored? If not, cue first time startup experience to get it from the user
     let blockchainProperties = {}
-    if (!!assistantSettings.blockchainNodeUrl.toString())
-            blockchainProperties.nodeUrl = assistantSettings.blockchainNodeUrl
-    else
-        // No URL known. Cue first time startup experience to get it from the user
+    if (!assistantSettings.blockchainNodeUrl.toString())
         firstTimeStartup = true
 
     componentManager.createFromSource("import Pollaris.Utilities 1.0\n\nBlockchainInterface{}", "BlockchainInterface",
@@ -15,6 +15,17 @@ Window {
     property TableModel groupMembersModel: groupMembersTable.allRows()
     property real uiSpacing: 20
 
+    // Show only the members whose tags match an expression, or all members if the expression is empty
+    function filterByTags(expression) {
+        let oldModel = groupMembersModel
+        let filtered = expression? groupMembersTable.rowsWithTags(expression) : groupMembersTable.allRows()
+        if (!filtered)
+            return false
+        groupMembersModel = filtered
+        oldModel.deleteLater()
+        return true
+    }
+
     Item {
         id: rootItem
         anchors.fill: parent
@@ -42,6 +53,12 @@ Window {
                         elide: Text.ElideRight
                         font.pointSize: 20
                     }
+                    TextField {
+                        id: tagFilterField
+                        Layout.fillWidth: true
+                        placeholderText: qsTr("Filter by tags, e.g. board & !observer")
+                        onEditingFinished: color = filterByTags(text)? palette.text : "red"
+                    }
                     RowLayout {
                         Layout.fillWidth: true
                         TextField {
@@ -117,6 +117,7 @@ Window {
     }
     TableEditController {
         id: tableEditController
+        blockchain: (context && context.blockchain)? context.blockchain : null
         actions: transactionManagerUI.activeTransaction? transactionManagerUI.activeTransaction.actions : []
     }
 
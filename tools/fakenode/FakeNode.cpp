@@ -0,0 +1,460 @@
+#include "FakeNode.hpp"
+
+#include <EosioName.hpp>
+
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+#include <QDebug>
+
+#include <optional>
+
+namespace {
+// Journal modification codes, as in JournalEntry::EntryType
+constexpr int AddRow = 0;
+constexpr int DeleteRow = 1;
+constexpr int ModifyRow = 2;
+
+constexpr qint64 BLOCK_INTERVAL_MS = 500;
+
+const QStringList TagVocabulary{QStringLiteral("staff"), QStringLiteral("board"), QStringLiteral("member"),
+                                QStringLiteral("observer"), QStringLiteral("east"), QStringLiteral("west"),
+                                QStringLiteral("north"), QStringLiteral("south"), QStringLiteral("proxy"),
+                                QStringLiteral("founding")};
+
+// Like fc's JSON writer, emit 64-bit integers which don't fit in 32 bits as strings, so JavaScript-style parsers
+// don't lose precision
+QByteArray jsonInteger(uint64_t value) {
+    if (value > 0xffffffff)
+        return '"' + QByteArray::number(qulonglong(value)) + '"';
+    return QByteArray::number(qulonglong(value));
+}
+
+// Binary row packing, as the node does for "json": false requests: fixed-width little endian integers, and strings
+// and vectors prefixed with a varuint32 size
+void packVarUint32(QByteArray& out, uint32_t value) {
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        out += char(byte | (value > 0? 0x80 : 0));
+    } while (value > 0);
+}
+template<typename T>
+void packInteger(QByteArray& out, T value) {
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        out += char((value >> (8 * i)) & 0xff);
+}
+void packString(QByteArray& out, const QByteArray& utf8) {
+    packVarUint32(out, uint32_t(utf8.size()));
+    out += utf8;
+}
+
+QByteArray jsonTime(const QDateTime& time) {
+    return '"' + time.toUTC().toString(QStringLiteral("yyyy-MM-ddThh:mm:ss.zzz")).toLatin1() + '"';
+}
+
+// Read a key bound from a get_table_rows request. Bounds may be numbers too large for a double, so they're read
+// from the raw request text rather than a parsed document. Quoted non-numeric bounds are account names.
+std::optional<uint64_t> readBound(const QByteArray& body, const char* key) {
+    QRegularExpression pattern(QStringLiteral(R"("%1"\s*:\s*("?)([^",}\s]*))").arg(QLatin1String(key)));
+    auto match = pattern.match(QString::fromLatin1(body));
+    if (!match.hasMatch() || match.captured(2).isEmpty())
+        return {};
+
+    bool isNumber = false;
+    auto value = match.captured(2).toULongLong(&isNumber);
+    if (isNumber)
+        return value;
+    return eosio::string_to_uint64_t(match.captured(2));
+}
+
+uint64_t readScope(const QString& scope) {
+    bool isNumber = false;
+    auto value = scope.toULongLong(&isNumber);
+    return isNumber? value : eosio::string_to_uint64_t(scope);
+}
+} // anonymous namespace
+
+FakeNode::FakeNode(Config config, QObject* parent)
+    : QObject(parent), config(config), random(config.seed), server(new QTcpServer(this)),
+      blockTimer(new QTimer(this)), journalTimer(new QTimer(this)),
+      genesis(QDateTime::currentDateTimeUtc()) {
+    connect(server, &QTcpServer::newConnection, this, [this] {
+        while (auto* socket = server->nextPendingConnection()) {
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket] { socketReadyRead(socket); });
+        }
+    });
+
+    blockTimer->callOnTimeout(this, &FakeNode::produceBlock);
+    blockTimer->start(BLOCK_INTERVAL_MS);
+
+    if (config.journalRate > 0) {
+        journalTimer->callOnTimeout(this, &FakeNode::generateJournalEntry);
+        journalTimer->start(std::max(1u, 1000 / config.journalRate));
+    }
+
+    generateDataSet(config.groups, config.membersPerGroup);
+}
+
+bool FakeNode::listen() {
+    if (!server->listen(QHostAddress::LocalHost, config.port)) {
+        qCritical() << "FakeNode: Unable to listen on port" << config.port << ":" << server->errorString();
+        return false;
+    }
+    qInfo() << "FakeNode: Serving" << rowCount() << "rows at http://127.0.0.1:" << server->serverPort();
+    return true;
+}
+
+quint16 FakeNode::port() const { return server->serverPort(); }
+
+QString FakeNode::accountName(uint64_t index) {
+    // Names are "v" followed by the index in base 31, using only characters valid in account names, padded to a
+    // fixed width so the names sort in index order
+    static const char* alphabet = "12345abcdefghijklmnopqrstuvwxyz";
+    QString name(11, QLatin1Char(alphabet[0]));
+    name[0] = 'v';
+    for (int i = 10; i > 0 && index > 0; --i, index /= 31)
+        name[i] = alphabet[index % 31];
+    return name;
+}
+
+void FakeNode::generateDataSet(uint32_t groupCount, uint32_t membersPerGroup) {
+    groups.clear();
+    members.clear();
+    journal.clear();
+    nextAccountIndex = 0;
+
+    for (uint64_t id = 0; id < groupCount; ++id) {
+        groups[id] = Group{id, "Group " + QByteArray::number(qulonglong(id)), uint16_t(random.bounded(1 << 4))};
+        auto& groupMembers = members[id];
+        for (uint32_t i = 0; i < membersPerGroup; ++i) {
+            auto account = eosio::string_to_uint64_t(accountName(nextAccountIndex++));
+            groupMembers.emplace_hint(groupMembers.end(), account,
+                                      Member{account, 1 + random.bounded(10u),
+                                             uint16_t(random.bounded(1 << TagVocabulary.size()))});
+        }
+        journalChange(true, eosio::string_to_uint64_t(QStringLiteral("global")), id, AddRow);
+    }
+    qInfo() << "FakeNode: Generated" << groupCount << "groups of" << membersPerGroup << "members";
+}
+
+uint64_t FakeNode::rowCount() const {
+    uint64_t count = groups.size() + journal.size();
+    for (const auto& scope : members)
+        count += scope.second.size();
+    return count;
+}
+
+void FakeNode::journalChange(bool groupsTable, uint64_t scope, uint64_t key, int modification) {
+    auto id = journal.empty()? 0 : journal.rbegin()->first + 1;
+    journal.emplace_hint(journal.end(), id,
+                         JournalRecord{id, QDateTime::currentDateTimeUtc(), groupsTable, scope, key, modification});
+}
+
+void FakeNode::generateJournalEntry() {
+    if (groups.empty())
+        return;
+
+    auto group = std::next(groups.begin(), random.bounded(quint32(groups.size())))->first;
+    auto& groupMembers = members[group];
+    auto operation = random.bounded(10u);
+
+    if (groupMembers.empty() || operation < 5) {
+        auto account = eosio::string_to_uint64_t(accountName(nextAccountIndex++));
+        groupMembers[account] = Member{account, 1 + random.bounded(10u),
+                                       uint16_t(random.bounded(1 << TagVocabulary.size()))};
+        journalChange(false, group, account, AddRow);
+        return;
+    }
+
+    auto member = std::next(groupMembers.begin(), random.bounded(quint32(groupMembers.size())));
+    if (operation < 8) {
+        member->second.weight = 1 + random.bounded(10u);
+        journalChange(false, group, member->first, ModifyRow);
+    } else {
+        journalChange(false, group, member->first, DeleteRow);
+        groupMembers.erase(member);
+    }
+}
+
+void FakeNode::produceBlock() {
+    blockTransactions[headBlock] = std::move(pendingTransactions);
+    pendingTransactions.clear();
+    ++headBlock;
+}
+
+void FakeNode::socketReadyRead(QTcpSocket* socket) {
+    auto buffer = socket->property("buffer").toByteArray() + socket->readAll();
+
+    // Handle every complete request in the buffer
+    while (true) {
+        auto headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd == -1)
+            break;
+
+        auto headers = buffer.left(headerEnd);
+        auto lines = headers.split('\n');
+        auto requestLine = lines.takeFirst().trimmed().split(' ');
+        qsizetype contentLength = 0;
+        bool keepAlive = requestLine.value(2) != "HTTP/1.0";
+        bool deflate = false;
+        for (const auto& line : lines) {
+            auto colon = line.indexOf(':');
+            auto name = line.left(colon).trimmed().toLower();
+            auto value = line.mid(colon + 1).trimmed();
+            if (name == "content-length")
+                contentLength = value.toLongLong();
+            else if (name == "connection")
+                keepAlive = value.toLower() != "close";
+            else if (name == "accept-encoding")
+                deflate = config.compress && value.toLower().contains("deflate");
+        }
+
+        auto bodyStart = headerEnd + 4;
+        if (buffer.size() < bodyStart + contentLength)
+            break;
+
+        auto body = buffer.mid(bodyStart, contentLength);
+        buffer.remove(0, bodyStart + contentLength);
+        dispatch(socket, requestLine.value(1), std::move(body), keepAlive, deflate);
+    }
+
+    socket->setProperty("buffer", buffer);
+}
+
+void FakeNode::dispatch(QTcpSocket* socket, QByteArray path, QByteArray body, bool keepAlive, bool deflate) {
+    auto roll = random.generateDouble();
+    if (roll < config.dropRate) {
+        qDebug() << "FakeNode: Dropping request for" << path;
+        socket->abort();
+        return;
+    }
+    if (roll < config.dropRate + config.errorRate) {
+        respond(socket, 500, R"({"code": 500, "message": "Injected error", "error": {"what": "Injected error"}})",
+                keepAlive, deflate);
+        return;
+    }
+
+    int status = 200;
+    QByteArray response;
+    if (path == "/v1/chain/get_info")
+        response = getInfo();
+    else if (path == "/v1/chain/get_table_rows")
+        response = getTableRows(body, &status);
+    else if (path == "/v1/chain/get_block")
+        response = getBlock(body, &status);
+    else if (path == "/v1/chain/push_transaction")
+        response = pushTransaction(body, &status);
+    else
+        status = 404, response = R"({"code": 404, "message": "Not Found"})";
+
+    auto delay = config.latencyMs + (config.jitterMs > 0? random.bounded(config.jitterMs + 1) : 0);
+    if (delay == 0)
+        respond(socket, status, std::move(response), keepAlive, deflate);
+    else
+        QTimer::singleShot(delay, socket, [this, socket, status, response, keepAlive, deflate] {
+            respond(socket, status, response, keepAlive, deflate);
+        });
+}
+
+void FakeNode::respond(QTcpSocket* socket, int status, QByteArray body, bool keepAlive, bool deflate) {
+    QByteArray reason = status == 200? "OK" : status == 404? "Not Found" : status == 400? "Bad Request"
+                                                                                        : "Internal Server Error";
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reason + "\r\n"
+                          "Content-Type: application/json\r\n";
+    // HTTP's deflate encoding is a zlib stream, which is what qCompress makes after its 4 byte length prefix
+    if (deflate && body.size() >= 1024) {
+        body = qCompress(body).mid(4);
+        response += "Content-Encoding: deflate\r\n";
+    }
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    if (!keepAlive)
+        response += "Connection: close\r\n";
+    response += "\r\n" + body;
+    socket->write(response);
+    if (!keepAlive)
+        socket->disconnectFromHost();
+}
+
+QByteArray FakeNode::getInfo() const {
+    // headBlock is the block being built; the last one produced is the one before it
+    auto head = headBlock - 1;
+    auto lib = head > 3? head - 3 : 1;
+    return "{\"server_version\": \"fakenode\", \"chain_id\": \"" + config.chainId + "\", "
+           "\"head_block_num\": " + jsonInteger(head) + ", "
+           "\"last_irreversible_block_num\": " + jsonInteger(lib) + ", "
+           "\"last_irreversible_block_id\": \"" + blockId(lib) + "\", "
+           "\"head_block_id\": \"" + blockId(head) + "\", "
+           "\"head_block_time\": " + jsonTime(blockTime(head)) + ", "
+           "\"head_block_producer\": \"eosio\"}";
+}
+
+QByteArray FakeNode::getTableRows(const QByteArray& body, int* status) {
+    auto request = QJsonDocument::fromJson(body).object();
+    auto table = request[QStringLiteral("table")].toString();
+    auto scope = readScope(request[QStringLiteral("scope")].toString());
+    auto limit = request.contains(QStringLiteral("limit"))? uint32_t(request[QStringLiteral("limit")].toInt())
+                                                          : config.defaultLimit;
+    bool reverse = request[QStringLiteral("reverse")].toBool();
+    // As on a real node, rows are packed binary unless JSON is requested
+    bool json = request[QStringLiteral("json")].toBool();
+    auto lowerBound = readBound(body, "lower_bound");
+    auto upperBound = readBound(body, "upper_bound");
+
+    // Walk the rows of a table within the bounds, in either direction, serializing up to limit of them
+    auto query = [&](const auto& rows, auto serialize) {
+        auto begin = lowerBound? rows.lower_bound(*lowerBound) : rows.begin();
+        auto end = upperBound? rows.upper_bound(*upperBound) : rows.end();
+        QByteArray result = "{\"rows\": [";
+        uint32_t count = 0;
+        auto emitRow = [&](const auto& row) {
+            if (count++ > 0)
+                result += ", ";
+            result += serialize(row);
+        };
+
+        std::optional<uint64_t> nextKey;
+        if (!reverse) {
+            auto itr = begin;
+            for (; itr != end && count < limit; ++itr)
+                emitRow(itr->second);
+            if (itr != end)
+                nextKey = itr->first;
+        } else {
+            auto itr = std::make_reverse_iterator(end);
+            auto rend = std::make_reverse_iterator(begin);
+            for (; itr != rend && count < limit; ++itr)
+                emitRow(itr->second);
+            if (itr != rend)
+                nextKey = itr->first;
+        }
+
+        result += "], \"more\": ";
+        result += nextKey? "true" : "false";
+        result += ", \"next_key\": \"";
+        if (nextKey)
+            result += QByteArray::number(qulonglong(*nextKey));
+        result += "\"}";
+        return result;
+    };
+
+    if (table == QStringLiteral("poll.groups"))
+        return query(groups, [this, json](const Group& group) -> QByteArray {
+            if (json)
+                return "{\"id\": " + jsonInteger(group.id) + ", \"name\": \"" + group.name + "\", \"tags\": " +
+                       tagsJson(group.tagMask) + '}';
+            QByteArray packed;
+            packInteger(packed, group.id);
+            packString(packed, group.name);
+            packTags(packed, group.tagMask);
+            return '"' + packed.toHex() + '"';
+        });
+    if (table == QStringLiteral("group.accts"))
+        return query(members[scope], [this, json](const Member& member) -> QByteArray {
+            if (json)
+                return "{\"account\": \"" + eosio::name_to_string(member.account).toLatin1() +
+                       "\", \"weight\": " + jsonInteger(member.weight) + ", \"tags\": " + tagsJson(member.tagMask) +
+                       '}';
+            QByteArray packed;
+            packInteger(packed, member.account);
+            packInteger(packed, member.weight);
+            packTags(packed, member.tagMask);
+            return '"' + packed.toHex() + '"';
+        });
+    // The journal is only served as JSON; the client never asks for it packed
+    if (table == QStringLiteral("journal"))
+        return query(journal, [](const JournalRecord& record) {
+            return "{\"id\": " + jsonInteger(record.id) + ", \"timestamp\": " + jsonTime(record.timestamp) +
+                   ", \"table\": \"" + (record.groupsTable? "poll.groups" : "group.accts") + "\", \"scope\": " +
+                   jsonInteger(record.scope) + ", \"key\": " + jsonInteger(record.key) + ", \"modification\": " +
+                   QByteArray::number(record.modification) + '}';
+        });
+
+    *status = 400;
+    return R"({"code": 400, "message": "Unknown table", "error": {"what": "Unknown table"}})";
+}
+
+QByteArray FakeNode::getBlock(const QByteArray& body, int* status) {
+    auto number = readBound(body, "block_num_or_id");
+    if (!number || *number == 0 || *number >= headBlock) {
+        *status = 400;
+        return R"({"code": 400, "message": "Unknown block"})";
+    }
+
+    QByteArray result = "{\"block_num\": " + jsonInteger(*number) + ", \"id\": \"" + blockId(*number) + "\", "
+                        "\"timestamp\": " + jsonTime(blockTime(*number)) + ", \"transactions\": [";
+    auto itr = blockTransactions.find(*number);
+    if (itr != blockTransactions.end())
+        for (std::size_t i = 0; i < itr->second.size(); ++i) {
+            if (i > 0)
+                result += ", ";
+            result += "{\"status\": \"executed\", \"trx\": {\"id\": \"" + itr->second[i] + "\"}}";
+        }
+    result += "]}";
+    return result;
+}
+
+QByteArray FakeNode::pushTransaction(const QByteArray& body, int* status) {
+    auto request = QJsonDocument::fromJson(body).object();
+    auto packed = QByteArray::fromHex(request[QStringLiteral("packed_trx")].toString().toLatin1());
+    if (packed.isEmpty()) {
+        *status = 400;
+        return R"({"code": 400, "message": "Missing packed_trx", "error": {"what": "Missing packed_trx"}})";
+    }
+
+    // The transaction ID is the hash of the unpacked transaction. qUncompress expects the zlib stream to be prefixed
+    // with the expected size, which only needs to be a generous estimate.
+    if (request[QStringLiteral("compression")].toString() == QStringLiteral("zlib") ||
+            request[QStringLiteral("compression")].toInt() == 1) {
+        quint32 estimate = std::max<quint32>(1024, packed.size() * 16);
+        QByteArray sized(4, '\0');
+        qToBigEndian(estimate, sized.data());
+        packed = qUncompress(sized + packed);
+    }
+    auto id = QCryptographicHash::hash(packed, QCryptographicHash::Sha256).toHex();
+    pendingTransactions.push_back(id);
+
+    return "{\"transaction_id\": \"" + id + "\", \"processed\": {\"id\": \"" + id + "\", "
+           "\"block_num\": " + jsonInteger(headBlock) + ", \"block_time\": " + jsonTime(blockTime(headBlock)) +
+           ", \"receipt\": {\"status\": \"executed\"}}}";
+}
+
+QByteArray FakeNode::blockId(uint64_t number) const {
+    // As in EOSIO, the first four bytes of the block ID are the block number
+    auto hash = QCryptographicHash::hash(config.chainId + QByteArray::number(qulonglong(number)),
+                                         QCryptographicHash::Sha256).toHex();
+    return QByteArray::number(qulonglong(number & 0xffffffff), 16).rightJustified(8, '0') + hash.mid(8);
+}
+
+QDateTime FakeNode::blockTime(uint64_t number) const {
+    return genesis.addMSecs(qint64(number) * BLOCK_INTERVAL_MS);
+}
+
+void FakeNode::packTags(QByteArray& out, uint16_t mask) const {
+    QList<QByteArray> tags;
+    for (int i = 0; i < TagVocabulary.size(); ++i)
+        if (mask & (1 << i))
+            tags.append(TagVocabulary[i].toUtf8());
+    packVarUint32(out, uint32_t(tags.size()));
+    for (const auto& tag : tags)
+        packString(out, tag);
+}
+
+QByteArray FakeNode::tagsJson(uint16_t mask) const {
+    QByteArray result = "[";
+    bool first = true;
+    for (int i = 0; i < TagVocabulary.size(); ++i)
+        if (mask & (1 << i)) {
+            if (!first)
+                result += ", ";
+            first = false;
+            result += '"' + TagVocabulary[i].toLatin1() + '"';
+        }
+    return result + ']';
+}
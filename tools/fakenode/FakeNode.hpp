@@ -0,0 +1,122 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <QStringList>
+
+#include <map>
+#include <vector>
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+/*!
+ * \brief A stand-in for an EOSIO API node running the Pollaris contract, for load and performance testing
+ *
+ * The node serves get_info, get_table_rows, get_block and push_transaction over HTTP on the loopback interface. It
+ * holds the poll.groups, group.accts and journal tables of the contract in memory, produces a block every half
+ * second, and can generate a synthetic stream of journalled changes to the group.accts tables.
+ *
+ * Pushed transactions are accepted and included in the next block, but their actions are not executed; use the
+ * journal generator to exercise table changes.
+ */
+class FakeNode : public QObject {
+    Q_OBJECT
+
+public:
+    struct Config {
+        quint16 port = 8888;
+        //! Number of polling groups to generate
+        uint32_t groups = 10;
+        //! Number of members to generate in each group
+        uint32_t membersPerGroup = 100;
+        //! Fixed delay added to every response, in milliseconds
+        uint32_t latencyMs = 0;
+        //! Random additional delay of up to this many milliseconds
+        uint32_t jitterMs = 0;
+        //! Fraction of requests answered with an HTTP 500 error
+        double errorRate = 0;
+        //! Fraction of requests whose connection is dropped without an answer
+        double dropRate = 0;
+        //! Synthetic journal entries to generate per second
+        uint32_t journalRate = 0;
+        //! Maximum number of rows get_table_rows returns when the request sets no limit
+        uint32_t defaultLimit = 10;
+        //! Whether to deflate responses of 1 KiB or more to clients accepting it, as a proxy in front of a node might
+        bool compress = false;
+        QByteArray chainId = QByteArray(64, 'f');
+        quint32 seed = 1;
+    };
+
+    struct Group {
+        uint64_t id;
+        QByteArray name;
+        uint16_t tagMask;
+    };
+    struct Member {
+        uint64_t account;
+        uint32_t weight;
+        uint16_t tagMask;
+    };
+    struct JournalRecord {
+        uint64_t id;
+        QDateTime timestamp;
+        bool groupsTable;
+        uint64_t scope;
+        uint64_t key;
+        int modification;
+    };
+
+    explicit FakeNode(Config config, QObject* parent = nullptr);
+
+    bool listen();
+    quint16 port() const;
+
+    //! Regenerate the tables with the given number of groups and members per group
+    void generateDataSet(uint32_t groups, uint32_t membersPerGroup);
+    //! Make a random add, modify or delete to a group.accts table and journal it
+    void generateJournalEntry();
+    void produceBlock();
+
+    uint64_t rowCount() const;
+
+    //! Get a valid, unique account name for the given index
+    static QString accountName(uint64_t index);
+
+private:
+    Config config;
+    QRandomGenerator random;
+    QTcpServer* server;
+    QTimer* blockTimer;
+    QTimer* journalTimer;
+
+    QDateTime genesis;
+    //! Number of the block being built, which pushed transactions will be included in
+    uint64_t headBlock = 2;
+    std::map<uint64_t, std::vector<QByteArray>> blockTransactions;
+    std::vector<QByteArray> pendingTransactions;
+
+    std::map<uint64_t, Group> groups;
+    std::map<uint64_t, std::map<uint64_t, Member>> members;
+    std::map<uint64_t, JournalRecord> journal;
+    uint64_t nextAccountIndex = 0;
+
+    void journalChange(bool groupsTable, uint64_t scope, uint64_t key, int modification);
+
+    void socketReadyRead(QTcpSocket* socket);
+    void dispatch(QTcpSocket* socket, QByteArray path, QByteArray body, bool keepAlive, bool deflate);
+    void respond(QTcpSocket* socket, int status, QByteArray body, bool keepAlive, bool deflate);
+
+    QByteArray getInfo() const;
+    QByteArray getTableRows(const QByteArray& body, int* status);
+    QByteArray getBlock(const QByteArray& body, int* status);
+    QByteArray pushTransaction(const QByteArray& body, int* status);
+
+    QByteArray blockId(uint64_t number) const;
+    QDateTime blockTime(uint64_t number) const;
+    QByteArray tagsJson(uint16_t mask) const;
+    void packTags(QByteArray& out, uint16_t mask) const;
+};
@@ -0,0 +1,62 @@
+#include "FakeNode.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QMap>
+#include <QDebug>
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("pollaris-fakenode");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Stand-in EOSIO node serving synthetic Pollaris contract tables");
+    parser.addHelpOption();
+    QCommandLineOption portOption("port", "Port to listen on (default 8888)", "port", "8888");
+    QCommandLineOption datasetOption("dataset", "Preset data set size: 1k, 10k, 100k or 1m rows", "size");
+    QCommandLineOption groupsOption("groups", "Number of polling groups (default 10)", "count", "10");
+    QCommandLineOption membersOption("members", "Number of members per group (default 100)", "count", "100");
+    QCommandLineOption latencyOption("latency-ms", "Fixed delay added to each response", "msecs", "0");
+    QCommandLineOption jitterOption("jitter-ms", "Maximum random delay added to each response", "msecs", "0");
+    QCommandLineOption errorOption("error-rate", "Fraction of requests answered with HTTP 500", "fraction", "0");
+    QCommandLineOption dropOption("drop-rate", "Fraction of connections dropped without answer", "fraction", "0");
+    QCommandLineOption journalOption("journal-rate", "Synthetic group.accts changes per second", "rate", "0");
+    QCommandLineOption limitOption("default-limit", "Rows per get_table_rows page when no limit is set", "rows",
+                                   "10");
+    QCommandLineOption seedOption("seed", "Random seed, for reproducible data sets", "seed", "1");
+    QCommandLineOption compressOption("compress", "Deflate large responses to clients which accept it");
+    parser.addOptions({portOption, datasetOption, groupsOption, membersOption, latencyOption, jitterOption,
+                       errorOption, dropOption, journalOption, limitOption, seedOption, compressOption});
+    parser.process(app);
+
+    FakeNode::Config config;
+    config.port = parser.value(portOption).toUShort();
+    config.groups = parser.value(groupsOption).toUInt();
+    config.membersPerGroup = parser.value(membersOption).toUInt();
+    config.latencyMs = parser.value(latencyOption).toUInt();
+    config.jitterMs = parser.value(jitterOption).toUInt();
+    config.errorRate = parser.value(errorOption).toDouble();
+    config.dropRate = parser.value(dropOption).toDouble();
+    config.journalRate = parser.value(journalOption).toUInt();
+    config.defaultLimit = parser.value(limitOption).toUInt();
+    config.seed = parser.value(seedOption).toUInt();
+    config.compress = parser.isSet(compressOption);
+
+    if (parser.isSet(datasetOption)) {
+        // Presets keep the groups at a realistic size and scale the number of groups
+        static const QMap<QString, uint32_t> presets{{"1k", 1'000}, {"10k", 10'000}, {"100k", 100'000},
+                                                     {"1m", 1'000'000}};
+        auto size = parser.value(datasetOption).toLower();
+        if (!presets.contains(size)) {
+            qCritical() << "Unknown data set size" << size << "; expected one of" << presets.keys();
+            return 1;
+        }
+        config.membersPerGroup = std::min<uint32_t>(1'000, presets[size]);
+        config.groups = presets[size] / config.membersPerGroup;
+    }
+
+    FakeNode node(config);
+    if (!node.listen())
+        return 1;
+    return app.exec();
+}